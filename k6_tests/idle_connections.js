@@ -0,0 +1,74 @@
+import http from 'k6/http';
+import { check, sleep } from 'k6';
+import { Trend } from 'k6/metrics';
+import { textSummary } from 'https://jslib.k6.io/k6-summary/0.0.1/index.js';
+
+const metric_get_duration = new Trend('get_duration', true);
+
+// сравнение режимов HTTP-сервера (HTTP_SERVER_MODE=httplib / epoll):
+// - 'idle'   - много keep-alive соединений, которые почти все время молчат
+// - 'active' - клиенты, которые непрерывно читают анкеты
+const idle_vus   = parseInt(__ENV.IDLE_VUS || '10000');
+const active_vus = parseInt(__ENV.ACTIVE_VUS || '500');
+
+export let options = {
+  scenarios: {
+    idle: {
+      executor: 'constant-vus',
+      exec: 'idle',
+      vus: idle_vus,
+      duration: '3m',
+    },
+    active: {
+      executor: 'constant-vus',
+      exec: 'active',
+      vus: active_vus,
+      startTime: '30s',
+      duration: '2m',
+    },
+  },
+  ext: {
+    'prometheus-rw': {
+      url: __ENV.K6_PROMETHEUS_RW_SERVER_URL
+    },
+  }
+};
+
+const host = __ENV.TEST_HOST || 'app:6000'
+
+export function setup()
+{
+  // берем набор существующих идентификаторов для чтения анкет
+  const res = http.get(`${host}/user/search?first_name=Ив&last_name=Ив`);
+  const data = res.json();
+  return { ids: Array.isArray(data) ? data.map((item) => item.id) : [] };
+}
+
+export function idle()
+{
+  // запрос держит соединение открытым, пауза меньше keep-alive таймаута
+  http.get(`${host}/livez`, { tags: { scenario_type: 'idle' } });
+  sleep(5);
+}
+
+export function active(data)
+{
+  if (data.ids.length === 0) {
+    sleep(1);
+    return;
+  }
+
+  const id = data.ids[(__VU + __ITER) % data.ids.length];
+  const res = http.get(`${host}/user/get/${id}`, { tags: { scenario_type: 'active' } });
+  metric_get_duration.add(res.timings.duration, { mode: __ENV.TEST_TYPE || 'unknown' });
+
+  check(res, {
+    'get status 200': (r) => r.status === 200
+  });
+}
+
+export function handleSummary(data) {
+  return {
+    'stdout': textSummary(data, { indent: ' ', enableColors: true }),
+  };
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+namespace SocialNetwork {
+
+namespace Benchmark {
+
+// не дает компилятору выбросить вычисление результата
+template <typename T>
+inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// выполняет 'func' 'iterations' раз в каждом из 'rounds' замеров и печатает
+// медиану и лучшее время одной итерации
+template <typename Func>
+void run(std::string_view name, size_t iterations, Func&& func, size_t rounds = 7)
+{
+    using clock = std::chrono::steady_clock;
+
+    // прогрев кешей и аллокатора
+    for (size_t i = 0; i < std::max<size_t>(iterations / 10, 1); ++i) func();
+
+    std::vector<double> per_op;
+    for (size_t r = 0; r < rounds; ++r) {
+        auto start = clock::now();
+        for (size_t i = 0; i < iterations; ++i) func();
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        per_op.push_back(elapsed.count() / static_cast<double>(iterations));
+    }
+    std::sort(per_op.begin(), per_op.end());
+
+    std::printf("%-40.*s %12.1f ns/op (median) %12.1f ns/op (best)\n",
+        static_cast<int>(name.size()), name.data(), per_op[per_op.size() / 2], per_op.front());
+}
+
+} // namespace Benchmark
+
+} // namespace SocialNetwork
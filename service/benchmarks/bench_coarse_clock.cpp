@@ -0,0 +1,106 @@
+//
+// стоимость меток времени на один запрос: заголовок Date, $time_local в
+// журнале запросов и метка строки журнала. "до" - прежнее форматирование
+// (stringstream + put_time и snprintf), "после" - TimeHelpers::CoarseClock
+//
+
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "helpers/coarse_clock.h"
+#include "bench.h"
+
+using namespace SocialNetwork;
+
+namespace {
+
+std::string time_local_str_()
+{
+    auto p = std::chrono::system_clock::now();
+    auto t = std::chrono::system_clock::to_time_t(p);
+
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&t), "%d/%b/%Y:%H:%M:%S %z");
+    return ss.str();
+}
+
+std::string time_gmt_str_()
+{
+    auto p = std::chrono::system_clock::now();
+    auto t = std::chrono::system_clock::to_time_t(p);
+    std::tm gmt_tm;
+    gmtime_r(&t, &gmt_tm);
+
+    std::stringstream ss;
+    ss << std::put_time(&gmt_tm, "%a, %d %b %Y %H:%M:%S GMT");
+    return ss.str();
+}
+
+std::string get_timestamp_()
+{
+    std::chrono::system_clock::time_point tp = std::chrono::system_clock::now();
+    std::time_t tt = std::chrono::system_clock::to_time_t(tp);
+    std::tm gmt{};
+    gmtime_r(&tt, &gmt);
+
+    std::chrono::duration<double> fractional_seconds = (tp - std::chrono::system_clock::from_time_t(tt)) + std::chrono::seconds(gmt.tm_sec);
+
+    std::string buffer("yyyy-mm-dd hh:mm:ss.xxxxxx0");
+    snprintf(&buffer.front(), buffer.length(), "%04d-%02d-%02d %02d:%02d:%09.6f",
+             (gmt.tm_year + 1900) %10000u,
+             (gmt.tm_mon + 1)     %100u,
+             (gmt.tm_mday)        %100u,
+             (gmt.tm_hour)        %100u,
+             (gmt.tm_min)         %100u,
+             fractional_seconds.count());
+    buffer.pop_back();
+    return buffer;
+}
+
+void before_()
+{
+    Benchmark::do_not_optimize(time_gmt_str_());
+    Benchmark::do_not_optimize(time_local_str_());
+    Benchmark::do_not_optimize(get_timestamp_());
+}
+
+void after_()
+{
+    Benchmark::do_not_optimize(TimeHelpers::CoarseClock::http_date());
+    Benchmark::do_not_optimize(TimeHelpers::CoarseClock::local_time());
+    Benchmark::do_not_optimize(TimeHelpers::CoarseClock::log_time());
+}
+
+// то же самое одновременно из нескольких потоков (потоки пула)
+template <typename Func>
+void parallel_(size_t threads, size_t iterations, Func func)
+{
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([&] { for (size_t n = 0; n < iterations; ++n) func(); });
+    }
+    for (auto& one : workers) one.join();
+}
+
+} // namespace
+
+int main()
+{
+    std::printf("%.*s | %.*s | %.*s\n",
+        static_cast<int>(TimeHelpers::CoarseClock::http_date_length),  TimeHelpers::CoarseClock::http_date().data(),
+        static_cast<int>(TimeHelpers::CoarseClock::local_time_length), TimeHelpers::CoarseClock::local_time().data(),
+        static_cast<int>(TimeHelpers::CoarseClock::log_time_length),   TimeHelpers::CoarseClock::log_time().data());
+
+    Benchmark::run("per request, before", 200000, before_);
+    Benchmark::run("per request, after (CoarseClock)", 200000, after_);
+
+    const size_t threads = std::max(2u, std::thread::hardware_concurrency());
+    Benchmark::run("per request x threads, before", 5, [&] { parallel_(threads, 20000, before_); });
+    Benchmark::run("per request x threads, after (CoarseClock)", 5, [&] { parallel_(threads, 20000, after_); });
+
+    return EXIT_SUCCESS;
+}
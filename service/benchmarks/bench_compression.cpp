@@ -0,0 +1,51 @@
+//
+// сжатие ответа /user/search (100 пользователей): каждый раз заново
+// против повторной отдачи из записи кэша (Http::EncodedBody)
+//
+
+#include <string>
+#include "http/compression.h"
+#include "bench.h"
+
+using namespace SocialNetwork;
+
+int main()
+{
+    std::string body("[");
+    for (int i = 0; i < 100; ++i) {
+        if (i) body.push_back(',');
+        const auto n = std::to_string(100000000000 + i * 7919);
+        body += R"({"id":"0190a5c3-7e4b-7d2a-9f31-)" + n + R"(","first_name":"Иван)" + std::to_string(i)
+              + R"(","second_name":"Петров","birthdate":"19)" + std::to_string(10 + i % 90)
+              + R"(-01-01","biography":"Люблю читать и путешествовать","city":"Москва"})";
+    }
+    body.push_back(']');
+
+    const Http::EncodedBody entry(body, "application/json");
+    for (auto encoding : {Http::Encoding::GZIP, Http::Encoding::ZSTD, Http::Encoding::BROTLI}) {
+        const auto name = std::string(Http::to_string(encoding));
+        if (!Http::is_supported(encoding)) {
+            std::printf("%-36s not supported by build\n", name.c_str());
+            continue;
+        }
+
+        std::string out;
+        Http::CompressionStats stats;
+        if (!Http::compress(encoding, body, out, stats)) {
+            std::fprintf(stderr, "Http::compress(%s) is broken\n", name.c_str());
+            return EXIT_FAILURE;
+        }
+        std::printf("%-36s %zu -> %zu bytes, ratio %.1f\n", name.c_str(), stats.plain_size, stats.encoded_size, stats.ratio());
+
+        Benchmark::run(name + ": compress", 2000, [&] {
+            Http::compress(encoding, body, out, stats);
+            Benchmark::do_not_optimize(out.data());
+        });
+        std::optional<Http::CompressionStats> once;
+        Benchmark::run(name + ": EncodedBody::encoded", 200000, [&] {
+            Benchmark::do_not_optimize(entry.encoded(encoding, once));
+        });
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+//
+// обработчики-сопрограммы против блокирующих при одном и том же количестве
+// потоков пула запросов. запрос к БД имитируется блокирующим ожиданием
+// 'db_latency_', как синхронный вызов libpqxx. блокирующий обработчик ждет в
+// потоке пула запросов, сопрограмма - отдает ожидание пулу БД (run_in) или
+// таймеру (sleep_for) и освобождает поток для следующих запросов.
+// смешанная нагрузка - 90% ответов из кэша (немного работы CPU) и 10% с БД.
+// время - на один запрос
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "helpers/coroutine.h"
+#include "helpers/thread.h"
+#include "helpers/thread_pool.h"
+#include "bench.h"
+
+using namespace SocialNetwork;
+
+namespace {
+
+constexpr size_t threads_    = 4;       // потоки пула запросов
+constexpr size_t db_threads_ = 64;      // потоки пула БД (соединения)
+constexpr size_t requests_   = 4096;
+constexpr size_t capacity_   = 2 * requests_;   // запросы и продолжения сопрограмм
+constexpr size_t rounds_     = 5;
+constexpr auto   db_latency_ = std::chrono::milliseconds(1);
+
+// 'round' обслуживает 'count' запросов одного замера, печатаются медиана и лучшее время на запрос
+template <typename Round>
+void measure_(const std::string& name, size_t count, Round&& round)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<double> per_op;
+    for (size_t r = 0; r < rounds_; ++r) {
+        auto start = clock::now();
+        round();
+        std::chrono::duration<double, std::micro> elapsed = clock::now() - start;
+        per_op.push_back(elapsed.count() / static_cast<double>(count));
+    }
+    std::sort(per_op.begin(), per_op.end());
+
+    std::printf("%-48s %10.2f us/req (median) %10.2f us/req (best)\n",
+        name.c_str(), per_op[per_op.size() / 2], per_op.front());
+}
+
+// ответ из кэша: немного работы CPU
+uint64_t cache_hit_(uint64_t seed)
+{
+    for (int i = 0; i < 256; ++i) seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return seed;
+}
+
+uint64_t db_query_(uint64_t seed)
+{
+    std::this_thread::sleep_for(db_latency_);
+    return seed + 1;
+}
+
+bool is_db_(size_t request, bool mixed) { return !mixed || request % 10 == 0; }
+
+// блокирующий обработчик: запрос к БД занимает поток пула запросов
+void blocking_round_(bool mixed)
+{
+    ThreadHelpers::ThreadPool pool("BenchPool", nullptr, threads_, capacity_);
+    std::atomic<uint64_t> sum{0};
+
+    for (size_t i = 0; i < requests_; ++i) {
+        pool.add_task(nullptr, [&sum, i, mixed]() {
+            sum.fetch_add(is_db_(i, mixed) ? db_query_(i) : cache_hit_(i), std::memory_order_relaxed);
+        });
+    }
+    pool.wait_all();
+    Benchmark::do_not_optimize(sum.load());
+}
+
+ThreadHelpers::Task<uint64_t> handler_(ThreadHelpers::ThreadPool* db, size_t request, bool mixed)
+{
+    if (!is_db_(request, mixed)) co_return cache_hit_(request);
+    co_return co_await ThreadHelpers::run_in(db, [request]() { return db_query_(request); });
+}
+
+ThreadHelpers::Task<uint64_t> sleeping_handler_(size_t request)
+{
+    co_await ThreadHelpers::sleep_for(db_latency_);
+    co_return request + 1;
+}
+
+// обработчик-сопрограмма: запрос стартует задачей пула запросов, как в
+// WorkerLanes, и продолжается в нем же после ожидания
+template <typename Handler>
+void coroutine_round_(Handler&& handler)
+{
+    ThreadHelpers::ThreadPool pool("BenchPool", nullptr, threads_, capacity_);
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint32_t> done{0};
+
+    for (size_t i = 0; i < requests_; ++i) {
+        pool.add_task(nullptr, [&, i]() {
+            auto request = [](ThreadHelpers::Task<uint64_t> task, std::atomic<uint64_t>& sum) -> ThreadHelpers::Task<void> {
+                sum.fetch_add(co_await std::move(task), std::memory_order_relaxed);
+            };
+            ThreadHelpers::spawn(request(handler(i), sum), [&done](std::exception_ptr) {
+                if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == requests_) ThreadHelpers::futex_wake(done, 1);
+            });
+        });
+    }
+    for (auto value = done.load(std::memory_order_acquire); value != requests_; value = done.load(std::memory_order_acquire)) {
+        ThreadHelpers::futex_wait(done, value);
+    }
+    pool.wait_all();
+    Benchmark::do_not_optimize(sum.load());
+}
+
+} // namespace
+
+int main()
+{
+    ThreadHelpers::ThreadPool db("BenchDb", nullptr, db_threads_, capacity_);
+    const auto suffix = ", threads " + std::to_string(threads_);
+
+    measure_("db 1 ms, blocking" + suffix, requests_, []() { blocking_round_(false); });
+    measure_("db 1 ms, co_await run_in" + suffix, requests_, [&db]() {
+        coroutine_round_([&db](size_t i) { return handler_(&db, i, false); });
+    });
+    measure_("db 1 ms, co_await sleep_for" + suffix, requests_, []() {
+        coroutine_round_([](size_t i) { return sleeping_handler_(i); });
+    });
+    measure_("90% cache, 10% db, blocking" + suffix, requests_, []() { blocking_round_(true); });
+    measure_("90% cache, 10% db, co_await run_in" + suffix, requests_, [&db]() {
+        coroutine_round_([&db](size_t i) { return handler_(&db, i, true); });
+    });
+    return 0;
+}
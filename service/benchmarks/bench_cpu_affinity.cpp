@@ -0,0 +1,139 @@
+//
+// стоимость обмена кэш-линией между ядрами и закрепление потоков пула.
+// два потока по очереди меняют одно атомарное слово: аппаратные потоки одного
+// физического ядра, разные ядра одного узла NUMA и ядра разных узлов - так
+// видна цена обмена данными между сокетами. затем - полный путь
+// ThreadPool::add_task с потоками пула без закрепления, Pinning::Compact и
+// Pinning::Spread. пары, которых нет на машине, пропускаются.
+// время - на один обмен или одну задачу
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <sched.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "helpers/cpu_topology.h"
+#include "helpers/thread_pool.h"
+#include "bench.h"
+
+using namespace SocialNetwork;
+
+namespace {
+
+constexpr size_t exchanges_  = 1 << 18;
+constexpr size_t tasks_      = 1 << 18;
+constexpr size_t capacity_   = 1024;
+constexpr size_t rounds_     = 5;
+
+// 'round' выполняет 'count' операций одного замера, печатаются медиана и лучшее время на операцию
+template <typename Round>
+void measure_(const std::string& name, size_t count, Round&& round)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<double> per_op;
+    for (size_t r = 0; r < rounds_; ++r) {
+        auto start = clock::now();
+        round();
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        per_op.push_back(elapsed.count() / static_cast<double>(count));
+    }
+    std::sort(per_op.begin(), per_op.end());
+
+    std::printf("%-40s %12.1f ns/op (median) %12.1f ns/op (best)\n",
+        name.c_str(), per_op[per_op.size() / 2], per_op.front());
+}
+
+// первая пара ядер, для которой 'match' истинно
+template <typename Match>
+std::optional<std::pair<unsigned, unsigned>> find_pair_(const ThreadHelpers::CpuTopology& topology, Match&& match)
+{
+    for (const auto& first : topology.cpus()) {
+        for (const auto& second : topology.cpus()) {
+            if (first.id != second.id && match(first, second)) return std::make_pair(first.id, second.id);
+        }
+    }
+    return std::nullopt;
+}
+
+// поток на ядре 'first' записывает нечетные значения, на ядре 'second' - четные
+void ping_pong_round_(std::pair<unsigned, unsigned> cpus)
+{
+    alignas(64) std::atomic<uint64_t> word{0};
+
+    std::thread pong([&word]() {
+        for (uint64_t i = 1; i < 2 * exchanges_; i += 2) {
+            while (word.load(std::memory_order_acquire) != i) {}
+            word.store(i + 1, std::memory_order_release);
+        }
+    });
+    ThreadHelpers::pin_thread(pong.native_handle(), cpus.second);
+    ThreadHelpers::pin_thread(pthread_self(), cpus.first);
+
+    for (uint64_t i = 0; i < 2 * exchanges_; i += 2) {
+        while (word.load(std::memory_order_acquire) != i) {}
+        word.store(i + 1, std::memory_order_release);
+    }
+    pong.join();
+}
+
+void thread_pool_round_(size_t threads, const std::vector<unsigned>& cpus)
+{
+    ThreadHelpers::ThreadPool pool("BenchPool", nullptr, threads, capacity_,
+                                   ThreadHelpers::Scheduling::SharedQueue, {}, cpus);
+    std::atomic<uint64_t> sum{0};
+
+    for (uint64_t i = 0; i < tasks_; ++i) {
+        while (!pool.add_task(nullptr, [&sum, i]() { sum.fetch_add(i, std::memory_order_relaxed); })) {
+            std::this_thread::yield();
+        }
+    }
+    pool.wait_all();
+    Benchmark::do_not_optimize(sum.load());
+}
+
+} // namespace
+
+int main()
+{
+    const auto& topology = ThreadHelpers::CpuTopology::system();
+    std::printf("cpus: %zu, numa nodes: %zu\n", topology.cpus().size(), topology.nodes().size());
+
+    const std::pair<const char*, std::optional<std::pair<unsigned, unsigned>>> pairs[] = {
+        {"ping-pong, same core (SMT)", find_pair_(topology, [](const auto& l, const auto& r) {
+            return l.package == r.package && l.core == r.core;
+        })},
+        {"ping-pong, same node", find_pair_(topology, [](const auto& l, const auto& r) {
+            return l.node == r.node && (l.package != r.package || l.core != r.core);
+        })},
+        {"ping-pong, cross node", find_pair_(topology, [](const auto& l, const auto& r) {
+            return l.node != r.node;
+        })},
+    };
+    for (const auto& [name, cpus] : pairs) {
+        if (!cpus) continue;
+        const auto suffix = " (" + std::to_string(cpus->first) + ", " + std::to_string(cpus->second) + ")";
+        measure_(name + suffix, exchanges_, [&]() { ping_pong_round_(*cpus); });
+    }
+    // главный поток закреплялся за ядром пары: возвращаем все ядра процесса
+    cpu_set_t all;
+    CPU_ZERO(&all);
+    for (const auto& cpu : topology.cpus()) CPU_SET(cpu.id, &all);
+    pthread_setaffinity_np(pthread_self(), sizeof(all), &all);
+
+    const auto threads = std::min<size_t>(topology.cpus().size(), 8);
+    const auto suffix  = ", threads " + std::to_string(threads);
+    measure_("ThreadPool, not pinned" + suffix, tasks_, [&]() { thread_pool_round_(threads, {}); });
+    const auto compact = topology.placement({ThreadHelpers::Pinning::Compact, {}});
+    measure_("ThreadPool, Pinning::Compact" + suffix, tasks_, [&]() { thread_pool_round_(threads, compact); });
+    const auto spread = topology.placement({ThreadHelpers::Pinning::Spread, {}});
+    measure_("ThreadPool, Pinning::Spread" + suffix, tasks_, [&]() { thread_pool_round_(threads, spread); });
+    return 0;
+}
@@ -0,0 +1,126 @@
+//
+// разбор тела /user/register: DOM nlohmann::json с копированием полей
+// в std::string (как было) против JsonHelpers::read_object
+//
+
+#include <nlohmann/json.hpp>
+#include "app_requests.h"
+#include "bench.h"
+
+using namespace SocialNetwork;
+
+namespace {
+
+struct register_copy_s {
+    std::string password;
+    std::string first_name;
+    std::string second_name;
+    std::string birthdate;
+    std::string biography;
+    std::string city;
+};
+
+bool nlohmann_(const std::string& body, register_copy_s& out)
+{
+    auto json = nlohmann::json::parse(body);
+    for (const auto* key : {"password", "first_name", "second_name", "birthdate", "biography", "city"}) {
+        if (!json.contains(key) || !json[key].is_string()) return false;
+    }
+    out.password    = json["password"].get<std::string>();
+    out.first_name  = json["first_name"].get<std::string>();
+    out.second_name = json["second_name"].get<std::string>();
+    out.birthdate   = json["birthdate"].get<std::string>();
+    out.biography   = json["biography"].get<std::string>();
+    out.city        = json["city"].get<std::string>();
+    return true;
+}
+
+bool json_reader_(const std::string& body, user_register_request_s& out, std::string& scratch)
+{
+    scratch.clear();
+    return static_cast<bool>(JsonHelpers::read_object(body, out, scratch));
+}
+
+// тело должно разбираться так же, как nlohmann::json
+bool same_(const std::string& body)
+{
+    register_copy_s expected;
+    user_register_request_s actual;
+    std::string scratch;
+    if (!nlohmann_(body, expected) || !json_reader_(body, actual, scratch)) return false;
+    return expected.password    == actual.password
+        && expected.first_name  == actual.first_name
+        && expected.second_name == actual.second_name
+        && expected.birthdate   == actual.birthdate
+        && expected.biography   == actual.biography
+        && expected.city        == actual.city;
+}
+
+bool rejected_(const std::string& body, JsonHelpers::ReadError error)
+{
+    user_register_request_s request;
+    std::string scratch;
+    auto result = JsonHelpers::read_object(body, request, scratch);
+    if (result.error != error) {
+        std::fprintf(stderr, "%s: %s\n", body.c_str(), result.message().c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    // типичные тела запросов из k6-тестов: кириллица, экранированные символы
+    const std::string latin(R"({"first_name":"Ivan","second_name":"Petrov","birthdate":"1990-05-17","biography":"Hiking, photography and chess","city":"Moscow","password":"Secret123!"})");
+    const std::string cyrillic(R"({
+        "password": "очень-секретный-пароль",
+        "first_name": "Александр",
+        "second_name": "Константинопольский",
+        "birthdate": "1985-11-03",
+        "biography": "Люблю \"кавычки\", табуляцию\tи переводы\nстрок. Пишу на C++ ☺",
+        "city": "Санкт-Петербург",
+        "extra": {"tags": ["a", 1, 2.5e3, true, null], "nested": {}}
+    })");
+
+    using JsonHelpers::ReadError;
+    const bool ok = same_(latin) && same_(cyrillic)
+        && same_(R"({"password":"12345678","first_name":"😀","second_name":"","birthdate":"2000-01-01","biography":"\/\\\b\f\r","city":""})")
+        && rejected_(R"({"password":"12345678"})", ReadError::MISSING)
+        && rejected_(R"({"password":1234567890})", ReadError::NOT_STRING)
+        && rejected_(R"({"password":"1234"})", ReadError::TOO_SHORT)
+        && rejected_(R"({"first_name":"ЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙЙ"})", ReadError::TOO_LONG)
+        && rejected_(R"({"city":"a","city":"b"})", ReadError::DUPLICATE)
+        && rejected_("{\"city\":\"\xc0\xaf\"}", ReadError::BAD_UTF8)
+        && rejected_(R"({"city":"\udc00"})", ReadError::BAD_UTF8)
+        && rejected_(R"({"city":"a",})", ReadError::SYNTAX)
+        && rejected_(R"({"x":[1,2,}])", ReadError::SYNTAX)
+        && rejected_(R"({"x":01})", ReadError::SYNTAX)
+        && rejected_(R"({"city":"a"} x)", ReadError::SYNTAX)
+        && rejected_(R"(["city"])", ReadError::NOT_OBJECT)
+        && rejected_("{\"x\":" + std::string(100, '[') + std::string(100, ']') + "}", ReadError::TOO_DEEP);
+    if (!ok) {
+        std::fprintf(stderr, "JsonHelpers::read_object() is broken\n");
+        return EXIT_FAILURE;
+    }
+
+    register_copy_s copy;
+    user_register_request_s request;
+    std::string scratch;
+
+    Benchmark::run("register, latin: nlohmann::json", 100000, [&] {
+        Benchmark::do_not_optimize(nlohmann_(latin, copy));
+    });
+    Benchmark::run("register, latin: JsonHelpers", 100000, [&] {
+        Benchmark::do_not_optimize(json_reader_(latin, request, scratch));
+    });
+    Benchmark::run("register, cyrillic+escapes: nlohmann::json", 100000, [&] {
+        Benchmark::do_not_optimize(nlohmann_(cyrillic, copy));
+    });
+    Benchmark::run("register, cyrillic+escapes: JsonHelpers", 100000, [&] {
+        Benchmark::do_not_optimize(json_reader_(cyrillic, request, scratch));
+    });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,114 @@
+//
+// сравнение сериализации ответа /user/search (100 строк) через DOM
+// nlohmann::json, как было раньше, и через JsonHelpers
+//
+
+#include <nlohmann/json.hpp>
+#include "app_responses.h"
+#include "bench.h"
+
+using namespace SocialNetwork;
+
+namespace {
+
+// строки в том виде, в каком их возвращает pqxx::result
+struct row_s {
+    std::string id;
+    std::string first_name;
+    std::string second_name;
+    std::string birthdate;
+    std::string biography;
+    std::string city;
+};
+
+std::vector<row_s> make_rows_(size_t count)
+{
+    std::vector<row_s> rows;
+    for (size_t i = 0; i < count; ++i) {
+        rows.push_back({
+            "0190a5c3-7e4b-7d2a-9f31-" + std::to_string(100000000000 + i),
+            "Александр",
+            "Иванов-" + std::to_string(i),
+            "1990-01-" + std::to_string(10 + i % 20),
+            "Люблю \"кавычки\", табуляцию\tи переводы\nстрок",
+            "Москва",
+        });
+    }
+    return rows;
+}
+
+std::string nlohmann_(const std::vector<row_s>& rows)
+{
+    auto result = nlohmann::json::array();
+    for (const auto& row : rows) {
+        nlohmann::json user;
+        user["id"]          = row.id;
+        user["first_name"]  = row.first_name;
+        user["second_name"] = row.second_name;
+        user["birthdate"]   = row.birthdate;
+        user["biography"]   = row.biography;
+        user["city"]        = row.city;
+        result.push_back(std::move(user));
+    }
+    return result.dump();
+}
+
+std::string json_writer_(const std::vector<row_s>& rows)
+{
+    size_t hint = 2;
+    for (const auto& row : rows) {
+        hint += 96 + row.id.size() + row.first_name.size() + row.second_name.size()
+              + row.birthdate.size() + row.biography.size() + row.city.size();
+    }
+
+    std::string result;
+    result.reserve(hint);
+    result.push_back('[');
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (i) result.push_back(',');
+        const auto& row = rows[i];
+        JsonHelpers::write_value(result, user_response_s{
+            .id          = row.id,
+            .first_name  = row.first_name,
+            .second_name = row.second_name,
+            .birthdate   = row.birthdate,
+            .biography   = row.biography,
+            .city        = row.city,
+        });
+    }
+    result.push_back(']');
+    return result;
+}
+
+} // namespace
+
+int main()
+{
+    const auto rows = make_rows_(100);
+
+    // результаты должны совпадать как JSON-значения (порядок ключей разный)
+    if (nlohmann::json::parse(nlohmann_(rows)) != nlohmann::json::parse(json_writer_(rows))) {
+        std::fprintf(stderr, "serializers produce different JSON\n");
+        return EXIT_FAILURE;
+    }
+
+    Benchmark::run("user/search 100 rows: nlohmann::json", 2000, [&] {
+        Benchmark::do_not_optimize(nlohmann_(rows));
+    });
+    Benchmark::run("user/search 100 rows: JsonHelpers", 2000, [&] {
+        Benchmark::do_not_optimize(json_writer_(rows));
+    });
+
+    const error_response_s error{.code = 400, .message = "invalid request"};
+    Benchmark::run("error: nlohmann::json", 200000, [&] {
+        nlohmann::json body;
+        body["code"]    = error.code;
+        body["message"] = error.message;
+        Benchmark::do_not_optimize(body.dump());
+    });
+    Benchmark::run("error: JsonHelpers", 200000, [&] {
+        Benchmark::do_not_optimize(JsonHelpers::to_json(error, 64));
+    });
+
+    return EXIT_SUCCESS;
+}
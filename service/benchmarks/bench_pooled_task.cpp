@@ -0,0 +1,178 @@
+//
+// задача пула на пути ThreadPoolAdaptor::enqueue (соединение httplib в пуле):
+// "до" - прежний PooledTask (std::bind в std::function, результат в std::any)
+// с TaskMeta, копирующей std::function обратного вызова, в std::queue;
+// "после" - ThreadHelpers::PooledTask со встроенным буфером в MpmcQueue.
+// печатается время и число выделений памяти на задачу, затем то же для
+// полного пути ThreadPool::add_task с потоками пула. метрики адаптера не
+// вызываются, чтобы считать только расходы пула
+//
+
+#include <any>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <queue>
+#include <utility>
+#include "helpers/mpmc_queue.h"
+#include "helpers/thread_pool.h"
+#include "bench.h"
+
+using namespace SocialNetwork;
+
+namespace {
+
+std::atomic<uint64_t> allocations_{0};
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    allocations_.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr size_t iterations_   = 200000;
+constexpr size_t capacity_     = 1024;
+constexpr size_t pool_tasks_   = 1 << 18;
+constexpr size_t pool_threads_ = 4;
+
+// прежние PooledTask и TaskMeta из helpers/thread_pool.h
+using LegacyOnCompleteFunc = std::function<void(std::any)>;
+
+class LegacyPooledTask
+{
+public:
+    template<typename Func, typename... Args>
+    explicit LegacyPooledTask(const Func& func, Args&&... args)
+    :   is_void{std::is_void_v<decltype(func(std::forward<Args>(args)...))>} {
+        if constexpr (std::is_void_v<decltype(func(std::forward<Args>(args)...))>) {
+            void_func = std::bind(func, std::forward<Args>(args)...);
+            any_func  = []()->int { return 0; };
+        } else {
+            void_func = []()->void {};
+            any_func  = std::bind(func, std::forward<Args>(args)...);
+        }
+    }
+
+    void operator() () {
+        void_func();
+        result = any_func();
+    }
+
+    std::any get_result() const {
+        if (is_void) return {};
+        return result;
+    }
+
+private:
+    bool                        is_void{false};
+    std::function<void()>       void_func{nullptr};
+    std::function<std::any()>   any_func{nullptr};
+    std::any                    result{};
+};
+
+struct LegacyTaskMeta {
+    LegacyTaskMeta(uint64_t id, LegacyOnCompleteFunc& cb)
+    :   id_(id), cb_(cb) {}
+
+    uint64_t             id_{0};
+    LegacyOnCompleteFunc cb_{};
+};
+
+// состояние адаптера, к которому обращается задача
+struct adaptor_s {
+    std::atomic<uint64_t> waiting{0};
+    uint64_t              handled{0};
+};
+
+// соединение, которое httplib передает в TaskQueue::enqueue
+std::function<void()> connection_(adaptor_s& adaptor, int sock)
+{
+    return [&adaptor, sock]() { adaptor.handled += static_cast<uint64_t>(sock); };
+}
+
+// задача в том виде, в каком ее ставит в пул ThreadPoolAdaptor::enqueue
+auto adaptor_task_(adaptor_s& adaptor, std::function<void()> fn)
+{
+    return [&adaptor, fn = std::move(fn), queued = std::chrono::steady_clock::now()]() {
+        adaptor.waiting.fetch_sub(1, std::memory_order_relaxed);
+        Benchmark::do_not_optimize(queued);
+        fn();
+    };
+}
+
+template <typename Func>
+void allocations_per_op_(const char* name, size_t iterations, Func&& func)
+{
+    const auto before = allocations_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < iterations; ++i) func();
+    const auto count = allocations_.load(std::memory_order_relaxed) - before;
+    std::printf("%-40s %12.2f allocations/op\n", name, static_cast<double>(count) / static_cast<double>(iterations));
+}
+
+void pool_path_()
+{
+    adaptor_s adaptor;
+    ThreadHelpers::ThreadPool pool("BenchPool", nullptr, pool_threads_, capacity_);
+
+    const auto before = allocations_.load(std::memory_order_relaxed);
+    const auto start  = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < pool_tasks_; ++i) {
+        adaptor.waiting.fetch_add(1, std::memory_order_relaxed);
+        while (!pool.add_task(nullptr, adaptor_task_(adaptor, connection_(adaptor, 1)))) {
+            std::this_thread::yield();
+        }
+    }
+    pool.wait_all();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    const auto count = allocations_.load(std::memory_order_relaxed) - before;
+
+    std::printf("%-40s %12.1f ns/op %12.2f allocations/op\n", "ThreadPool::add_task, adaptor path",
+        elapsed.count() / static_cast<double>(pool_tasks_),
+        static_cast<double>(count) / static_cast<double>(pool_tasks_));
+}
+
+} // namespace
+
+int main()
+{
+    adaptor_s adaptor;
+    uint64_t  id = 0;
+
+    std::queue<std::pair<LegacyPooledTask, LegacyTaskMeta>> legacy_queue;
+    LegacyOnCompleteFunc legacy_cb{nullptr};
+    const auto legacy = [&]() {
+        legacy_queue.emplace(LegacyPooledTask(adaptor_task_(adaptor, connection_(adaptor, 1))), LegacyTaskMeta(++id, legacy_cb));
+        auto task = std::move(legacy_queue.front());
+        legacy_queue.pop();
+        task.first();
+        if (task.second.cb_) task.second.cb_(task.first.get_result());
+    };
+
+    ThreadHelpers::MpmcQueue<std::pair<ThreadHelpers::PooledTask, uint64_t>> queue(capacity_);
+    const auto pooled = [&]() {
+        queue.try_emplace(ThreadHelpers::PooledTask(nullptr, adaptor_task_(adaptor, connection_(adaptor, 1))), ++id);
+        auto task = queue.try_pop();
+        task->first();
+    };
+
+    Benchmark::run("legacy PooledTask + std::queue", iterations_, legacy);
+    allocations_per_op_("legacy PooledTask + std::queue", iterations_, legacy);
+    Benchmark::run("PooledTask + MpmcQueue", iterations_, pooled);
+    allocations_per_op_("PooledTask + MpmcQueue", iterations_, pooled);
+
+    pool_path_();
+
+    Benchmark::do_not_optimize(adaptor.handled);
+    return 0;
+}
@@ -0,0 +1,243 @@
+//
+// конкуренция за очередь пула потоков при 1/4/16/64 производителях.
+// "до" - std::queue под мьютексом с condition_variable, как было в
+// ThreadHelpers::ThreadPool, "после" - ThreadHelpers::MpmcQueue.
+// отдельно - полный путь ThreadPool::add_task до выполнения задачи, то же
+// с учетом времени задач для метрик пулов (ThreadPool::enable_timings), то же
+// пачками через ThreadPool::add_tasks и
+// порождение подзадач из задач пула: общая очередь против деки каждого потока
+// с перехватом (ThreadHelpers::Scheduling::WorkStealing).
+// время - на одну задачу, при заполненной очереди производитель повторяет попытку
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include "helpers/mpmc_queue.h"
+#include "helpers/thread_pool.h"
+#include "bench.h"
+
+using namespace SocialNetwork;
+
+namespace {
+
+constexpr size_t   total_tasks_    = 1 << 18;
+constexpr size_t   capacity_       = 1024;
+constexpr size_t   consumers_      = 4;
+constexpr size_t   rounds_         = 5;
+constexpr unsigned producers_[]    = {1, 4, 16, 64};
+constexpr size_t   fan_out_        = 1024;
+constexpr size_t   batch_          = 16;
+
+class LockedQueue
+{
+public:
+    bool try_push(uint64_t value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (items_.size() >= capacity_) return false;
+            items_.push(value);
+        }
+        condition_.notify_one();
+        return true;
+    }
+
+    bool pop(uint64_t& value, const std::atomic<bool>& stop) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [&]() { return !items_.empty() || stop; });
+        if (items_.empty()) return false;
+        value = items_.front();
+        items_.pop();
+        return true;
+    }
+
+    void wake_all() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        condition_.notify_all();
+    }
+
+private:
+    std::mutex              mutex_{};
+    std::condition_variable condition_{};
+    std::queue<uint64_t>    items_{};
+};
+
+// 'round' выполняет все задачи одного замера, печатаются медиана и лучшее время на задачу
+template <typename Round>
+void measure_(const std::string& name, Round&& round)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<double> per_op;
+    for (size_t r = 0; r < rounds_; ++r) {
+        auto start = clock::now();
+        round();
+        std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        per_op.push_back(elapsed.count() / static_cast<double>(total_tasks_));
+    }
+    std::sort(per_op.begin(), per_op.end());
+
+    std::printf("%-40s %12.1f ns/op (median) %12.1f ns/op (best)\n",
+        name.c_str(), per_op[per_op.size() / 2], per_op.front());
+}
+
+// производители делят 'total_tasks_' поровну и ждут завершения друг друга
+template <typename Push>
+void produce_(unsigned producers, Push&& push)
+{
+    std::vector<std::thread> threads;
+    threads.reserve(producers);
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            for (uint64_t i = p; i < total_tasks_; i += producers) {
+                while (!push(i)) std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+}
+
+void locked_queue_round_(unsigned producers)
+{
+    LockedQueue queue;
+    std::atomic<bool>     stop{false};
+    std::atomic<uint64_t> sum{0};
+
+    std::vector<std::thread> consumers;
+    for (size_t c = 0; c < consumers_; ++c) {
+        consumers.emplace_back([&]() {
+            uint64_t value = 0, local = 0;
+            while (queue.pop(value, stop)) local += value;
+            sum += local;
+        });
+    }
+    produce_(producers, [&](uint64_t i) { return queue.try_push(i); });
+
+    stop = true;
+    queue.wake_all();
+    for (auto& th : consumers) th.join();
+    Benchmark::do_not_optimize(sum.load());
+}
+
+void mpmc_queue_round_(unsigned producers)
+{
+    ThreadHelpers::MpmcQueue<uint64_t> queue(capacity_);
+    std::atomic<bool>     stop{false};
+    std::atomic<uint64_t> sum{0};
+
+    std::vector<std::thread> consumers;
+    for (size_t c = 0; c < consumers_; ++c) {
+        consumers.emplace_back([&]() {
+            uint64_t local = 0;
+            for (;;) {
+                if (auto value = queue.try_pop()) {
+                    local += *value;
+                } else if (stop) {
+                    // производители закончили: забираем то, что успели добавить после try_pop()
+                    while (auto rest = queue.try_pop()) local += *rest;
+                    break;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            sum += local;
+        });
+    }
+    produce_(producers, [&](uint64_t i) { return queue.try_push(std::move(i)); });
+
+    stop = true;
+    for (auto& th : consumers) th.join();
+    Benchmark::do_not_optimize(sum.load());
+}
+
+void thread_pool_round_(unsigned producers)
+{
+    ThreadHelpers::ThreadPool pool("BenchPool", nullptr, consumers_, capacity_);
+    std::atomic<uint64_t> sum{0};
+
+    produce_(producers, [&](uint64_t i) {
+        return pool.add_task(nullptr, [&sum, i]() { sum.fetch_add(i, std::memory_order_relaxed); }).has_value();
+    });
+    pool.wait_all();
+    Benchmark::do_not_optimize(sum.load());
+}
+
+// производитель собирает задачи в пачки по 'batch_', отклоненный хвост пачки
+// собирается заново и добавляется повторно. потоки пула тоже забирают задачи пачками
+void thread_pool_batch_round_(unsigned producers)
+{
+    ThreadHelpers::ThreadPool pool("BenchPool", nullptr, consumers_, capacity_,
+                                   ThreadHelpers::Scheduling::SharedQueue, {}, {}, batch_);
+    std::atomic<uint64_t> sum{0};
+
+    std::vector<std::thread> threads;
+    threads.reserve(producers);
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            std::vector<ThreadHelpers::PooledTask> batch;
+            batch.reserve(batch_);
+            uint64_t next = p;
+            while (next < total_tasks_) {
+                batch.clear();
+                for (uint64_t i = next; i < total_tasks_ && batch.size() < batch_; i += producers) {
+                    batch.emplace_back(nullptr, [&sum, i]() { sum.fetch_add(i, std::memory_order_relaxed); });
+                }
+                const auto accepted = pool.add_tasks(batch);
+                next += accepted * producers;
+                if (accepted < batch.size()) std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    pool.wait_all();
+    Benchmark::do_not_optimize(sum.load());
+}
+
+// каждая корневая задача добавляет из потока пула 'fan_out_ - 1' подзадач.
+// емкость пула вмещает все задачи замера, чтобы сравнивалось только распределение
+// задач по потокам; подзадачу, не поместившуюся в очередь, корневая задача
+// выполняет сама: повторять попытку нельзя, все потоки могут быть заняты корневыми
+void fan_out_round_(ThreadHelpers::Scheduling scheduling)
+{
+    ThreadHelpers::ThreadPool pool("BenchPool", nullptr, consumers_, total_tasks_, scheduling);
+    std::atomic<uint64_t> sum{0};
+
+    const auto leaf = [&sum](uint64_t i) { sum.fetch_add(i, std::memory_order_relaxed); };
+    const auto root = [&pool, &leaf]() {
+        for (uint64_t i = 1; i < fan_out_; ++i) {
+            if (!pool.add_task(nullptr, leaf, i)) leaf(i);
+        }
+    };
+    produce_(1, [&](uint64_t i) {
+        return (i % fan_out_ != 0) || pool.add_task(nullptr, root).has_value();
+    });
+    pool.wait_all();
+    Benchmark::do_not_optimize(sum.load());
+}
+
+} // namespace
+
+int main()
+{
+    for (auto producers : producers_) {
+        const auto suffix = std::string(", producers ") + std::to_string(producers);
+        measure_("mutex queue" + suffix, [=]() { locked_queue_round_(producers); });
+        measure_("MpmcQueue" + suffix, [=]() { mpmc_queue_round_(producers); });
+        measure_("ThreadPool::add_task" + suffix, [=]() { thread_pool_round_(producers); });
+        measure_("ThreadPool::add_tasks" + suffix, [=]() { thread_pool_batch_round_(producers); });
+    }
+    ThreadHelpers::ThreadPool::enable_timings(true);
+    measure_("ThreadPool::add_task, timings, producers 4", []() { thread_pool_round_(4); });
+    ThreadHelpers::ThreadPool::enable_timings(false);
+    measure_("fan-out, SharedQueue", []() { fan_out_round_(ThreadHelpers::Scheduling::SharedQueue); });
+    measure_("fan-out, WorkStealing", []() { fan_out_round_(ThreadHelpers::Scheduling::WorkStealing); });
+    return 0;
+}
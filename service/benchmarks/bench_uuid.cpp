@@ -0,0 +1,40 @@
+//
+// проверка id из запроса: std::regex_match по текстовой записи (как было)
+// против разбора в UuidHelpers::Uuid
+//
+
+#include <regex>
+#include <string>
+#include "helpers/uuid.h"
+#include "bench.h"
+
+using namespace SocialNetwork;
+
+int main()
+{
+    static const std::regex uuid_regex(
+        "^[0-9a-fA-F]{8}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{12}$"
+    );
+    const std::string id("0190A5C3-7e4b-7d2a-9f31-0123456789ab");
+
+    auto parsed = UuidHelpers::Uuid::parse(id);
+    if (!parsed
+    ||  parsed->to_string() != "0190a5c3-7e4b-7d2a-9f31-0123456789ab"
+    ||  UuidHelpers::Uuid::parse("0190a5c3-7e4b-7d2a-9f31-0123456789ag")
+    ||  UuidHelpers::Uuid::parse("0190a5c3+7e4b-7d2a-9f31-0123456789ab")) {
+        std::fprintf(stderr, "Uuid::parse() is broken\n");
+        return EXIT_FAILURE;
+    }
+
+    Benchmark::run("validate: std::regex_match", 200000, [&] {
+        Benchmark::do_not_optimize(std::regex_match(id, uuid_regex));
+    });
+    Benchmark::run("validate: Uuid::parse", 200000, [&] {
+        Benchmark::do_not_optimize(UuidHelpers::Uuid::parse(id));
+    });
+    Benchmark::run("format: Uuid::to_chars", 200000, [&] {
+        Benchmark::do_not_optimize(parsed->to_chars());
+    });
+
+    return EXIT_SUCCESS;
+}
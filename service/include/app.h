@@ -1,13 +1,31 @@
 #pragma once
 
+#include <atomic>
 #include <httplib.h>
 #include "app_connection_pool.h"
+#include "app_credential_cache.h"
+#include "app_deadline.h"
 #include "app_metrics.h"
+#include "app_password_hasher.h"
 #include "configuration/configuration.h"
+#include "helpers/codel.h"
+#include "helpers/coroutine.h"
+#include "helpers/node_local.h"
 #include "helpers/thread_pool.h"
+#include "http/reactor_server.h"
+#include "http/response_cache.h"
 
 namespace SocialNetwork {
 
+//
+// пул потоков для httplib: каждая задача - обслуживание одного соединения
+// целиком, поток пула занят ей до закрытия соединения. потоки, ждущие запросов
+// keep-alive соединений, заблокированы, поэтому эластичный пул (Elasticity)
+// добавляет потоки для соединений из очереди.
+// соединение, слишком долго ждавшее поток (CoDel), получает на первый запрос
+// 503 с Retry-After и закрывается: см. take_shed().
+// маршрут запроса до выбора потока неизвестен, поэтому дорожка одна (метрики lane 0)
+//
 class ThreadPoolAdaptor : public httplib::TaskQueue
 {
 public:
@@ -15,21 +33,64 @@ public:
     ThreadPoolAdaptor(const std::string_view name,
                       std::shared_ptr<Logging::Logger> logger,
                       uint64_t threads_count,
-                      uint64_t tasks_capacity)
-    :   pool_(name, logger, threads_count, tasks_capacity) {}
+                      uint64_t tasks_capacity,
+                      std::shared_ptr<Metrics> metrics,
+                      std::chrono::milliseconds target_delay,
+                      std::chrono::milliseconds interval,
+                      ThreadHelpers::Elasticity elasticity = {},
+                      std::vector<unsigned> cpus = {})
+    :   pool_(name, logger, threads_count, tasks_capacity, ThreadHelpers::Scheduling::SharedQueue,
+              std::move(elasticity), std::move(cpus)),
+        metrics_(std::move(metrics)),
+        codel_(target_delay, interval) {}
 
     virtual bool enqueue(std::function<void()> fn) override final {
         // Return 'true' if the task was actually enqueued,
         // or 'false' if the caller must drop the corresponding connection
-        return pool_.add_task(nullptr, fn).has_value();
+        metrics_->change_open_connections(1);
+        waiting_.fetch_add(1, std::memory_order_relaxed);
+        metrics_->change_lane_queue(0, 1);
+        auto id = pool_.add_task(nullptr, [this, fn = std::move(fn), queued = ThreadHelpers::CoDel::clock_t::now()]() {
+            waiting_.fetch_sub(1, std::memory_order_relaxed);
+            metrics_->change_lane_queue(0, -1);
+            const auto now = ThreadHelpers::CoDel::clock_t::now();
+            metrics_->store_queue_sojourn(0, std::chrono::duration<double>(now - queued).count());
+            shed_ = codel_.should_drop(queued, now);
+            // соединение простаивает, пока его запрос не попал в обработчик
+            metrics_->change_idle_connections(1);
+            fn();
+            metrics_->change_idle_connections(-1);
+            metrics_->change_open_connections(-1);
+            shed_ = false;
+        });
+        if (!id) {
+            waiting_.fetch_sub(1, std::memory_order_relaxed);
+            metrics_->change_lane_queue(0, -1);
+            metrics_->change_open_connections(-1);
+        }
+        return id.has_value();
     }
 
     virtual void shutdown() override final {
         pool_.wait_all();
     }
 
+    // все потоки заняты соединениями, и принятые соединения ждут в очереди
+    bool saturated() const noexcept { return waiting_.load(std::memory_order_relaxed) > 0; }
+
+    // вызывается из обработчиков httplib в потоке пула: true - соединение этого
+    // потока отброшено, и на его первый запрос нужно ответить 503 (один раз)
+    static bool take_shed() noexcept { return std::exchange(shed_, false); }
+
+    int retry_after_sec() const noexcept { return codel_.retry_after_sec(); }
+
 private:
     ThreadHelpers::ThreadPool pool_;
+    std::shared_ptr<Metrics>  metrics_{nullptr};
+    std::atomic<uint64_t>     waiting_{0};
+    ThreadHelpers::CoDel      codel_;
+
+    static inline thread_local bool shed_{false};
 };
 
 
@@ -56,20 +117,39 @@ private:
     std::vector<std::string>         indexes_to_drop_{};
     std::vector<std::string>         indexes_to_create_{};
 
-    std::unique_ptr<httplib::Server> http_server_{nullptr};
+    // таблица маршрутов (app.cpp), вложенный класс - чтобы ссылаться на закрытые обработчики
+    struct Routes;
+
+    std::unique_ptr<httplib::Server>     http_server_{nullptr};
+    std::atomic<ThreadPoolAdaptor*>      http_task_queue_{nullptr};   // принадлежит http_server_
+    std::unique_ptr<Http::ReactorServer> reactor_server_{nullptr};
     OnLivenessCheckFunc              liveness_check_cb_{};
     OnReadinessCheckFunc             readiness_check_cb_{};
     std::thread                      http_server_thread_{};
 
     std::unique_ptr<prometheus::Exposer> exposer_{nullptr};
     std::shared_ptr<Metrics>             metrics_{nullptr};
+    std::unique_ptr<PasswordHasher>      password_hasher_{nullptr};
+
+    // ядра потоков пула запросов и reactor-потоков (CpuTopology::placement), пустые - не закреплять
+    std::vector<unsigned>                http_cpus_{};
+    size_t                               cpus_share_{1};    // доля квоты ядер процесса-обработчика
+    std::vector<unsigned>                reactor_cpus_{};
+    // кэши - по экземпляру на узел NUMA потоков пула запросов (NodeLocal)
+    std::unique_ptr<ThreadHelpers::NodeLocal<Http::ResponseCache>> search_cache_{nullptr};
+    std::unique_ptr<ThreadHelpers::NodeLocal<CredentialCache>>     credential_cache_{nullptr};
 
     std::set<std::string>           db_host_tags{};
     std::shared_ptr<ConnectionPool> db_pool_{nullptr};
+    std::unique_ptr<QueryCanceller> query_canceller_{nullptr};
+    // пул запросов к БД (http_db_threads_count), nullptr - запросы в потоке обработчика
+    std::unique_ptr<ThreadHelpers::ThreadPool> db_executor_{nullptr};
     std::thread                     db_client_thread_{};
 
     void db_start();
     void http_start();
+    void http_start_httplib(const std::string& name);
+    void http_start_reactor(const std::string& name);
 
     void on_liveness_check(const OnLivenessCheckFunc& cb) { return on_liveness_check(OnLivenessCheckFunc(cb)); }
     void on_liveness_check(OnLivenessCheckFunc&& cb) { liveness_check_cb_ = std::move(cb); }
@@ -77,17 +157,28 @@ private:
     void on_readiness_check(const OnReadinessCheckFunc& cb) { return on_readiness_check(OnReadinessCheckFunc(cb)); }
     void on_readiness_check(OnReadinessCheckFunc&& cb) { readiness_check_cb_ = std::move(cb); }
 
+    // обработчики маршрутов - сопрограммы: ожидая БД или пул паролей (co_await),
+    // они освобождают поток пула запросов (режимы epoll и io_uring), а в режиме
+    // httplib выполняются в потоке соединения до конца (sync_wait)
+    void dispatch_handler(httplib::Request& req, httplib::Response& res, std::chrono::steady_clock::time_point received,
+                          Http::RequestDone done);
     bool pre_routing_handler(const httplib::Request& req, httplib::Response& res);
-    bool login_handler(const httplib::Request& req, httplib::Response& res);
-    bool user_register_handler(const httplib::Request& req, httplib::Response& res);
-    bool user_get_id_handler(const httplib::Request& req, httplib::Response& res);
-    bool user_search_handler(const httplib::Request& req, httplib::Response& res);
-    void liveness_handler(const httplib::Request& req, httplib::Response& res);
-    void readiness_handler(const httplib::Request& req, httplib::Response& res);
+    ThreadHelpers::Task<bool> route_handler(httplib::Request& req, httplib::Response& res, std::chrono::steady_clock::time_point received);
+    ThreadHelpers::Task<bool> login_handler(const httplib::Request& req, httplib::Response& res, const Deadline& deadline);
+    ThreadHelpers::Task<bool> user_register_handler(const httplib::Request& req, httplib::Response& res, const Deadline& deadline);
+    ThreadHelpers::Task<bool> user_get_id_handler(const httplib::Request& req, httplib::Response& res, const Deadline& deadline);
+    ThreadHelpers::Task<bool> user_search_handler(const httplib::Request& req, httplib::Response& res, const Deadline& deadline);
+    ThreadHelpers::Task<bool> liveness_handler(const httplib::Request& req, httplib::Response& res, const Deadline& deadline);
+    ThreadHelpers::Task<bool> readiness_handler(const httplib::Request& req, httplib::Response& res, const Deadline& deadline);
     void post_routing_handler(const httplib::Request& req, httplib::Response& res);
     void error_handler(const httplib::Request& req, httplib::Response& res);
     void exception_handler(const httplib::Request& req, httplib::Response& res, std::exception_ptr ep);
     void log_handler(const httplib::Request& req, const httplib::Response& res);
+    void shed_handler(const httplib::Request& req, httplib::Response& res, int retry_after_sec);
+
+    void compress_response(const httplib::Request& req, httplib::Response& res, size_t route);
+    void set_encoded_content(const httplib::Request& req, httplib::Response& res, size_t route,
+                             const Http::EncodedBody& body);
 
     void db_create_users_table();
     void db_create_index_users_names_search();
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "helpers/uuid.h"
+
+namespace SocialNetwork {
+
+//
+// кэш проверенных паролей для /login, чтобы повторный вход с тем же паролем
+// не стоил полного bcrypt. по id пользователя хранится HMAC-SHA256 последнего
+// успешно проверенного пароля и хеш bcrypt из БД, с которым он совпал. ключ HMAC
+// генерируется при создании кэша и нигде не сохраняется, сами пароли не хранятся.
+// запись действительна, пока не истекло время жизни и хеш в БД тот же:
+// при смене хеша запись удаляется при первой же проверке.
+// устроен как Http::ResponseCache: сегменты со своими мьютексами, вытеснение
+// самых старых записей при переполнении
+//
+class CredentialCache
+{
+public:
+    CredentialCache() = delete;
+    CredentialCache(const CredentialCache&) = delete;
+    CredentialCache& operator=(const CredentialCache&) = delete;
+
+    CredentialCache(std::chrono::milliseconds ttl, size_t capacity);
+
+    // true - этот пароль пользователя уже был проверен с хешем 'pwd_hash'
+    bool verified(const UuidHelpers::Uuid& id, std::string_view password, std::string_view pwd_hash);
+
+    // пароль пользователя успешно проверен bcrypt с хешем 'pwd_hash'
+    void insert(const UuidHelpers::Uuid& id, std::string_view password, std::string pwd_hash);
+
+private:
+    using clock_t  = std::chrono::steady_clock;
+    using digest_t = std::array<unsigned char, 32>;
+
+    static constexpr size_t shards_count = 16;
+
+    struct item_s {
+        digest_t            digest{};
+        std::string         pwd_hash{};
+        clock_t::time_point expires{};
+    };
+
+    struct shard_s {
+        std::mutex                                                      mutex{};
+        std::unordered_map<UuidHelpers::Uuid, item_s>                   items{};
+        std::deque<std::pair<UuidHelpers::Uuid, clock_t::time_point>>  order{};
+    };
+
+    shard_s& shard_(const UuidHelpers::Uuid& id) noexcept {
+        return shards_[std::hash<UuidHelpers::Uuid>{}(id) % shards_count];
+    }
+
+    // HMAC от id и пароля: одинаковые пароли разных пользователей дают разные значения
+    digest_t digest_(const UuidHelpers::Uuid& id, std::string_view password) const;
+
+    const std::chrono::milliseconds     ttl_;
+    const size_t                        shard_capacity_;
+    std::array<unsigned char, 32>       secret_{};
+    std::array<shard_s, shards_count>   shards_{};
+};
+
+} // namespace SocialNetwork
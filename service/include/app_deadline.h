@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <pqxx/pqxx>
+
+namespace SocialNetwork {
+
+//
+// крайний срок обработки запроса: момент приема запроса плюс таймаут маршрута,
+// либо меньший таймаут из заголовка X-Request-Timeout. после него клиент
+// ответ уже не ждет, и продолжать работу бессмысленно
+//
+class Deadline
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    Deadline() = default;   // без крайнего срока
+    explicit Deadline(clock_t::time_point at)
+    :   at_(at) {}
+
+    bool is_set() const noexcept { return at_ != clock_t::time_point::max(); }
+    bool expired(clock_t::time_point now = clock_t::now()) const noexcept { return now >= at_; }
+    clock_t::time_point at() const noexcept { return at_; }
+
+    // сколько осталось, с округлением вверх до миллисекунды, ноль - срок истек
+    std::chrono::milliseconds remaining(clock_t::time_point now = clock_t::now()) const noexcept {
+        if (now >= at_) return std::chrono::milliseconds::zero();
+        return std::chrono::ceil<std::chrono::milliseconds>(at_ - now);
+    }
+
+private:
+    clock_t::time_point at_{clock_t::time_point::max()};
+};
+
+// крайний срок истек до начала работы с БД
+class deadline_exceeded : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+//
+// отмена (PQcancel) запросов к БД, чья транзакция не успела к крайнему сроку.
+// statement_timeout ограничивает каждый оператор SQL отдельно, а здесь
+// ограничивается вся транзакция, включая COMMIT и паузы между операторами.
+// отмененный запрос завершается исключением pqxx::query_cancelled, а соединение
+// сразу освобождается для других запросов вместо бесполезной работы
+//
+class QueryCanceller
+{
+public:
+    using OnCancelFunc = std::function<void()>;
+
+    QueryCanceller(const QueryCanceller&) = delete;
+    QueryCanceller& operator=(const QueryCanceller&) = delete;
+
+    explicit QueryCanceller(OnCancelFunc on_cancel);
+    ~QueryCanceller();
+
+private:
+    friend class DeadlineScope;
+
+    struct entry_s;
+    using entries_t = std::multimap<Deadline::clock_t::time_point, entry_s*>;
+
+    // принадлежит DeadlineScope, после отмены запроса из entries_ удаляется
+    struct entry_s {
+        pqxx::connection*   conn{nullptr};
+        entries_t::iterator it{};
+        bool                cancelled{false};   // удалена из entries_ потоком отмены
+        bool                cancelling{false};  // cancel_query() выполняется без мьютекса
+    };
+
+    OnCancelFunc            on_cancel_{};
+    std::mutex              mutex_{};
+    std::condition_variable condition_{};
+    std::condition_variable cancel_done_{};
+    entries_t               entries_{};
+    bool                    stop_{false};
+    std::thread             thread_{};
+
+    void watch_(entry_s& entry, Deadline::clock_t::time_point at);
+    void unwatch_(entry_s& entry);
+    void run_();
+};
+
+//
+// транзакция с крайним сроком: остаток срока выставляется как statement_timeout
+// (SET LOCAL - до конца транзакции), а соединение передается QueryCanceller.
+// объявляется после транзакции, чтобы отмена по сроку была снята раньше,
+// чем соединение вернется в пул. при истекшем сроке - deadline_exceeded
+//
+class DeadlineScope
+{
+public:
+    DeadlineScope(const DeadlineScope&) = delete;
+    DeadlineScope& operator=(const DeadlineScope&) = delete;
+
+    DeadlineScope(QueryCanceller* canceller, pqxx::connection& conn, pqxx::work& tx, const Deadline& deadline);
+    ~DeadlineScope();
+
+private:
+    QueryCanceller*          canceller_{nullptr};
+    QueryCanceller::entry_s  entry_{};
+};
+
+} // namespace SocialNetwork
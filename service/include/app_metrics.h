@@ -1,19 +1,97 @@
 #pragma once
 
+#include <array>
+#include <cstdlib>
+#include <limits>
 #include <set>
 #include <map>
+#include <string_view>
+#include <vector>
+#include <prometheus/collectable.h>
 #include <prometheus/counter.h>
+#include <prometheus/gauge.h>
 #include <prometheus/histogram.h>
 #include <prometheus/exposer.h>
+#include <prometheus/metric_family.h>
 #include <prometheus/registry.h>
+#include "helpers/thread_pool.h"
+#include "http/reactor_server.h"
 
 namespace SocialNetwork {
 
+//
+// метрики всех пулов потоков процесса (ThreadHelpers::ThreadPool::for_each) с меткой
+// pool: пул запросов httplib, пулы дорожек reactor-сервера, пул хеширования паролей.
+// значения собираются при запросе метрик из статистики пулов, которую потоки пула
+// копят каждый в своей части, поэтому на пути задачи нет общих для потоков счетчиков
+//
+class ThreadPoolCollector : public prometheus::Collectable
+{
+public:
+    ThreadPoolCollector() { ThreadHelpers::ThreadPool::enable_timings(true); }
+
+    std::vector<prometheus::MetricFamily> Collect() const override {
+        prometheus::MetricFamily depth{"thread_pool_queue_depth",
+            "Thread pool tasks waiting in the queue", prometheus::MetricType::Gauge, {}};
+        prometheus::MetricFamily busy{"thread_pool_threads_busy",
+            "Thread pool threads running a task", prometheus::MetricType::Gauge, {}};
+        prometheus::MetricFamily refused{"thread_pool_tasks_refused_total",
+            "Thread pool tasks refused because the queue is full", prometheus::MetricType::Counter, {}};
+        prometheus::MetricFamily wait{"thread_pool_queue_wait_seconds",
+            "Thread pool task wait time in the queue", prometheus::MetricType::Histogram, {}};
+        prometheus::MetricFamily run{"thread_pool_task_duration_seconds",
+            "Thread pool task run time", prometheus::MetricType::Histogram, {}};
+
+        ThreadHelpers::ThreadPool::for_each([&](const ThreadHelpers::ThreadPool& pool) {
+            prometheus::ClientMetric one;
+            one.label = {{"pool", pool.name()}};
+
+            one.gauge.value = static_cast<double>(pool.tasks_active_count());
+            depth.metric.push_back(one);
+            one.gauge.value = static_cast<double>(pool.threads_busy_count());
+            busy.metric.push_back(one);
+            one.counter.value = static_cast<double>(pool.tasks_refused_count());
+            refused.metric.push_back(one);
+
+            ThreadHelpers::ThreadPool::Timings wait_timings, run_timings;
+            pool.tasks_timings(wait_timings, run_timings);
+            one.histogram = histogram_(wait_timings);
+            wait.metric.push_back(one);
+            one.histogram = histogram_(run_timings);
+            run.metric.push_back(one);
+        });
+        return {std::move(depth), std::move(busy), std::move(refused), std::move(wait), std::move(run)};
+    }
+
+private:
+    static prometheus::ClientMetric::Histogram histogram_(const ThreadHelpers::ThreadPool::Timings& timings) {
+        const auto& bounds = ThreadHelpers::ThreadPool::timing_bounds_ns;
+        prometheus::ClientMetric::Histogram result;
+        for (size_t i = 0; i < timings.buckets.size(); ++i) {
+            result.sample_count += timings.buckets[i];
+            result.bucket.push_back({result.sample_count, (i < bounds.size())
+                ? static_cast<double>(bounds[i]) / 1e9
+                : std::numeric_limits<double>::infinity()});
+        }
+        result.sample_sum = static_cast<double>(timings.sum_ns) / 1e9;
+        return result;
+    }
+};
+
 class Metrics {
 public:
-    Metrics(const std::set<std::string>& tags)
+    // 'endpoints' - метки endpoint для маршрутов в порядке таблицы маршрутов,
+    // для пустой метки запросы маршрута не учитываются.
+    // 'lanes' - метки lane для дорожек пула потоков в порядке ReactorOptions::lanes
+    Metrics(const std::set<std::string>& tags,
+            const std::vector<std::string_view>& endpoints,
+            const std::vector<std::string_view>& lanes)
     :   latency_buckets_{0.05, 0.1, 0.5, 1.0, 2.0, 5.0},
-        registry_(std::make_shared<prometheus::Registry>()) {
+        pipeline_depth_buckets_{1, 2, 4, 8, 16, 32, 64, 128},
+        compression_ratio_buckets_{1.5, 2, 3, 4, 6, 8, 12, 16},
+        queue_sojourn_buckets_{0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0, 5.0},
+        registry_(std::make_shared<prometheus::Registry>()),
+        pools_(std::make_shared<ThreadPoolCollector>()) {
 
         auto& host_c = prometheus::BuildCounter()
             .Name("http_requests_to_host_total")
@@ -27,31 +105,155 @@ public:
             .Name("http_requests_total")
             .Help("HTTP total requests counter")
             .Register(*registry_);
-        total_requests_login_         = &total_c.Add({{"endpoint", "/login"}});
-        total_requests_user_register_ = &total_c.Add({{"endpoint", "/user/register"}});
-        total_requests_user_get_id_   = &total_c.Add({{"endpoint", "/user/get/:id"}});
-        total_requests_user_search_   = &total_c.Add({{"endpoint", "/user/search"}});
-
         auto& failed_c = prometheus::BuildCounter()
             .Name("http_requests_failed_total")
             .Help("HTTP failed requests counter")
             .Register(*registry_);
-        failed_requests_login_         = &failed_c.Add({{"endpoint", "/login"}});
-        failed_requests_user_register_ = &failed_c.Add({{"endpoint", "/user/register"}});
-        failed_requests_user_get_id_   = &failed_c.Add({{"endpoint", "/user/get/:id"}});
-        failed_requests_user_search_   = &failed_c.Add({{"endpoint", "/user/search"}});
-
         auto& latency_h = prometheus::BuildHistogram()
             .Name("http_request_duration_seconds")
             .Help("HTTP request latency")
             .Register(*registry_);
-        latency_requests_login_         = &latency_h.Add({{"endpoint", "/login"}}, latency_buckets_);
-        latency_requests_user_register_ = &latency_h.Add({{"endpoint", "/user/register"}}, latency_buckets_);
-        latency_requests_user_get_id_   = &latency_h.Add({{"endpoint", "/user/get/:id"}}, latency_buckets_);
-        latency_requests_user_search_   = &latency_h.Add({{"endpoint", "/user/search"}}, latency_buckets_);
+        // сжатие тел ответов: во сколько раз уменьшилось тело и процессорное время на сжатие
+        auto& ratio_h = prometheus::BuildHistogram()
+            .Name("http_response_compression_ratio")
+            .Help("HTTP response body size divided by its compressed size")
+            .Register(*registry_);
+        auto& expired_c = prometheus::BuildCounter()
+            .Name("http_requests_deadline_exceeded_total")
+            .Help("HTTP requests failed because their deadline expired")
+            .Register(*registry_);
+        auto& compression_c = prometheus::BuildCounter()
+            .Name("http_response_compression_cpu_seconds_total")
+            .Help("HTTP response compression CPU time")
+            .Register(*registry_);
+        for (const auto endpoint : endpoints) {
+            endpoint_s one;
+            if (!endpoint.empty()) {
+                const prometheus::Labels labels{{"endpoint", std::string(endpoint)}};
+                one.total   = &total_c.Add(labels);
+                one.failed  = &failed_c.Add(labels);
+                one.latency = &latency_h.Add(labels, latency_buckets_);
+                one.compression_ratio = &ratio_h.Add(labels, compression_ratio_buckets_);
+                one.compression_cpu   = &compression_c.Add(labels);
+                one.expired           = &expired_c.Add(labels);
+            }
+            endpoints_.push_back(one);
+        }
+
+        // конвейерная обработка запросов (HTTP/1.1 pipelining) в режимах epoll и io_uring
+        pipeline_depth_ = &prometheus::BuildHistogram()
+            .Name("http_pipeline_depth")
+            .Help("HTTP pipelined requests of one connection in processing when a new one is dispatched")
+            .Register(*registry_)
+            .Add({}, pipeline_depth_buckets_);
+        pipeline_stalls_ = &prometheus::BuildCounter()
+            .Name("http_pipeline_stalls_total")
+            .Help("HTTP request parsing paused because connection pipeline is full")
+            .Register(*registry_)
+            .Add({});
+        pipeline_max_depth_ = &prometheus::BuildGauge()
+            .Name("http_pipeline_max_depth")
+            .Help("HTTP pipelined requests of one connection processed at once, limit")
+            .Register(*registry_)
+            .Add({});
+        inflight_requests_ = &prometheus::BuildGauge()
+            .Name("http_inflight_requests")
+            .Help("HTTP requests dispatched to the thread pool and not completed yet")
+            .Register(*registry_)
+            .Add({});
+        inflight_limit_ = &prometheus::BuildGauge()
+            .Name("http_inflight_requests_limit")
+            .Help("HTTP requests dispatched to the thread pool, limit (threads + queue capacity)")
+            .Register(*registry_)
+            .Add({});
+
+        // соединения клиентов
+        open_connections_ = &prometheus::BuildGauge()
+            .Name("http_connections_open")
+            .Help("HTTP client connections accepted and not closed yet")
+            .Register(*registry_)
+            .Add({});
+        idle_connections_ = &prometheus::BuildGauge()
+            .Name("http_connections_idle")
+            .Help("HTTP client connections waiting for the next request")
+            .Register(*registry_)
+            .Add({});
+        auto& reaped_c = prometheus::BuildCounter()
+            .Name("http_connections_reaped_total")
+            .Help("HTTP client connections closed by the server")
+            .Register(*registry_);
+        reaped_connections_[static_cast<size_t>(Http::ReapReason::IDLE_TIMEOUT)] = &reaped_c.Add({{"reason", "idle_timeout"}});
+        reaped_connections_[static_cast<size_t>(Http::ReapReason::READ_TIMEOUT)] = &reaped_c.Add({{"reason", "read_timeout"}});
+        reaped_connections_[static_cast<size_t>(Http::ReapReason::SATURATED)]    = &reaped_c.Add({{"reason", "saturated"}});
+        rejected_connections_ = &prometheus::BuildCounter()
+            .Name("http_connections_rejected_total")
+            .Help("HTTP client connections refused because of the per client IP limit")
+            .Register(*registry_)
+            .Add({});
+
+        // дорожки пула потоков и отбор запросов по времени ожидания в очереди (CoDel)
+        auto& sojourn_h = prometheus::BuildHistogram()
+            .Name("http_queue_sojourn_seconds")
+            .Help("HTTP task wait time in the thread pool queue")
+            .Register(*registry_);
+        auto& shed_c = prometheus::BuildCounter()
+            .Name("http_requests_shed_total")
+            .Help("HTTP requests answered with 503 because they waited too long in the thread pool queue")
+            .Register(*registry_);
+        auto& depth_g = prometheus::BuildGauge()
+            .Name("http_lane_queue_depth")
+            .Help("HTTP tasks waiting in the thread pool queue of the lane")
+            .Register(*registry_);
+        auto& task_h = prometheus::BuildHistogram()
+            .Name("http_lane_task_duration_seconds")
+            .Help("HTTP request processing time in a thread of the lane, without queue wait")
+            .Register(*registry_);
+        auto& threads_g = prometheus::BuildGauge()
+            .Name("http_lane_threads")
+            .Help("HTTP thread pool threads of the lane")
+            .Register(*registry_);
+        auto& threads_c = prometheus::BuildCounter()
+            .Name("http_lane_threads_changes_total")
+            .Help("HTTP elastic thread pool threads of the lane started under load (grow) or exited after idle timeout (shrink)")
+            .Register(*registry_);
+        auto& capacity_g = prometheus::BuildGauge()
+            .Name("http_lane_queue_capacity")
+            .Help("HTTP thread pool queue capacity of the lane")
+            .Register(*registry_);
+        for (const auto lane : lanes) {
+            const prometheus::Labels labels{{"lane", std::string(lane)}};
+            lane_s one;
+            one.queue_sojourn  = &sojourn_h.Add(labels, queue_sojourn_buckets_);
+            one.shed           = &shed_c.Add(labels);
+            one.queue_depth    = &depth_g.Add(labels);
+            one.task_duration  = &task_h.Add(labels, latency_buckets_);
+            one.threads        = &threads_g.Add(labels);
+            one.threads_grown  = &threads_c.Add({{"lane", std::string(lane)}, {"change", "grow"}});
+            one.threads_shrunk = &threads_c.Add({{"lane", std::string(lane)}, {"change", "shrink"}});
+            one.queue_capacity = &capacity_g.Add(labels);
+            lanes_.push_back(one);
+        }
+
+        // проверка пароля при входе по кэшу проверенных паролей (без bcrypt)
+        auto& credential_c = prometheus::BuildCounter()
+            .Name("http_credential_cache_requests_total")
+            .Help("Login password checks by the verified credential cache")
+            .Register(*registry_);
+        credential_cache_hits_   = &credential_c.Add({{"result", "hit"}});
+        credential_cache_misses_ = &credential_c.Add({{"result", "miss"}});
+
+        // запросы к БД, отмененные по крайнему сроку HTTP-запроса
+        cancelled_queries_ = &prometheus::BuildCounter()
+            .Name("db_queries_cancelled_total")
+            .Help("DB queries cancelled because the HTTP request deadline expired")
+            .Register(*registry_)
+            .Add({});
     }
 
     std::shared_ptr<prometheus::Registry> registry() const { return registry_; }
+    // регистрируется в prometheus::Exposer рядом с registry(): в prometheus::Registry
+    // можно добавить только его собственные семейства метрик
+    std::shared_ptr<ThreadPoolCollector>  pools() const { return pools_; }
 
     void count_request_to_host(const std::string& tag) {
         auto counter = total_requests_to_host_.find(tag);
@@ -60,39 +262,101 @@ public:
         }
     }
 
-    void count_request_login()         { total_requests_login_->Increment(); }
-    void count_request_user_register() { total_requests_user_register_->Increment(); }
-    void count_request_user_get_id()   { total_requests_user_get_id_->Increment(); }
-    void count_request_user_search()   { total_requests_user_search_->Increment(); }
+    // 'route' - номер маршрута в таблице маршрутов
+    void count_request(size_t route) {
+        if (auto counter = endpoints_[route].total) counter->Increment();
+    }
+    void count_failed_request(size_t route) {
+        if (auto counter = endpoints_[route].failed) counter->Increment();
+    }
+    void store_latency_request(size_t route, double seconds) {
+        if (auto histogram = endpoints_[route].latency) histogram->Observe(seconds);
+    }
+    void count_expired_request(size_t route) {
+        if (auto counter = endpoints_[route].expired) counter->Increment();
+    }
+    void store_compression(size_t route, double ratio, double cpu_seconds) {
+        if (auto histogram = endpoints_[route].compression_ratio) histogram->Observe(ratio);
+        if (auto counter = endpoints_[route].compression_cpu) counter->Increment(cpu_seconds);
+    }
+
+    void set_pipeline_limits(int max_depth, int inflight_limit) {
+        pipeline_max_depth_->Set(max_depth);
+        inflight_limit_->Set(inflight_limit);
+    }
+    void store_pipeline_depth(size_t depth) { pipeline_depth_->Observe(static_cast<double>(depth)); }
+    void count_pipeline_stall()             { pipeline_stalls_->Increment(); }
+    void change_inflight_requests(int delta) { inflight_requests_->Increment(delta); }
 
-    void count_failed_request_login()         { failed_requests_login_->Increment(); }
-    void count_failed_request_user_register() { failed_requests_user_register_->Increment(); }
-    void count_failed_request_user_get_id()   { failed_requests_user_get_id_->Increment(); }
-    void count_failed_request_user_search()   { failed_requests_user_search_->Increment(); }
+    void change_open_connections(int delta)           { open_connections_->Increment(delta); }
+    void change_idle_connections(int delta)           { idle_connections_->Increment(delta); }
+    void count_reaped_connection(Http::ReapReason r)  { reaped_connections_[static_cast<size_t>(r)]->Increment(); }
+    void count_rejected_connection()                  { rejected_connections_->Increment(); }
 
-    void store_latency_request_login(double seconds)         { latency_requests_login_->Observe(seconds); }
-    void store_latency_request_user_register(double seconds) { latency_requests_user_register_->Observe(seconds); }
-    void store_latency_request_user_get_id(double seconds)   { latency_requests_user_get_id_->Observe(seconds); }
-    void store_latency_request_user_search(double seconds)   { latency_requests_user_search_->Observe(seconds); }
+    // 'lane' - номер дорожки пула потоков
+    void set_lane_limits(size_t lane, size_t threads, size_t queue_capacity) {
+        lanes_[lane].threads->Set(static_cast<double>(threads));
+        lanes_[lane].queue_capacity->Set(static_cast<double>(queue_capacity));
+    }
+    void store_queue_sojourn(size_t lane, double seconds) { lanes_[lane].queue_sojourn->Observe(seconds); }
+    void count_shed_request(size_t lane)                  { lanes_[lane].shed->Increment(); }
+    void change_lane_queue(size_t lane, int delta)        { lanes_[lane].queue_depth->Increment(delta); }
+    void store_lane_task(size_t lane, double seconds)     { lanes_[lane].task_duration->Observe(seconds); }
+    // эластичный пул дорожки добавил (delta > 0) или завершил (delta < 0) потоки
+    void change_lane_threads(size_t lane, int delta) {
+        lanes_[lane].threads->Increment(delta);
+        (delta > 0 ? lanes_[lane].threads_grown : lanes_[lane].threads_shrunk)->Increment(std::abs(delta));
+    }
+
+    void count_cancelled_query()             { cancelled_queries_->Increment(); }
+    void count_credential_cache(bool hit)    { (hit ? credential_cache_hits_ : credential_cache_misses_)->Increment(); }
 
 private:
     const std::vector<double>             latency_buckets_{};
+    const std::vector<double>             pipeline_depth_buckets_{};
+    const std::vector<double>             compression_ratio_buckets_{};
+    const std::vector<double>             queue_sojourn_buckets_{};
     std::shared_ptr<prometheus::Registry> registry_{nullptr};
+    std::shared_ptr<ThreadPoolCollector>  pools_{nullptr};
 
     std::map<std::string, prometheus::Counter*> total_requests_to_host_{};
 
-    prometheus::Counter*   total_requests_login_{nullptr};
-    prometheus::Counter*   total_requests_user_register_{nullptr};
-    prometheus::Counter*   total_requests_user_get_id_{nullptr};
-    prometheus::Counter*   total_requests_user_search_{nullptr};
-    prometheus::Counter*   failed_requests_login_{nullptr};
-    prometheus::Counter*   failed_requests_user_register_{nullptr};
-    prometheus::Counter*   failed_requests_user_get_id_{nullptr};
-    prometheus::Counter*   failed_requests_user_search_{nullptr};
-    prometheus::Histogram* latency_requests_login_{nullptr};
-    prometheus::Histogram* latency_requests_user_register_{nullptr};
-    prometheus::Histogram* latency_requests_user_get_id_{nullptr};
-    prometheus::Histogram* latency_requests_user_search_{nullptr};
+    struct endpoint_s {
+        prometheus::Counter*   total{nullptr};
+        prometheus::Counter*   failed{nullptr};
+        prometheus::Histogram* latency{nullptr};
+        prometheus::Histogram* compression_ratio{nullptr};
+        prometheus::Counter*   compression_cpu{nullptr};
+        prometheus::Counter*   expired{nullptr};
+    };
+    std::vector<endpoint_s> endpoints_{};
+
+    prometheus::Histogram* pipeline_depth_{nullptr};
+    prometheus::Counter*   pipeline_stalls_{nullptr};
+    prometheus::Gauge*     pipeline_max_depth_{nullptr};
+    prometheus::Gauge*     inflight_requests_{nullptr};
+    prometheus::Gauge*     inflight_limit_{nullptr};
+
+    prometheus::Gauge*                  open_connections_{nullptr};
+    prometheus::Gauge*                  idle_connections_{nullptr};
+    std::array<prometheus::Counter*, 3> reaped_connections_{};
+    prometheus::Counter*                rejected_connections_{nullptr};
+
+    struct lane_s {
+        prometheus::Histogram* queue_sojourn{nullptr};
+        prometheus::Counter*   shed{nullptr};
+        prometheus::Gauge*     queue_depth{nullptr};
+        prometheus::Histogram* task_duration{nullptr};
+        prometheus::Gauge*     threads{nullptr};
+        prometheus::Counter*   threads_grown{nullptr};
+        prometheus::Counter*   threads_shrunk{nullptr};
+        prometheus::Gauge*     queue_capacity{nullptr};
+    };
+    std::vector<lane_s> lanes_{};
+
+    prometheus::Counter*   cancelled_queries_{nullptr};
+    prometheus::Counter*   credential_cache_hits_{nullptr};
+    prometheus::Counter*   credential_cache_misses_{nullptr};
 };
 
 } // namespace SocialNetwork
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "app_deadline.h"
+#include "helpers/coroutine.h"
+#include "helpers/thread_pool.h"
+#include "logger/logger.h"
+
+namespace SocialNetwork {
+
+// очередь пула хеширования паролей переполнена
+class hasher_overloaded : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+//
+// пул потоков для bcrypt: хеш пароля с cost 12 считается сотни миллисекунд CPU,
+// поэтому считается не в потоке обработчика, а в отдельном пуле, потоков в котором
+// не больше, чем ядер доступно процессу. обработчик ждет результат (co_await) до
+// крайнего срока запроса, не занимая поток пула запросов, а соединение к БД к
+// этому моменту уже должно быть возвращено в пул. задача запроса, который
+// перестал ждать раньше, чем до нее дошла очередь, пропускается
+//
+class PasswordHasher
+{
+public:
+    PasswordHasher() = delete;
+    PasswordHasher(const PasswordHasher&) = delete;
+    PasswordHasher& operator=(const PasswordHasher&) = delete;
+
+    // 'cpus' - ядра потоков пула (CpuTopology::placement), пустой - не закреплять
+    PasswordHasher(std::shared_ptr<Logging::Logger> logger, size_t threads_count, size_t queue_capacity,
+                   std::vector<unsigned> cpus = {});
+
+    size_t threads_count() const { return pool_.threads_max_count(); }
+
+    // исключения: hasher_overloaded - очередь переполнена,
+    // deadline_exceeded - результат не готов к крайнему сроку
+    ThreadHelpers::Task<std::string> hash(std::string password, Deadline deadline);
+    ThreadHelpers::Task<bool> validate(std::string password, std::string hash, Deadline deadline);
+
+private:
+    static constexpr int cost_{12};
+
+    ThreadHelpers::ThreadPool pool_;
+
+    template<typename Func>
+    auto run_(Func func, Deadline deadline) -> ThreadHelpers::Task<decltype(func())>;
+};
+
+} // namespace SocialNetwork
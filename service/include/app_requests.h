@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string_view>
+#include "helpers/json_reader.h"
+
+namespace SocialNetwork {
+
+//
+// тела запросов сервиса. строковые поля - это std::string_view на тело
+// запроса (или на буфер для строк с escape-последовательностями), см.
+// JsonHelpers::read_object(). ограничения длины полей соответствуют
+// колонкам таблицы users (см. App::db_create_users_table)
+//
+
+struct login_request_s {
+    std::string_view id{};
+    std::string_view password{};
+};
+
+struct user_register_request_s {
+    std::string_view password{};
+    std::string_view first_name{};
+    std::string_view second_name{};
+    std::string_view birthdate{};
+    std::string_view biography{};
+    std::string_view city{};
+};
+
+inline constexpr size_t password_min_length = 8;
+
+template <>
+struct JsonHelpers::Schema<login_request_s> {
+    using type = std::tuple<JsonHelpers::Input<"id",       &login_request_s::id,       {.max_length = 36}>,
+                            JsonHelpers::Input<"password", &login_request_s::password>>;
+};
+
+template <>
+struct JsonHelpers::Schema<user_register_request_s> {
+    using type = std::tuple<JsonHelpers::Input<"password",    &user_register_request_s::password,    {.min_length = password_min_length}>,
+                            JsonHelpers::Input<"first_name",  &user_register_request_s::first_name,  {.max_length = 50}>,
+                            JsonHelpers::Input<"second_name", &user_register_request_s::second_name, {.max_length = 50}>,
+                            JsonHelpers::Input<"birthdate",   &user_register_request_s::birthdate,   {.min_length = 10, .max_length = 10}>,
+                            JsonHelpers::Input<"biography",   &user_register_request_s::biography>,
+                            JsonHelpers::Input<"city",        &user_register_request_s::city,        {.max_length = 50}>>;
+};
+
+} // namespace SocialNetwork
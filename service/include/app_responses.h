@@ -0,0 +1,63 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include "helpers/json_writer.h"
+
+namespace SocialNetwork {
+
+//
+// тела ответов сервиса. строковые поля - это std::string_view на данные
+// pqxx::result (или запроса), поэтому структура должна быть сериализована,
+// пока живут эти данные
+//
+
+struct error_response_s {
+    int              code{0};
+    std::string_view message{};
+};
+
+struct login_response_s {
+    std::string_view token{};
+};
+
+struct user_register_response_s {
+    std::string_view user_id{};
+};
+
+struct user_response_s {
+    std::string_view                id{};
+    std::string_view                first_name{};
+    std::string_view                second_name{};
+    std::optional<std::string_view> birthdate{};
+    std::optional<std::string_view> biography{};
+    std::optional<std::string_view> city{};
+};
+
+template <>
+struct JsonHelpers::Fields<error_response_s> {
+    using type = std::tuple<JsonHelpers::Field<"code",    &error_response_s::code>,
+                            JsonHelpers::Field<"message", &error_response_s::message>>;
+};
+
+template <>
+struct JsonHelpers::Fields<login_response_s> {
+    using type = std::tuple<JsonHelpers::Field<"token", &login_response_s::token>>;
+};
+
+template <>
+struct JsonHelpers::Fields<user_register_response_s> {
+    using type = std::tuple<JsonHelpers::Field<"user_id", &user_register_response_s::user_id>>;
+};
+
+template <>
+struct JsonHelpers::Fields<user_response_s> {
+    using type = std::tuple<JsonHelpers::Field<"id",          &user_response_s::id>,
+                            JsonHelpers::Field<"first_name",  &user_response_s::first_name>,
+                            JsonHelpers::Field<"second_name", &user_response_s::second_name>,
+                            JsonHelpers::Field<"birthdate",   &user_response_s::birthdate>,
+                            JsonHelpers::Field<"biography",   &user_response_s::biography>,
+                            JsonHelpers::Field<"city",        &user_response_s::city>>;
+};
+
+} // namespace SocialNetwork
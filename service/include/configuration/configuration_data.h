@@ -11,7 +11,26 @@ namespace SocialNetwork {
 namespace config_max {
 
     extern const int http_threads_count;
+    extern const int http_threads_max_count;
+    extern const int http_threads_idle_timeout;
     extern const int http_queue_capacity;
+    extern const int http_reactors_count;
+    extern const int http_pipeline_max_depth;
+    extern const int http_keep_alive_max_count;
+    extern const int http_keep_alive_timeout;
+    extern const int http_max_connections_per_ip;
+    extern const int http_compression_min_size;
+    extern const int http_search_cache_ttl;
+    extern const int http_queue_target_delay;
+    extern const int http_queue_interval;
+    extern const int http_cpu_threads_count;
+    extern const int http_cpu_queue_capacity;
+    extern const int http_cpu_queue_target_delay;
+    extern const int http_cpu_queue_interval;
+    extern const int http_bcrypt_threads_count;
+    extern const int http_db_threads_count;
+    extern const int http_credential_cache_ttl;
+    extern const int workers_count;
 
 } // namespace config_max
 
@@ -26,7 +45,33 @@ namespace config_def {
     extern const std::string http_listening;
     extern const uint16_t    http_port;
     extern const int         http_threads_count;
+    extern const int         http_threads_max_count;
+    extern const int         http_threads_idle_timeout;
     extern const int         http_queue_capacity;
+    extern const std::string http_server_mode;
+    extern const int         http_reactors_count;
+    extern const int         http_pipeline_max_depth;
+    extern const int         http_keep_alive_max_count;
+    extern const int         http_keep_alive_timeout;
+    extern const int         http_max_connections_per_ip;
+    extern const int         http_compression_min_size;
+    extern const int         http_search_cache_ttl;
+    extern const int         http_queue_target_delay;
+    extern const int         http_queue_interval;
+    extern const int         http_cpu_threads_count;
+    extern const int         http_cpu_queue_capacity;
+    extern const int         http_cpu_queue_target_delay;
+    extern const int         http_cpu_queue_interval;
+    extern const int         http_bcrypt_threads_count;
+    extern const int         http_db_threads_count;
+    extern const int         http_credential_cache_ttl;
+    extern const std::string http_threads_affinity;
+    extern const std::string http_reactors_affinity;
+    extern const std::string http_bcrypt_affinity;
+
+    extern const std::set<std::string> http_server_modes;
+
+    extern const int workers_count;
 
     extern const std::string prometheus_listening;
     extern const std::string prometheus_host;
@@ -39,7 +84,26 @@ namespace config_def {
 namespace config_min {
 
     extern const int http_threads_count;
+    extern const int http_threads_max_count;
+    extern const int http_threads_idle_timeout;
     extern const int http_queue_capacity;
+    extern const int http_reactors_count;
+    extern const int http_pipeline_max_depth;
+    extern const int http_keep_alive_max_count;
+    extern const int http_keep_alive_timeout;
+    extern const int http_max_connections_per_ip;
+    extern const int http_compression_min_size;
+    extern const int http_search_cache_ttl;
+    extern const int http_queue_target_delay;
+    extern const int http_queue_interval;
+    extern const int http_cpu_threads_count;
+    extern const int http_cpu_queue_capacity;
+    extern const int http_cpu_queue_target_delay;
+    extern const int http_cpu_queue_interval;
+    extern const int http_bcrypt_threads_count;
+    extern const int http_db_threads_count;
+    extern const int http_credential_cache_ttl;
+    extern const int workers_count;
 
 } // namespace config_min
 
@@ -58,11 +122,36 @@ namespace config_data {
 
         std::string http_listening;
         int         http_threads_count;
+        int         http_threads_max_count;             // 0 - пул фиксированного размера http_threads_count
+        int         http_threads_idle_timeout;          // в миллисекундах
         int         http_queue_capacity;
+        std::string http_server_mode;
+        int         http_reactors_count;
+        int         http_pipeline_max_depth;
+        int         http_keep_alive_max_count;
+        int         http_keep_alive_timeout;        // в секундах
+        int         http_max_connections_per_ip;
+        int         http_compression_min_size;      // в байтах, 0 - ответы не сжимаются
+        int         http_search_cache_ttl;          // в миллисекундах, 0 - кэш отключен
+        int         http_queue_target_delay;        // в миллисекундах, 0 - запросы не отбрасываются
+        int         http_queue_interval;            // в миллисекундах
+        int         http_cpu_threads_count;
+        int         http_cpu_queue_capacity;
+        int         http_cpu_queue_target_delay;        // в миллисекундах, 0 - запросы не отбрасываются
+        int         http_cpu_queue_interval;            // в миллисекундах
+        int         http_bcrypt_threads_count;          // 0 - по доступным ядрам (квота cgroup)
+        int         http_db_threads_count;              // 0 - запросы к БД в потоке обработчика
+        int         http_credential_cache_ttl;          // в миллисекундах, 0 - кэш отключен
+        std::string http_threads_affinity;              // none, compact, spread или список ядер "0-3,8"
+        std::string http_reactors_affinity;
+        std::string http_bcrypt_affinity;
 
         std::string prometheus_listening;
         int         prometheus_port;
 
+        int         workers_count;
+        int         worker_id;     // номер процесса-обработчика, -1 - процесс запущен не супервизором
+
         std::unordered_map<std::string, std::string> logging_config;
 
         void init();
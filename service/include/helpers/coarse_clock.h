@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace SocialNetwork {
+
+namespace TimeHelpers {
+
+//
+// общие для процесса часы с заранее отформатированными метками времени.
+//
+// метки пересчитываются не чаще одного раза за тик CLOCK_REALTIME_COARSE
+// (1-4 мс, в зависимости от CONFIG_HZ ядра): первый поток, заметивший новый
+// тик, форматирует метки в следующий буфер кольца и публикует его, остальные
+// в это время читают предыдущий буфер. дата и время перевычисляются раз в
+// секунду, на каждом тике обновляются только миллисекунды.
+//
+// метки возвращаются в std::array по значению, поэтому чтение не выделяет
+// память и не зависит от того, что буфер позже будет перезаписан
+//
+class CoarseClock
+{
+public:
+    static constexpr size_t http_date_length  = 29;  // Sat, 01 Jan 2005 11:00:00 GMT
+    static constexpr size_t local_time_length = 26;  // 08/Apr/2025:12:06:54 +0000
+    static constexpr size_t log_time_length   = 23;  // 2025-04-08 12:06:54.123
+
+    template <size_t N>
+    struct Stamp : std::array<char, N> {
+        std::string_view view() const noexcept { return {this->data(), N}; }
+    };
+
+    using HttpDate  = Stamp<http_date_length>;
+    using LocalTime = Stamp<local_time_length>;
+    using LogTime   = Stamp<log_time_length>;
+
+    CoarseClock() = delete;
+
+    // RFC 7231 IMF-fixdate (UTC) для заголовка Date
+    static HttpDate http_date();
+
+    // локальное время в формате $time_local журнала NGINX
+    static LocalTime local_time();
+
+    // UTC с миллисекундами для строк журнала
+    static LogTime log_time();
+};
+
+} // namespace TimeHelpers
+
+} // namespace SocialNetwork
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace SocialNetwork {
+
+namespace ThreadHelpers {
+
+//
+// отбор задач по времени ожидания в очереди пула потоков (CoDel, RFC 8289).
+//
+// очередь считается перегруженной, если задачи непрерывно ждут дольше 'target'
+// в течение 'interval'. тогда часть задач отбрасывается, и пока задержка не
+// опустится ниже 'target', отбрасывается все чаще: следующая через
+// interval / sqrt(count). короткие всплески, которые очередь успевает
+// рассосать за 'interval', задач не теряют.
+//
+// в отличие от лимита длины очереди, отбрасываются запросы, которые еще
+// можно обслужить вовремя, а не те, клиенты которых уже ушли по таймауту
+//
+class CoDel
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    CoDel() = delete;
+    CoDel(const CoDel&) = delete;
+    CoDel& operator=(const CoDel&) = delete;
+
+    // 'target' равный нулю - задачи не отбрасываются
+    CoDel(std::chrono::milliseconds target, std::chrono::milliseconds interval)
+    :   target_(target),
+        interval_(interval) {}
+
+    // задача, поставленная в очередь в 'queued', извлечена из нее в 'now'.
+    // true - задачу нужно отбросить
+    bool should_drop(clock_t::time_point queued, clock_t::time_point now);
+
+    // значение для заголовка Retry-After отброшенному запросу, в секундах
+    int retry_after_sec() const noexcept;
+
+private:
+    const clock_t::duration target_;
+    const clock_t::duration interval_;
+
+    std::mutex          mutex_{};
+    clock_t::time_point first_above_{};     // когда задержка стала выше target_, плюс interval_
+    clock_t::time_point drop_next_{};
+    uint32_t            count_{0};          // отброшено с начала текущего периода перегрузки
+    uint32_t            last_count_{0};
+    bool                dropping_{false};
+
+    bool above_target_(clock_t::duration sojourn, clock_t::time_point now);
+    clock_t::time_point control_law_(clock_t::time_point t) const;
+};
+
+} // namespace ThreadHelpers
+
+} // namespace SocialNetwork
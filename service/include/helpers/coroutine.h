@@ -0,0 +1,412 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include "helpers/task_future.h"
+#include "helpers/thread_pool.h"
+#include "helpers/timer_queue.h"
+
+namespace SocialNetwork {
+
+namespace ThreadHelpers {
+
+//
+// сопрограммы C++20 поверх ThreadPool.
+//
+// у каждой сопрограммы есть исполнитель - пул, в котором она продолжается
+// после ожидания (co_await): пока ответа ждут, поток пула свободен для других
+// задач, а продолжение ставится задачей в очередь исполнителя. если очередь
+// исполнителя заполнена, сопрограмма продолжается сразу в потоке, который
+// завершил ожидание.
+// без исполнителя (sync_wait) ожидания блокируют вызывающий поток, как
+// обычный синхронный код, поэтому одни и те же сопрограммы работают и там,
+// где потоку некуда переключиться
+//
+
+template<typename T>
+class Task;
+
+// продолжает 'handle' задачей в пуле 'executor', сразу - если пула нет или он отказал
+inline void resume_in_(ThreadPool* executor, std::coroutine_handle<> handle)
+{
+    if (executor == nullptr
+    ||  !executor->add_task(nullptr, [handle]() { handle.resume(); })) handle.resume();
+}
+
+// общая часть обещаний (promise_type) сопрограмм: исполнитель
+struct CoroutinePromise {
+    ThreadPool* executor{nullptr};
+};
+
+template<typename T>
+class TaskPromise;
+
+template<typename T>
+class TaskPromiseBase : public CoroutinePromise
+{
+public:
+    using value_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    // Task ленивая: тело начинает выполняться при co_await
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // по завершении управление сразу передается ожидающей сопрограмме
+    // (симметричная передача), без задачи в пуле и без роста стека
+    struct final_awaiter {
+        bool await_ready() noexcept { return false; }
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            if (auto continuation = handle.promise().continuation) return continuation;
+            return std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+    final_awaiter final_suspend() noexcept { return {}; }
+
+    Task<T> get_return_object() noexcept;
+    void unhandled_exception() noexcept { result_.template emplace<2>(std::current_exception()); }
+
+    T result() {
+        if (result_.index() == 2) std::rethrow_exception(std::get<2>(result_));
+        if constexpr (!std::is_void_v<T>) return std::move(std::get<1>(result_));
+    }
+
+    std::coroutine_handle<> continuation{};
+
+protected:
+    std::variant<std::monostate, value_t, std::exception_ptr> result_{};
+};
+
+template<typename T>
+class TaskPromise : public TaskPromiseBase<T>
+{
+public:
+    template<typename V>
+    void return_value(V&& value) { this->result_.template emplace<1>(std::forward<V>(value)); }
+};
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase<void>
+{
+public:
+    void return_void() noexcept { result_.emplace<1>(); }
+};
+
+//
+// результат сопрограммы: значение T или исключение, которое co_await
+// передает дальше. одноразовая и ленивая: тело выполняется, только когда
+// результат ждут (co_await), в исполнителе ждущей сопрограммы
+//
+template<typename T = void>
+class [[nodiscard]] Task
+{
+public:
+    using promise_type = TaskPromise<T>;
+
+    Task() = delete;
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task(Task&& other) noexcept
+    :   handle_(std::exchange(other.handle_, nullptr)) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ~Task() { if (handle_) handle_.destroy(); }
+
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept
+    :   handle_(handle) {}
+
+    struct awaiter {
+        std::coroutine_handle<promise_type> handle;
+
+        bool await_ready() noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> parent) noexcept {
+            handle.promise().continuation = parent;
+            handle.promise().executor     = parent.promise().executor;
+            return handle;
+        }
+
+        T await_resume() { return handle.promise().result(); }
+    };
+
+    awaiter operator co_await() && noexcept { return awaiter{handle_}; }
+
+private:
+    std::coroutine_handle<promise_type> handle_{};
+};
+
+template<typename T>
+Task<T> TaskPromiseBase<T>::get_return_object() noexcept
+{
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(static_cast<TaskPromise<T>&>(*this)));
+}
+
+// корневая сопрограмма spawn() и sync_wait(): начинает выполняться сразу и
+// освобождает себя по завершении
+struct DetachedTask {
+    struct promise_type : CoroutinePromise {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// меняет исполнителя сопрограммы без приостановки
+struct set_executor_ {
+    ThreadPool* executor{nullptr};
+
+    bool await_ready() noexcept { return false; }
+    template<typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        handle.promise().executor = executor;
+        return false;
+    }
+    void await_resume() noexcept {}
+};
+
+// исполнитель сопрограммы без приостановки
+struct get_executor_ {
+    ThreadPool* executor{nullptr};
+
+    bool await_ready() noexcept { return false; }
+    template<typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        executor = handle.promise().executor;
+        return false;
+    }
+    ThreadPool* await_resume() noexcept { return executor; }
+};
+
+//
+// ожидание TaskFuture: co_await std::move(future) возвращает значение задачи
+// или передает ее исключение
+//
+template<typename T>
+class FutureAwaiter
+{
+public:
+    explicit FutureAwaiter(std::shared_ptr<TaskState<T>> state)
+    :   state_(std::move(state)) {}
+
+    bool await_ready() noexcept { return state_->is_ready(); }
+
+    template<typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> handle) {
+        auto* executor = handle.promise().executor;
+        if (executor == nullptr) {
+            state_->wait();
+            return false;
+        }
+        // продолжение может выполниться и освободить кадр сопрограммы раньше,
+        // чем on_ready вернется: после него к членам ожидания не обращаемся
+        auto state = state_;
+        state->on_ready(PooledTask(nullptr, [executor, handle]() { resume_in_(executor, handle); }));
+        return true;
+    }
+
+    T await_resume() {
+        if (auto error = state_->take_error()) std::rethrow_exception(std::move(error));
+        if constexpr (!std::is_void_v<T>) return state_->take_value();
+    }
+
+private:
+    std::shared_ptr<TaskState<T>> state_{nullptr};
+};
+
+template<typename T>
+FutureAwaiter<T> operator co_await(TaskFuture<T>&& future)
+{
+    return FutureAwaiter<T>(std::move(future).release_state());
+}
+
+//
+// ожидание TaskFuture не дольше 'at': nullopt, если результат не готов к сроку.
+// задача при этом продолжает выполняться, ее результат отбрасывается.
+// таймер - в общей TimerQueue и снимается, если результат пришел раньше
+//
+template<typename T>
+class DeadlineAwaiter
+{
+public:
+    using value_t = typename TaskState<T>::value_t;
+
+    DeadlineAwaiter(std::shared_ptr<TaskState<T>> state, TimerQueue::clock_t::time_point at)
+    :   state_(std::move(state)), at_(at) {}
+
+    bool await_ready() noexcept { return state_->is_ready(); }
+
+    template<typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> handle) {
+        auto* executor = handle.promise().executor;
+        if (executor == nullptr) {
+            timed_out_ = !state_->wait_until(at_);
+            return false;
+        }
+
+        auto race  = std::make_shared<race_s>();
+        auto state = state_;
+        race_ = race;
+        if (at_ != TimerQueue::clock_t::time_point::max()) {
+            race->timer = TimerQueue::shared().add(at_, PooledTask(nullptr, [race, executor, handle]() {
+                if (race->done.exchange(true, std::memory_order_acq_rel)) return;
+                race->timed_out = true;
+                resume_in_(executor, handle);
+            }));
+        }
+        // таймер мог уже сработать и продолжить сопрограмму: дальше только локальные переменные
+        state->on_ready(PooledTask(nullptr, [race, executor, handle]() {
+            if (race->done.exchange(true, std::memory_order_acq_rel)) return;
+            TimerQueue::shared().cancel(race->timer);
+            resume_in_(executor, handle);
+        }));
+        return true;
+    }
+
+    std::optional<value_t> await_resume() {
+        if (timed_out_ || (race_ && race_->timed_out)) return std::nullopt;
+        if (auto error = state_->take_error()) std::rethrow_exception(std::move(error));
+        return state_->take_value();
+    }
+
+private:
+    // продолжает тот, кто первым выставит 'done': таймер или результат
+    struct race_s {
+        std::atomic<bool> done{false};
+        bool              timed_out{false};
+        TimerQueue::Timer timer{};
+    };
+
+    std::shared_ptr<TaskState<T>>   state_{nullptr};
+    TimerQueue::clock_t::time_point at_{};
+    bool                            timed_out_{false};
+    std::shared_ptr<race_s>         race_{nullptr};
+};
+
+template<typename T>
+DeadlineAwaiter<T> with_deadline(TaskFuture<T> future, TimerQueue::clock_t::time_point at)
+{
+    return DeadlineAwaiter<T>(std::move(future).release_state(), at);
+}
+
+// приостановка до 'at' в TimerQueue, без исполнителя - sleep_until в вызывающем потоке
+class SleepAwaiter
+{
+public:
+    explicit SleepAwaiter(TimerQueue::clock_t::time_point at)
+    :   at_(at) {}
+
+    bool await_ready() noexcept { return TimerQueue::clock_t::now() >= at_; }
+
+    template<typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> handle) {
+        auto* executor = handle.promise().executor;
+        if (executor == nullptr) {
+            std::this_thread::sleep_until(at_);
+            return false;
+        }
+        TimerQueue::shared().add(at_, PooledTask(nullptr, [executor, handle]() { resume_in_(executor, handle); }));
+        return true;
+    }
+
+    void await_resume() noexcept {}
+
+private:
+    TimerQueue::clock_t::time_point at_{};
+};
+
+inline SleepAwaiter sleep_until(TimerQueue::clock_t::time_point at)
+{
+    return SleepAwaiter(at);
+}
+
+template<typename Rep, typename Period>
+SleepAwaiter sleep_for(std::chrono::duration<Rep, Period> duration)
+{
+    return SleepAwaiter(TimerQueue::clock_t::now() + std::chrono::duration_cast<TimerQueue::clock_t::duration>(duration));
+}
+
+//
+// выполняет блокирующий вызов 'func' (запрос к БД через синхронный клиент)
+// задачей в пуле 'pool', а сопрограмма на это время освобождает поток своего
+// исполнителя. без пула или без исполнителя (sync_wait) 'func' выполняется
+// сразу в текущем потоке. task_refused - очередь 'pool' заполнена
+//
+template<typename Func>
+auto run_in(ThreadPool* pool, Func func) -> Task<std::invoke_result_t<Func&>>
+{
+    auto* executor = co_await get_executor_{};
+    if (pool == nullptr || executor == nullptr) co_return func();
+    co_return co_await pool->submit(std::move(func));
+}
+
+//
+// запускает 'task' в пуле 'executor' (по умолчанию - пул текущего потока):
+// тело выполняется сразу в текущем потоке до первого ожидания. 'done'
+// вызывается один раз по завершении, с исключением задачи или nullptr
+//
+template<typename OnDone>
+void spawn(Task<void> task, OnDone done, ThreadPool* executor = ThreadPool::current())
+{
+    [](Task<void> task, OnDone done, ThreadPool* executor) -> DetachedTask {
+        co_await set_executor_{executor};
+        std::exception_ptr error{};
+        try {
+            co_await std::move(task);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        done(std::move(error));
+    }(std::move(task), std::move(done), executor);
+}
+
+// выполняет 'task' без исполнителя и ждет результат в текущем потоке
+template<typename T>
+T sync_wait(Task<T> task)
+{
+    auto state = std::make_shared<TaskState<T>>();
+    [](Task<T> task, std::shared_ptr<TaskState<T>> state) -> DetachedTask {
+        std::exception_ptr error{};
+        std::optional<typename TaskState<T>::value_t> value{};
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await std::move(task);
+                value.emplace();
+            } else {
+                value.emplace(co_await std::move(task));
+            }
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        if (error) state->set_exception(std::move(error));
+        else state->set_value(std::move(*value));
+    }(std::move(task), state);
+
+    state->wait();
+    if (auto error = state->take_error()) std::rethrow_exception(std::move(error));
+    if constexpr (!std::is_void_v<T>) return state->take_value();
+}
+
+} // namespace ThreadHelpers
+
+} // namespace SocialNetwork
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <pthread.h>
+
+namespace SocialNetwork {
+
+namespace ThreadHelpers {
+
+// логическое ядро (аппаратный поток) процессора
+struct Cpu {
+    unsigned id{0};         // номер ядра для sched_setaffinity
+    unsigned core{0};       // физическое ядро внутри сокета (core_id)
+    unsigned package{0};    // сокет (physical_package_id)
+    unsigned node{0};       // узел NUMA
+};
+
+// как потоки одной группы (пула, reactor-потоков) закрепляются за ядрами:
+//  None    - не закрепляются, ядро выбирает планировщик
+//  Compact - подряд: аппаратные потоки одного физического ядра, затем соседние
+//            ядра того же узла NUMA, затем следующий узел. потоки группы делят
+//            кэш и память одного сокета, общие данные не ходят между сокетами
+//  Spread  - по очереди по узлам NUMA, внутри узла сначала разные физические ядра.
+//            больше кэша и пропускной способности памяти на поток
+//  List    - явный список ядер: поток N группы закрепляется за ядром N % размер списка
+enum class Pinning : uint8_t {
+    None,
+    Compact,
+    Spread,
+    List
+};
+
+struct Affinity {
+    Pinning               pinning{Pinning::None};
+    std::vector<unsigned> cpus{};       // Pinning::List
+
+    // "none", "compact", "spread" или список ядер "0-3,8,10-11";
+    // nullopt - строка не разобрана
+    static std::optional<Affinity> parse(std::string_view str);
+};
+
+// список ядер или узлов в формате sysfs и cpuset: "0-3,8,10-11"
+std::optional<std::vector<unsigned>> parse_cpu_list(std::string_view str);
+
+//
+// ядра, доступные процессу, с физическими ядрами, сокетами и узлами NUMA.
+// маска ядер - sched_getaffinity (в контейнере ее ограничивает cpuset),
+// строение - /sys/devices/system/cpu/cpu<N>/topology и /sys/devices/system/node.
+// без sysfs все ядра считаются отдельными физическими ядрами одного узла
+//
+class CpuTopology
+{
+public:
+    explicit CpuTopology(std::vector<Cpu> cpus);
+
+    // определяется один раз при первом обращении
+    static const CpuTopology& system();
+
+    const std::vector<Cpu>& cpus() const noexcept { return cpus_; }
+    const std::vector<unsigned>& nodes() const noexcept { return nodes_; }
+
+    // nullopt - ядро недоступно процессу
+    std::optional<unsigned> node_of(unsigned cpu) const noexcept;
+
+    // часть ядер для процесса-обработчика 'index' из 'count' (режим супервизора):
+    // ядра в порядке Compact делятся на непрерывные части, чтобы закрепленные
+    // потоки разных процессов не делили одни и те же ядра
+    CpuTopology slice(size_t index, size_t count) const;
+
+    // ядра для потоков группы по их порядковому номеру (поток N - ядро N % размер),
+    // пустой - потоки не закрепляются. ядра списка Pinning::List, недоступные
+    // процессу, пропускаются
+    std::vector<unsigned> placement(const Affinity& affinity) const;
+
+    // узлы NUMA ядер 'cpus' по возрастанию
+    std::vector<unsigned> nodes_of(const std::vector<unsigned>& cpus) const;
+
+private:
+    std::vector<Cpu>      cpus_{};        // по возрастанию id
+    std::vector<unsigned> nodes_{};
+    std::vector<unsigned> compact_{};
+    std::vector<unsigned> spread_{};
+};
+
+// закрепляет поток за ядром 'cpu', false - ядро недоступно или ошибка
+bool pin_thread(pthread_t th, unsigned cpu);
+
+// ядро, на котором выполняется текущий поток (sched_getcpu через vDSO, без
+// системного вызова), -1 - неизвестно
+int current_cpu() noexcept;
+
+// память на узле NUMA 'node' (mbind(2) с MPOL_PREFERRED): если на узле нет
+// свободных страниц, ядро выделит их на другом. без поддержки NUMA в ядре, или
+// если mbind запрещен (seccomp контейнера без CAP_SYS_NICE), память выделяется
+// как обычно - на узле потока, первым обратившегося к странице.
+// allocate_on_node выделяет целые страницы через mmap, исключение - std::bad_alloc
+void* allocate_on_node(size_t bytes, unsigned node);
+void  deallocate_on_node(void* ptr, size_t bytes) noexcept;
+// переносит целые страницы уже выделенной памяти на узел 'node', false - не удалось
+bool  bind_to_node(void* ptr, size_t bytes, unsigned node) noexcept;
+
+} // namespace ThreadHelpers
+
+} // namespace SocialNetwork
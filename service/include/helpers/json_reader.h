@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include "helpers/json_writer.h"
+
+namespace SocialNetwork {
+
+namespace JsonHelpers {
+
+//
+// разбор тела запроса - JSON-объекта со строковыми полями - за один проход
+// и без построения DOM. известные поля попадают в std::string_view структуры,
+// неизвестные пропускаются. по пути проверяются синтаксис, типы, длины полей
+// (в символах, как VARCHAR(n) в PostgreSQL) и корректность UTF-8.
+//
+// строки без escape-последовательностей указывают прямо в тело запроса,
+// остальные раскодируются в буфер 'scratch' (память под него выделяется
+// только если такие строки встретились). и тело, и 'scratch' должны жить
+// дольше структуры.
+//
+// описание структуры - специализация JsonHelpers::Schema:
+//
+//      struct login_s { std::string_view id; std::string_view password; };
+//      template <> struct JsonHelpers::Schema<login_s> {
+//          using type = std::tuple<JsonHelpers::Input<"id",       &login_s::id, {.max_length = 36}>,
+//                                  JsonHelpers::Input<"password", &login_s::password>>;
+//      };
+//      login_s login;
+//      std::string scratch;
+//      if (auto result = JsonHelpers::read_object(req.body, login, scratch); !result) { ... result.message() ... }
+//
+
+// ограничения строкового поля
+struct Limits
+{
+    size_t min_length{0};   // в символах (кодовых точках Unicode)
+    size_t max_length{0};   // 0 - без ограничения
+    bool   required{true};
+};
+
+template <FieldName Name, auto Member, Limits Limit = Limits{}>
+struct Input
+{
+    static constexpr std::string_view name{Name.data, Name.size()};
+    static constexpr auto             member = Member;
+    static constexpr Limits           limits = Limit;
+};
+
+// специализируется для каждой структуры запроса
+template <typename T>
+struct Schema;
+
+template <typename T>
+concept Readable = requires { typename Schema<T>::type; };
+
+enum class ReadError : uint8_t {
+    NONE,
+    SYNTAX,         // некорректный JSON
+    NOT_OBJECT,     // тело - не JSON-объект
+    NOT_STRING,     // значение известного поля - не строка
+    BAD_UTF8,       // строка - некорректный UTF-8
+    DUPLICATE,      // поле указано дважды
+    MISSING,        // нет обязательного поля
+    TOO_SHORT,
+    TOO_LONG,
+    TOO_DEEP        // слишком глубокая вложенность у пропускаемого значения
+};
+
+struct ReadResult
+{
+    ReadError        error{ReadError::NONE};
+    std::string_view field{};   // поле, к которому относится ошибка
+    size_t           offset{0}; // позиция ошибки в теле
+
+    explicit operator bool() const noexcept { return error == ReadError::NONE; }
+    std::string message() const;
+};
+
+//
+// низкоуровневый потоковый разборщик, используется из read_object()
+//
+class Reader
+{
+public:
+    Reader(std::string_view json, std::string& scratch) noexcept
+    :   json_(json),
+        scratch_(scratch) {}
+
+    // '{'
+    bool begin_object() noexcept;
+    // следующий ключ объекта, false - объект закончился, либо ошибка (см. error())
+    bool next_key(std::string_view& key) noexcept;
+    // строковое значение поля 'field' и его длина в символах
+    bool read_string(std::string_view field, std::string_view& value, size_t& length) noexcept;
+    // пропускает значение любого типа
+    bool skip_value() noexcept;
+    // после объекта - только пробельные символы
+    bool finish() noexcept;
+
+    const ReadResult& error() const noexcept { return error_; }
+    // запоминает первую ошибку, всегда возвращает false
+    bool fail(ReadError error, std::string_view field = {}) noexcept;
+
+private:
+    std::string_view json_{};
+    std::string&     scratch_;
+    size_t           pos_{0};
+    bool             first_key_{true};
+    bool             scratch_reserved_{false};
+    ReadResult       error_{};
+
+    void skip_ws_() noexcept;
+    bool expect_(char ch) noexcept;
+    bool key_(std::string_view& key) noexcept;
+    bool string_(std::string_view field, std::string_view& value, size_t& length) noexcept;
+    bool escape_(std::string_view field) noexcept;
+    bool utf8_(std::string_view field) noexcept;
+    bool literal_(std::string_view word) noexcept;
+    bool number_() noexcept;
+};
+
+template <typename F, typename T>
+bool read_field(Reader& reader, T& out, std::string_view key, bool& found, bool& handled)
+{
+    if (handled || key != F::name) return true;
+    handled = true;
+
+    if (found) return reader.fail(ReadError::DUPLICATE, F::name);
+    found = true;
+
+    size_t length = 0;
+    if (!reader.read_string(F::name, out.*F::member, length)) return false;
+    if (length < F::limits.min_length) return reader.fail(ReadError::TOO_SHORT, F::name);
+    if (F::limits.max_length && length > F::limits.max_length) return reader.fail(ReadError::TOO_LONG, F::name);
+    return true;
+}
+
+template <typename F>
+void check_required(bool found, ReadResult& result)
+{
+    if (result.error == ReadError::NONE && F::limits.required && !found) {
+        result = ReadResult{ReadError::MISSING, F::name, 0};
+    }
+}
+
+// заполняет 'out' из JSON-объекта 'json'
+template <Readable T>
+ReadResult read_object(std::string_view json, T& out, std::string& scratch)
+{
+    using Fields = typename Schema<T>::type;
+    constexpr size_t count = std::tuple_size_v<Fields>;
+
+    Reader reader(json, scratch);
+    if (!reader.begin_object()) return reader.error();
+
+    bool found[count]{};
+    std::string_view key;
+    while (reader.next_key(key)) {
+        bool handled = false;
+        bool ok = [&]<size_t... I>(std::index_sequence<I...>) {
+            return (read_field<std::tuple_element_t<I, Fields>>(reader, out, key, found[I], handled) && ...);
+        }(std::make_index_sequence<count>{});
+        if (!ok) return reader.error();
+        if (!handled && !reader.skip_value()) return reader.error();
+    }
+    if (!reader.finish()) return reader.error();
+
+    ReadResult result;
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        (check_required<std::tuple_element_t<I, Fields>>(found[I], result), ...);
+    }(std::make_index_sequence<count>{});
+    return result;
+}
+
+} // namespace JsonHelpers
+
+} // namespace SocialNetwork
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <concepts>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace SocialNetwork {
+
+namespace JsonHelpers {
+
+//
+// сериализация структур в JSON без промежуточного DOM: значения (обычно
+// std::string_view, указывающие прямо в pqxx::result) пишутся с экранированием
+// в один выходной буфер, а ключи вместе с кавычками и двоеточием собираются
+// на этапе компиляции.
+//
+// описание структуры - специализация JsonHelpers::Fields:
+//
+//      struct user_s { std::string_view id; std::optional<std::string_view> city; };
+//      template <> struct JsonHelpers::Fields<user_s> {
+//          using type = std::tuple<JsonHelpers::Field<"id",   &user_s::id>,
+//                                  JsonHelpers::Field<"city", &user_s::city>>;
+//      };
+//      std::string body = JsonHelpers::to_json(user);
+//
+
+// дописывает строку в кавычках, экранируя '"', '\' и управляющие символы.
+// UTF-8 последовательности копируются как есть
+void escape_string(std::string& out, std::string_view s);
+
+template <size_t N>
+struct FieldName
+{
+    char data[N]{};
+
+    constexpr FieldName(const char (&s)[N]) { std::copy_n(s, N, data); }
+    constexpr size_t size() const noexcept { return N - 1; }
+};
+
+template <FieldName Name, auto Member>
+struct Field
+{
+    static constexpr auto member = Member;
+
+    // "name": - готовый к копированию ключ
+    static constexpr auto key = [] {
+        std::array<char, Name.size() + 3> k{};
+        k[0] = '"';
+        for (size_t i = 0; i < Name.size(); ++i) {
+            k[i + 1] = Name.data[i];
+        }
+        k[Name.size() + 1] = '"';
+        k[Name.size() + 2] = ':';
+        return k;
+    }();
+
+    static_assert(std::none_of(Name.data, Name.data + Name.size(),
+                               [](char ch) { return ch == '"' || ch == '\\' || static_cast<unsigned char>(ch) < 0x20; }),
+                  "JSON field name should not require escaping");
+};
+
+// специализируется для каждой сериализуемой структуры
+template <typename T>
+struct Fields;
+
+template <typename T>
+concept Described = requires { typename Fields<T>::type; };
+
+// объявления всех перегрузок до определений шаблонов, чтобы
+// вложенные значения находили друг друга при инстанцировании
+inline void write_value(std::string& out, std::string_view v);
+inline void write_value(std::string& out, const std::string& v);
+inline void write_value(std::string& out, const char* v);
+inline void write_value(std::string& out, bool v);
+inline void write_value(std::string& out, std::nullptr_t);
+template <std::integral T>
+    requires (!std::same_as<T, bool>)
+void write_value(std::string& out, T v);
+template <std::floating_point T>
+void write_value(std::string& out, T v);
+template <typename T>
+void write_value(std::string& out, const std::optional<T>& v);
+template <typename T>
+void write_value(std::string& out, std::span<const T> v);
+template <typename T>
+void write_value(std::string& out, const std::vector<T>& v);
+template <Described T>
+void write_value(std::string& out, const T& obj);
+
+inline void write_value(std::string& out, std::string_view v)  { escape_string(out, v); }
+inline void write_value(std::string& out, const std::string& v) { escape_string(out, v); }
+inline void write_value(std::string& out, const char* v)        { escape_string(out, v); }
+inline void write_value(std::string& out, bool v)               { out.append(v ? "true" : "false"); }
+inline void write_value(std::string& out, std::nullptr_t)       { out.append("null"); }
+
+template <std::integral T>
+    requires (!std::same_as<T, bool>)
+void write_value(std::string& out, T v)
+{
+    char buf[24];
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, end);
+}
+
+template <std::floating_point T>
+void write_value(std::string& out, T v)
+{
+    char buf[32];
+    auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, end);
+}
+
+template <typename T>
+void write_value(std::string& out, const std::optional<T>& v)
+{
+    if (v) write_value(out, *v);
+    else   out.append("null");
+}
+
+template <typename T>
+void write_value(std::string& out, std::span<const T> v)
+{
+    out.push_back('[');
+    for (size_t i = 0; i < v.size(); ++i) {
+        if (i) out.push_back(',');
+        write_value(out, v[i]);
+    }
+    out.push_back(']');
+}
+
+template <typename T>
+void write_value(std::string& out, const std::vector<T>& v)
+{
+    write_value(out, std::span<const T>(v));
+}
+
+template <typename F, typename T>
+void write_field(std::string& out, const T& obj, bool& first)
+{
+    if (!first) out.push_back(',');
+    first = false;
+    out.append(F::key.data(), F::key.size());
+    write_value(out, obj.*F::member);
+}
+
+template <Described T>
+void write_value(std::string& out, const T& obj)
+{
+    out.push_back('{');
+    bool first = true;
+    [&]<typename... F>(std::tuple<F...>*) {
+        (write_field<F>(out, obj, first), ...);
+    }(static_cast<typename Fields<T>::type*>(nullptr));
+    out.push_back('}');
+}
+
+// сериализует значение в новую строку, 'reserve' - ожидаемый размер результата
+template <typename T>
+std::string to_json(const T& v, size_t reserve = 256)
+{
+    std::string out;
+    out.reserve(reserve);
+    write_value(out, v);
+    return out;
+}
+
+} // namespace JsonHelpers
+
+} // namespace SocialNetwork
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+namespace SocialNetwork {
+
+namespace ThreadHelpers {
+
+//
+// ограниченная очередь без блокировок для нескольких производителей и
+// потребителей (Dmitry Vyukov, "Bounded MPMC queue").
+//
+// позиция 'pos' попадает в ячейку pos % capacity на круге turn = pos / capacity.
+// каждая ячейка хранит номер последовательности: 2 * turn - ячейка свободна для
+// записи на этом круге, 2 * turn + 1 - заполнена и ждет чтения. позиции
+// захватываются одним CAS, после чего ячейка заполняется или освобождается без
+// гонок с другими потоками, поэтому производители и потребители не ждут друг
+// друга на общем мьютексе.
+//
+// емкость любая, в том числе 1 (номер круга, а не позиция, в отличие от
+// исходного алгоритма), и соблюдается точно: try_push() в заполненную очередь
+// возвращает false, try_pop() из пустой - nullopt
+//
+template <typename T>
+class MpmcQueue
+{
+public:
+    MpmcQueue() = delete;
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    explicit MpmcQueue(size_t capacity)
+    :   capacity_(capacity > 0 ? capacity : 1),
+        cells_(std::make_unique<cell_s[]>(capacity_)) {}
+
+    ~MpmcQueue() {
+        while (try_pop()) {}
+    }
+
+    size_t capacity() const noexcept { return capacity_; }
+
+    // память ячеек: для переноса на узел NUMA потоков очереди (bind_to_node)
+    void* storage() noexcept { return cells_.get(); }
+    size_t storage_bytes() const noexcept { return capacity_ * sizeof(cell_s); }
+
+    // приблизительный размер: при одновременных push/pop может быть неточным
+    size_t size() const noexcept {
+        const auto tail = enqueue_pos_.load(std::memory_order_relaxed);
+        const auto head = dequeue_pos_.load(std::memory_order_relaxed);
+        return tail > head ? static_cast<size_t>(tail - head) : 0;
+    }
+
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+        cell_s* cell = nullptr;
+        auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos % capacity_];
+            const auto seq = cell->sequence.load(std::memory_order_acquire);
+            const auto dif = static_cast<int64_t>(seq - 2 * (pos / capacity_));
+            if (dif == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return false;   // очередь заполнена
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        ::new (static_cast<void*>(cell->storage)) T(std::forward<Args>(args)...);
+        cell->sequence.store(2 * (pos / capacity_) + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+    // добавляет до 'count' элементов подряд одним CAS: захватываются свободные
+    // ячейки, идущие подряд от текущей позиции, и в i-й из них создается T(make(i)).
+    // возвращает сколько добавлено, 0 - очередь заполнена; make() вызывается
+    // только для добавленных элементов
+    template <typename Make>
+    size_t try_emplace_bulk(size_t count, Make&& make) {
+        if (count == 0) return 0;
+        size_t claimed = 0;
+        auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            const auto dif = write_dif_(pos);
+            if (dif < 0) return 0;      // очередь заполнена
+            if (dif > 0) {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            claimed = 1;
+            while (claimed < count && write_dif_(pos + claimed) == 0) ++claimed;
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) break;
+        }
+        for (size_t i = 0; i < claimed; ++i) {
+            auto& cell = cells_[(pos + i) % capacity_];
+            ::new (static_cast<void*>(cell.storage)) T(make(i));
+            cell.sequence.store(2 * ((pos + i) / capacity_) + 1, std::memory_order_release);
+        }
+        return claimed;
+    }
+
+    std::optional<T> try_pop() {
+        cell_s* cell = nullptr;
+        auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos % capacity_];
+            const auto seq = cell->sequence.load(std::memory_order_acquire);
+            const auto dif = static_cast<int64_t>(seq - (2 * (pos / capacity_) + 1));
+            if (dif == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return std::nullopt;    // очередь пуста
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        T* item = std::launder(reinterpret_cast<T*>(cell->storage));
+        std::optional<T> value(std::move(*item));
+        item->~T();
+        // ячейка свободна для записи на следующем круге
+        cell->sequence.store(2 * (pos / capacity_ + 1), std::memory_order_release);
+        return value;
+    }
+
+    // извлекает до 'max' элементов подряд одним CAS и передает их в 'out'
+    // (перемещением), возвращает сколько извлечено, 0 - очередь пуста
+    template <typename Out>
+    size_t try_pop_bulk(size_t max, Out&& out) {
+        if (max == 0) return 0;
+        size_t claimed = 0;
+        auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            const auto dif = read_dif_(pos);
+            if (dif < 0) return 0;      // очередь пуста
+            if (dif > 0) {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            claimed = 1;
+            while (claimed < max && read_dif_(pos + claimed) == 0) ++claimed;
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed)) break;
+        }
+        for (size_t i = 0; i < claimed; ++i) {
+            auto& cell = cells_[(pos + i) % capacity_];
+            T* item = std::launder(reinterpret_cast<T*>(cell.storage));
+            out(std::move(*item));
+            item->~T();
+            cell.sequence.store(2 * ((pos + i) / capacity_ + 1), std::memory_order_release);
+        }
+        return claimed;
+    }
+
+private:
+    static constexpr size_t cache_line_size = 64;
+
+    struct cell_s {
+        std::atomic<uint64_t>    sequence{0};
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    const size_t                    capacity_;
+    const std::unique_ptr<cell_s[]> cells_;
+
+    // 0 - ячейка позиции 'pos' ждет записи (чтения) на круге этой позиции,
+    // меньше нуля - очередь заполнена (пуста), больше - позицию уже заняли
+    int64_t write_dif_(uint64_t pos) const noexcept {
+        const auto seq = cells_[pos % capacity_].sequence.load(std::memory_order_acquire);
+        return static_cast<int64_t>(seq - 2 * (pos / capacity_));
+    }
+    int64_t read_dif_(uint64_t pos) const noexcept {
+        const auto seq = cells_[pos % capacity_].sequence.load(std::memory_order_acquire);
+        return static_cast<int64_t>(seq - (2 * (pos / capacity_) + 1));
+    }
+
+    // позиции производителей и потребителей в разных строках кэша
+    alignas(cache_line_size) std::atomic<uint64_t> enqueue_pos_{0};
+    alignas(cache_line_size) std::atomic<uint64_t> dequeue_pos_{0};
+};
+
+} // namespace ThreadHelpers
+
+} // namespace SocialNetwork
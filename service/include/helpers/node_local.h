@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "helpers/cpu_topology.h"
+
+namespace SocialNetwork {
+
+namespace ThreadHelpers {
+
+//
+// по экземпляру T на каждый узел NUMA, local() возвращает экземпляр узла, на
+// котором выполняется поток. сам объект размещается в памяти своего узла
+// (allocate_on_node), а то, что он выделяет в куче, - там, где это делают
+// обращающиеся к нему потоки того же узла, поэтому данные и мьютексы объекта не
+// ходят между сокетами. подходит для кэшей: экземпляры узлов независимы, и
+// запись, вставленная на одном узле, на другом не видна.
+// без узлов (потоки не закреплены) - один экземпляр в обычной куче, local()
+// не обращается к sched_getcpu
+//
+template<typename T>
+class NodeLocal
+{
+public:
+    NodeLocal() = delete;
+    NodeLocal(const NodeLocal&) = delete;
+    NodeLocal& operator=(const NodeLocal&) = delete;
+
+    template<typename... Args>
+    NodeLocal(const CpuTopology& topology, const std::vector<unsigned>& nodes, const Args&... args) {
+        if (nodes.empty()) {
+            replicas_.push_back({new T(args...), std::nullopt});
+            return;
+        }
+        for (const auto node : nodes) {
+            void* memory = allocate_on_node(sizeof(T), node);
+            try {
+                replicas_.push_back({::new (memory) T(args...), node});
+            }
+            catch (...) {
+                deallocate_on_node(memory, sizeof(T));
+                throw;
+            }
+        }
+        if (replicas_.size() < 2) return;
+        // ядра узлов без своего экземпляра обращаются к первому
+        for (const auto& cpu : topology.cpus()) {
+            if (cpu.id >= by_cpu_.size()) by_cpu_.resize(cpu.id + 1, replicas_.front().object);
+            for (const auto& replica : replicas_) {
+                if (replica.node == cpu.node) by_cpu_[cpu.id] = replica.object;
+            }
+        }
+    }
+
+    ~NodeLocal() {
+        for (auto& replica : replicas_) {
+            if (!replica.node) {
+                delete replica.object;
+                continue;
+            }
+            replica.object->~T();
+            deallocate_on_node(replica.object, sizeof(T));
+        }
+    }
+
+    T& local() noexcept {
+        if (by_cpu_.empty()) return *replicas_.front().object;
+        const auto cpu = current_cpu();
+        return (cpu >= 0 && static_cast<size_t>(cpu) < by_cpu_.size()) ? *by_cpu_[cpu] : *replicas_.front().object;
+    }
+
+    size_t size() const noexcept { return replicas_.size(); }
+
+private:
+    struct replica_s {
+        T*                      object{nullptr};
+        std::optional<unsigned> node{};
+    };
+    std::vector<replica_s> replicas_{};
+    std::vector<T*>        by_cpu_{};     // по номеру ядра, пустой - экземпляр один
+};
+
+} // namespace ThreadHelpers
+
+} // namespace SocialNetwork
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace SocialNetwork {
+
+namespace ThreadHelpers {
+
+// результат задачи для обратного вызова add_task(): значение, либо nullopt, если
+// задача отклонена (очередь заполнена) или завершилась исключением.
+// у задачи без результата значение - std::monostate
+template<typename R>
+using TaskResult = std::optional<std::conditional_t<std::is_void_v<R>, std::monostate, R>>;
+
+//
+// задача пула: функция с аргументами и обратный вызов для результата.
+// перемещаемый объект без копирования: функция, аргументы и обратный вызов
+// хранятся во встроенном буфере 'inline_size' байт, если помещаются в него
+// и перемещаются без исключений, иначе в куче. вызов и разрушение - через
+// таблицу функций для конкретного типа, без std::function и std::any
+//
+class PooledTask
+{
+public:
+    static constexpr size_t inline_size = 64;
+
+    PooledTask() = delete;
+    PooledTask(const PooledTask&) = delete;
+    PooledTask& operator=(const PooledTask&) = delete;
+
+    PooledTask(PooledTask&& other) noexcept
+    :   ops_(std::exchange(other.ops_, nullptr)) {
+        if (ops_) ops_->move(storage_, other.storage_);
+    }
+
+    PooledTask& operator=(PooledTask&& other) noexcept {
+        if (this != &other) {
+            reset_();
+            ops_ = std::exchange(other.ops_, nullptr);
+            if (ops_) ops_->move(storage_, other.storage_);
+        }
+        return *this;
+    }
+
+    ~PooledTask() { reset_(); }
+
+    // 'cb' - nullptr, либо вызываемый объект, принимающий TaskResult<R>,
+    // где R - тип результата 'func'
+    template<typename OnComplete, typename Func, typename... Args>
+    PooledTask(OnComplete cb, Func func, Args&&... args) {
+        using bound_t = bound_s<std::decay_t<OnComplete>, std::decay_t<Func>, std::decay_t<Args>...>;
+        if constexpr (is_inline_<bound_t>) {
+            ::new (static_cast<void*>(storage_)) bound_t(std::move(cb), std::move(func), std::forward<Args>(args)...);
+            ops_ = &inline_ops_<bound_t>;
+        } else {
+            ::new (static_cast<void*>(storage_)) bound_t*(new bound_t(std::move(cb), std::move(func), std::forward<Args>(args)...));
+            ops_ = &heap_ops_<bound_t>;
+        }
+    }
+
+    // выполняет задачу и передает результат обратному вызову,
+    // исключение задачи передается дальше после вызова с nullopt
+    void operator() () { ops_->run(storage_); }
+
+    // задача отклонена: обратный вызов получает nullopt
+    void refuse() { ops_->refuse(storage_); }
+
+    // задача хранится во встроенном буфере
+    bool is_inline() const noexcept { return ops_ && ops_->is_inline; }
+
+private:
+    struct ops_s {
+        void (*run)(void*);
+        void (*refuse)(void*);
+        void (*move)(void* dst, void* src) noexcept;   // переносит и разрушает исходную
+        void (*destroy)(void*) noexcept;
+        bool is_inline;
+    };
+
+    // вместо nullptr: пустой тип не занимает места в bound_s
+    struct no_callback_s {
+        no_callback_s(std::nullptr_t) noexcept {}
+    };
+
+    template<typename Cb, typename Func, typename... Args>
+    struct bound_s {
+        using result_t = std::invoke_result_t<Func&, Args&...>;
+        using cb_t     = std::conditional_t<std::is_null_pointer_v<Cb>, no_callback_s, Cb>;
+
+        template<typename... A>
+        bound_s(Cb c, Func f, A&&... a)
+        :   cb(std::move(c)), func(std::move(f)), args(std::forward<A>(a)...) {}
+
+        [[no_unique_address]] cb_t  cb;
+        Func                        func;
+        std::tuple<Args...>         args;
+
+        bool has_callback() const {
+            if constexpr (std::is_same_v<cb_t, no_callback_s>) return false;
+            else if constexpr (std::is_constructible_v<bool, const cb_t&>) return static_cast<bool>(cb);
+            else return true;
+        }
+
+        void run() {
+            if (!has_callback()) {
+                std::apply(func, args);
+                return;
+            }
+            if constexpr (!std::is_same_v<cb_t, no_callback_s>) {
+                TaskResult<result_t> result{};
+                try {
+                    if constexpr (std::is_void_v<result_t>) {
+                        std::apply(func, args);
+                        result.emplace();
+                    } else {
+                        result.emplace(std::apply(func, args));
+                    }
+                }
+                catch (...) {
+                    cb(TaskResult<result_t>{});
+                    throw;
+                }
+                cb(std::move(result));
+            }
+        }
+
+        void refuse() {
+            if constexpr (!std::is_same_v<cb_t, no_callback_s>) {
+                if (has_callback()) cb(TaskResult<result_t>{});
+            }
+        }
+    };
+
+    template<typename T>
+    static constexpr bool is_inline_ = sizeof(T) <= inline_size
+                                    && alignof(T) <= alignof(std::max_align_t)
+                                    && std::is_nothrow_move_constructible_v<T>;
+
+    template<typename T>
+    static T* inline_(void* p) noexcept { return std::launder(static_cast<T*>(p)); }
+
+    template<typename T>
+    static T* heap_(void* p) noexcept { return *std::launder(static_cast<T**>(p)); }
+
+    template<typename T>
+    static constexpr ops_s inline_ops_{
+        [](void* p) { inline_<T>(p)->run(); },
+        [](void* p) { inline_<T>(p)->refuse(); },
+        [](void* dst, void* src) noexcept {
+            auto* from = inline_<T>(src);
+            ::new (dst) T(std::move(*from));
+            from->~T();
+        },
+        [](void* p) noexcept { inline_<T>(p)->~T(); },
+        true
+    };
+
+    template<typename T>
+    static constexpr ops_s heap_ops_{
+        [](void* p) { heap_<T>(p)->run(); },
+        [](void* p) { heap_<T>(p)->refuse(); },
+        [](void* dst, void* src) noexcept { ::new (dst) T*(heap_<T>(src)); },
+        [](void* p) noexcept { delete heap_<T>(p); },
+        false
+    };
+
+    void reset_() noexcept {
+        if (ops_) ops_->destroy(storage_);
+        ops_ = nullptr;
+    }
+
+    const ops_s*                                        ops_{nullptr};
+    alignas(std::max_align_t) unsigned char             storage_[inline_size];
+};
+
+} // namespace ThreadHelpers
+
+} // namespace SocialNetwork
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "helpers/pooled_task.h"
+#include "helpers/thread.h"
+
+namespace SocialNetwork {
+
+namespace ThreadHelpers {
+
+class ThreadPool;
+
+// очередь пула заполнена: задача submit() или продолжение then() не принято
+class task_refused : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+//
+// общее состояние TaskFuture: результат (значение или исключение), одно
+// продолжение и признак ожидающих потоков в одном атомарном слове, без мьютекса.
+// кто вторым из "результат" и "продолжение" выставит свой бит, тот и вызывает
+// продолжение; ожидающие спят на том же слове через futex
+//
+template<typename T>
+class TaskState
+{
+public:
+    using value_t = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    TaskState() = default;
+    TaskState(const TaskState&) = delete;
+    TaskState& operator=(const TaskState&) = delete;
+
+    void set_value(value_t value) {
+        value_.emplace(std::move(value));
+        publish_();
+    }
+
+    void set_exception(std::exception_ptr error) {
+        error_ = std::move(error);
+        publish_();
+    }
+
+    // выполняет 'func' с аргументами и сохраняет результат или исключение.
+    // исключение публикуется после выхода из catch, чтобы ожидающий поток
+    // стал его единственным владельцем
+    template<typename Func, typename... Args>
+    void fulfil(Func& func, Args&&... args) noexcept {
+        std::exception_ptr error{};
+        try {
+            if constexpr (std::is_void_v<T>) {
+                std::invoke(func, std::forward<Args>(args)...);
+                value_.emplace();
+            } else {
+                value_.emplace(std::invoke(func, std::forward<Args>(args)...));
+            }
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        if (error) set_exception(std::move(error));
+        else publish_();
+    }
+
+    bool is_ready() const noexcept { return flags_.load(std::memory_order_acquire) & has_result_; }
+
+    void wait() {
+        auto flags = flags_.load(std::memory_order_acquire);
+        while (!(flags & has_result_)) {
+            if (mark_waiting_(flags)) futex_wait(flags_, flags);
+            flags = flags_.load(std::memory_order_acquire);
+        }
+    }
+
+    // false - результат не готов к 'deadline'
+    bool wait_until(std::chrono::steady_clock::time_point deadline) {
+        auto flags = flags_.load(std::memory_order_acquire);
+        while (!(flags & has_result_)) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) return false;
+            if (mark_waiting_(flags)) futex_wait_for(flags_, flags, deadline - now);
+            flags = flags_.load(std::memory_order_acquire);
+        }
+        return true;
+    }
+
+    // 'callback' вызывается один раз, когда результат готов: сразу здесь же,
+    // если он уже готов, иначе в потоке, который его установит. продолжение
+    // хранится в состоянии, поэтому ссылается на него обычным указателем:
+    // состояние живо, пока его держит устанавливающий результат
+    void on_ready(PooledTask callback) {
+        callback_.emplace(std::move(callback));
+        if (flags_.fetch_or(has_callback_, std::memory_order_acq_rel) & has_result_) (*callback_)();
+    }
+
+    // только после готовности
+    const std::exception_ptr& error() const noexcept { return error_; }
+    value_t take_value() { return std::move(*value_); }
+    std::exception_ptr take_error() noexcept { return std::exchange(error_, nullptr); }
+
+private:
+    static constexpr uint32_t has_result_   = 1;
+    static constexpr uint32_t has_callback_ = 2;
+    static constexpr uint32_t waiting_      = 4;
+
+    void publish_() {
+        const auto flags = flags_.fetch_or(has_result_, std::memory_order_acq_rel);
+        if (flags & has_callback_) (*callback_)();
+        if (flags & waiting_) futex_wake(flags_, INT_MAX);
+    }
+
+    // true - бит ожидания выставлен в 'flags', можно спать
+    bool mark_waiting_(uint32_t& flags) noexcept {
+        if (flags & waiting_) return true;
+        return flags_.compare_exchange_weak(flags, flags | waiting_, std::memory_order_acq_rel, std::memory_order_acquire)
+            && (flags |= waiting_, true);
+    }
+
+    std::atomic<uint32_t>       flags_{0};
+    std::optional<value_t>      value_{};
+    std::exception_ptr          error_{};
+    std::optional<PooledTask>   callback_{};
+};
+
+//
+// результат задачи ThreadPool::submit(). одноразовый: значение забирает один
+// потребитель - get(), then() или when_all()/when_any().
+// продолжение then() выполняется задачей в пуле, из которого пришло будущее
+// (у будущего без пула - сразу в потоке, установившем результат), исключение
+// предыдущего шага пропускает продолжение и переходит в результат then()
+//
+template<typename T>
+class TaskFuture
+{
+public:
+    using value_t = typename TaskState<T>::value_t;
+
+    template<typename Func>
+    using then_result_t = typename std::conditional_t<std::is_void_v<T>,
+        std::invoke_result<Func&>, std::invoke_result<Func&, value_t>>::type;
+
+    TaskFuture() = default;
+    TaskFuture(const TaskFuture&) = delete;
+    TaskFuture(TaskFuture&&) = default;
+    TaskFuture& operator=(const TaskFuture&) = delete;
+    TaskFuture& operator=(TaskFuture&&) = default;
+
+    TaskFuture(std::shared_ptr<TaskState<T>> state, ThreadPool* pool)
+    :   state_(std::move(state)), pool_(pool) {}
+
+    static TaskFuture ready(value_t value = {}, ThreadPool* pool = nullptr) {
+        auto state = std::make_shared<TaskState<T>>();
+        state->set_value(std::move(value));
+        return TaskFuture(std::move(state), pool);
+    }
+
+    static TaskFuture failed(std::exception_ptr error, ThreadPool* pool = nullptr) {
+        auto state = std::make_shared<TaskState<T>>();
+        state->set_exception(std::move(error));
+        return TaskFuture(std::move(state), pool);
+    }
+
+    bool valid() const noexcept { return state_ != nullptr; }
+    bool is_ready() const noexcept { return state_->is_ready(); }
+    ThreadPool* pool() const noexcept { return pool_; }
+
+    void wait() const { state_->wait(); }
+    bool wait_until(std::chrono::steady_clock::time_point deadline) const { return state_->wait_until(deadline); }
+
+    // ждет результат; исключение задачи передается дальше
+    T get() {
+        auto state = std::exchange(state_, nullptr);
+        state->wait();
+        if (auto error = state->take_error()) std::rethrow_exception(std::move(error));
+        if constexpr (!std::is_void_v<T>) return state->take_value();
+    }
+
+    // 'func' принимает значение (без аргументов для TaskFuture<void>),
+    // определено в helpers/thread_pool.h
+    template<typename Func>
+    auto then(Func func) && -> TaskFuture<then_result_t<Func>>;
+
+    // для комбинаторов: забирает общее состояние
+    std::shared_ptr<TaskState<T>> release_state() && { return std::exchange(state_, nullptr); }
+
+private:
+    std::shared_ptr<TaskState<T>> state_{nullptr};
+    ThreadPool*                   pool_{nullptr};
+};
+
+template<typename T>
+using when_all_result_t = std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+
+// готово, когда готовы все 'futures': значения в исходном порядке,
+// либо первое исключение
+template<typename T>
+TaskFuture<when_all_result_t<T>> when_all(std::vector<TaskFuture<T>> futures)
+{
+    using result_t = when_all_result_t<T>;
+
+    struct all_s {
+        std::shared_ptr<TaskState<result_t>>                     state{std::make_shared<TaskState<result_t>>()};
+        std::vector<std::optional<typename TaskState<T>::value_t>> values{};
+        std::atomic<size_t>                                       remaining{0};
+        std::atomic<bool>                                         failed{false};
+    };
+    auto all = std::make_shared<all_s>();
+    all->values.resize(futures.size());
+    all->remaining = futures.size();
+
+    ThreadPool* pool = futures.empty() ? nullptr : futures.front().pool();
+    auto result = TaskFuture<result_t>(all->state, pool);
+    if (futures.empty()) {
+        all->state->set_value({});
+        return result;
+    }
+
+    for (size_t i = 0; i < futures.size(); ++i) {
+        auto input = std::move(futures[i]).release_state();
+        input->on_ready(PooledTask(nullptr, [all, input = input.get(), i]() {
+            if (input->error()) {
+                if (!all->failed.exchange(true)) all->state->set_exception(input->take_error());
+            } else {
+                all->values[i].emplace(input->take_value());
+            }
+            if (all->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1 || all->failed) return;
+
+            if constexpr (std::is_void_v<T>) {
+                all->state->set_value({});
+            } else {
+                result_t values;
+                values.reserve(all->values.size());
+                for (auto& value : all->values) values.push_back(std::move(*value));
+                all->state->set_value(std::move(values));
+            }
+        }));
+    }
+    return result;
+}
+
+// готово с первым значением из 'futures'; если все завершились
+// исключением - с исключением последнего
+template<typename T>
+TaskFuture<T> when_any(std::vector<TaskFuture<T>> futures)
+{
+    if (futures.empty()) {
+        return TaskFuture<T>::failed(std::make_exception_ptr(std::invalid_argument("when_any of no futures")));
+    }
+
+    struct any_s {
+        std::shared_ptr<TaskState<T>> state{std::make_shared<TaskState<T>>()};
+        std::atomic<size_t>           remaining{0};
+        std::atomic<bool>             done{false};
+    };
+    auto any = std::make_shared<any_s>();
+    any->remaining = futures.size();
+
+    auto result = TaskFuture<T>(any->state, futures.front().pool());
+    for (auto& future : futures) {
+        auto input = std::move(future).release_state();
+        input->on_ready(PooledTask(nullptr, [any, input = input.get()]() {
+            if (!input->error() && !any->done.exchange(true)) any->state->set_value(input->take_value());
+            if (any->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 && !any->done.exchange(true)) {
+                any->state->set_exception(input->take_error());
+            }
+        }));
+    }
+    return result;
+}
+
+} // namespace ThreadHelpers
+
+} // namespace SocialNetwork
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <sys/types.h>
 
 namespace SocialNetwork {
 
@@ -11,6 +16,27 @@ void block_signals();
 void set_name(pthread_t th, const std::string& name);
 std::string get_name(pthread_t th);
 
+// сколько ядер процессора доступно процессу: меньшее из маски sched_getaffinity
+// и квоты cgroup (cpu.max для v2, cpu.cfs_quota_us для v1), квота округляется вверх.
+// в контейнере с ограничением CPU hardware_concurrency() возвращает ядра хоста
+size_t available_cpus();
+
+// идентификатор текущего потока в ядре (gettid)
+pid_t current_tid() noexcept;
+// поток 'tid' этого процесса выполняется или ждет процессор (состояние R в
+// /proc/self/task/<tid>/stat), а не заблокирован в ожидании ввода-вывода или
+// блокировки. false, если поток уже завершился
+bool is_runnable(pid_t tid);
+
+// futex(2) напрямую: wait усыпляет поток, пока значение 'word' равно 'expected'
+// (возможны ложные пробуждения), wake будит до 'count' потоков, спящих на 'word'.
+// в отличие от std::atomic::wait/notify нет предварительного вращения и общей
+// таблицы ожидающих
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) noexcept;
+// то же, но не дольше 'timeout'
+void futex_wait_for(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) noexcept;
+void futex_wake(std::atomic<uint32_t>& word, int count) noexcept;
+
 } // namespace ThreadHelpers
 
 } // namespace SocialNetwork
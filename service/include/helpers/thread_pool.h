@@ -1,78 +1,90 @@
 #pragma once
 
-#include <queue>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <climits>
+#include <cstddef>
 #include <thread>
 #include <future>
-#include <mutex>
 #include <atomic>
 #include <memory>
 #include <optional>
+#include <span>
 #include <type_traits>
 #include <utility>
 #include <functional>
-#include <any>
+#include <string>
+#include <vector>
+#include "helpers/cpu_topology.h"
+#include "helpers/mpmc_queue.h"
+#include "helpers/pooled_task.h"
+#include "helpers/task_future.h"
+#include "helpers/thread.h"
+#include "helpers/work_stealing_deque.h"
 #include "logger/logger.h"
 
 namespace SocialNetwork {
 
 namespace ThreadHelpers {
 
-class PooledTask
-{
-public:
-    ~PooledTask() = default;
-    PooledTask() = delete;
-    PooledTask(const PooledTask&) = default;
-    PooledTask(PooledTask&&) = default;
-    PooledTask& operator=(const PooledTask&) = default;
-    PooledTask& operator=(PooledTask&&) = default;
-
-    template<typename Func, typename... Args>
-    explicit PooledTask(const Func& func, Args&&... args)
-    :   is_void{std::is_void_v<decltype(func(std::forward<Args>(args)...))>} {
-        // using R = decltype(func(std::forward<Args>(args)...));
-        if constexpr (std::is_void_v<decltype(func(std::forward<Args>(args)...))>) {
-            void_func = std::bind(func, std::forward<Args>(args)...);
-            any_func  = []()->int { return 0; };
-        } else {
-            void_func = []()->void {};
-            any_func  = std::bind(func, std::forward<Args>(args)...);
-        }
-    }
-
-    void operator() () {
-        void_func();
-        result = any_func();
-    }
-
-    std::any get_result() const {
-        if (is_void) return {};
-        return result;
-    }
-
-private:
-    const bool                  is_void{false};
-    std::function<void()>       void_func{nullptr};
-    std::function<std::any()>   any_func{nullptr};
-    std::any                    result{};
+// как потоки пула получают задачи:
+//  SharedQueue  - все задачи в одной общей очереди
+//  WorkStealing - у каждого потока своя дека Chase-Lev; задача, добавленная из
+//                 потока этого же пула, кладется в его деку, простаивающие потоки
+//                 перехватывают задачи из чужих дек. задачи извне пула идут в
+//                 общую очередь. подходит, когда задачи порождают подзадачи
+enum class Scheduling : uint8_t {
+    SharedQueue,
+    WorkStealing
 };
 
-
-
-using OnCompleteFunc = std::function<void(std::any)>;
+// эластичный размер пула: 'threads_count' конструктора - минимум потоков, при
+// нагрузке пул растет до 'threads_max_count'. раз в 'grow_delay' управляющий поток
+// проверяет, есть ли задачи, ждущие в очереди дольше 'grow_delay', и добавляет
+// по потоку на такую задачу, пока готовых выполняться (не заблокированных) потоков
+// пула меньше 'cpus_limit' (0 - ядер, доступных процессу с учетом квоты cgroup).
+// поток без задач дольше 'idle_timeout' завершается. threads_max_count не больше
+// threads_count (по умолчанию) - пул фиксированного размера без управляющего потока
+struct Elasticity {
+    uint64_t                  threads_max_count{0};
+    uint64_t                  cpus_limit{0};
+    std::chrono::milliseconds grow_delay{10};
+    std::chrono::milliseconds idle_timeout{30000};
+    // изменилось количество потоков (+N - добавлены, -1 - поток завершен),
+    // вызывается из управляющего потока и потоков пула
+    std::function<void(int delta)> on_resize{};
+};
 
 class ThreadPool
 {
 protected:
     struct TaskMeta {
-        TaskMeta(uint64_t id, OnCompleteFunc& cb)
-        :   id_(id), cb_(cb) {}
+        TaskMeta(uint64_t id, uint64_t queued_ns)
+        :   id_(id),
+            queued_ns_(queued_ns) {}
 
         uint64_t       id_{0};
-        OnCompleteFunc cb_{};
+        uint64_t       queued_ns_{0};   // steady_clock при добавлении, 0 - время не учитывается
     };
 
+    using QueuedTask = std::pair<PooledTask, TaskMeta>;
+
 public:
+    // границы корзин гистограмм времени задач (ожидание в очереди, выполнение), нс
+    static constexpr std::array<uint64_t, 16> timing_bounds_ns{
+        10'000, 50'000, 100'000, 250'000, 500'000,
+        1'000'000, 2'500'000, 5'000'000, 10'000'000, 25'000'000, 50'000'000,
+        100'000'000, 250'000'000, 500'000'000, 1'000'000'000, 5'000'000'000
+    };
+
+    // гистограмма времени задач: buckets[i] - задачи не дольше timing_bounds_ns[i],
+    // последняя корзина - остальные (не накопительная, в отличие от Prometheus)
+    struct Timings {
+        std::array<uint64_t, timing_bounds_ns.size() + 1> buckets{};
+        uint64_t                                          sum_ns{0};
+    };
+
     ~ThreadPool();
     ThreadPool() = delete;
     ThreadPool(const ThreadPool&) = default;
@@ -80,72 +92,262 @@ public:
     ThreadPool& operator=(const ThreadPool&) = default;
     ThreadPool& operator=(ThreadPool&&) = default;
 
+    // 'tasks_batch_max' больше 1 - потоки забирают из общей очереди до стольких
+    // задач за раз, только для коротких неблокирующих задач (см. tasks_batch_max_)
     explicit ThreadPool(const std::string_view name,
                         std::shared_ptr<Logging::Logger> logger,
                         uint64_t threads_count,
-                        uint64_t tasks_capacity);
+                        uint64_t tasks_capacity,
+                        Scheduling scheduling = Scheduling::SharedQueue,
+                        Elasticity elasticity = {},
+                        std::vector<unsigned> cpus = {},
+                        size_t tasks_batch_max = 1);
 
-    template<typename Func, typename... Args>
-    std::optional<uint64_t> add_task(OnCompleteFunc cb, Func func, Args&&... args)
+    // 'cb' - nullptr, либо вызываемый объект, принимающий TaskResult<R> (R - тип
+    // результата 'func'): вызывается в потоке пула после выполнения задачи, либо
+    // сразу с nullopt, если задача отклонена
+    template<typename OnComplete, typename Func, typename... Args>
+    std::optional<uint64_t> add_task(OnComplete cb, Func func, Args&&... args)
     {
-        uint64_t id = 0;
-        bool refused = false;
-
-        {
-            std::lock_guard<std::mutex> lock(tasks_mutex_);
-            id = statistic_.tasks_last_id++;
-            if (tasks_.size() < tasks_max_capacity_) {
-                auto& t = tasks_.emplace(PooledTask(func, std::forward<Args>(args)...), TaskMeta(id, cb));
-                tasks_condition_.notify_one();
-            } else {
-                refused = true;
-                ++statistic_.tasks_refused_count;
-            }
+        const uint64_t id = statistic_.tasks_last_id++;
+        PooledTask task(std::move(cb), std::move(func), std::forward<Args>(args)...);
+        bool accepted = false;
+        if (auto* deque = local_deque_()) {
+            accepted = push_local_(*deque, task, id);
+        } else {
+            // при отказе задача не перемещается из 'task'
+            accepted = tasks_.try_emplace(std::move(task), TaskMeta(id, timing_stamp_()));
+            if (accepted) wake_worker_();
         }
-        if (refused && cb) {
-            cb({});
+        if (!accepted) {
+            // очередь (и дека потока) заполнена: задача отклоняется
+            ++statistic_.tasks_refused_count;
+            notify_results_();
+            task.refuse();
             return std::nullopt;
         }
 
         return id;
     }
 
+    // добавляет задачи пачкой: место в общей очереди захватывается подряд идущими
+    // ячейками, а спящих потоков будится не больше, чем задач, один раз на пачку.
+    // задачи принимаются по порядку, пока есть место, остальные отклоняются
+    // (PooledTask::refuse). возвращает сколько задач принято; id задач пачки идут подряд
+    size_t add_tasks(std::span<PooledTask> tasks);
+
+    // то же с результатом в TaskFuture: значение или исключение 'func', либо
+    // task_refused, если задача отклонена
+    template<typename Func, typename... Args>
+    auto submit(Func func, Args&&... args) -> TaskFuture<std::invoke_result_t<Func&, std::decay_t<Args>&...>>
+    {
+        using result_t = std::invoke_result_t<Func&, std::decay_t<Args>&...>;
+        auto state = std::make_shared<TaskState<result_t>>();
+        auto accepted = add_task(nullptr, [state, func = std::move(func)](auto&... a) mutable {
+            state->fulfil(func, a...);
+        }, std::forward<Args>(args)...);
+        if (!accepted) state->set_exception(std::make_exception_ptr(task_refused("thread pool queue is full")));
+        return TaskFuture<result_t>(std::move(state), this);
+    }
+
     void wait_all();
 
     // <statistic>
+    const std::string& name() const { return name_; }
+    uint64_t threads_count() const { return threads_running_; }
+    uint64_t threads_min_count() const { return threads_min_count_; }
     uint64_t threads_max_count() const { return threads_max_count_; }
+    uint64_t threads_grown_count() const { return statistic_.threads_grown_count; }
+    uint64_t threads_retired_count() const { return statistic_.threads_retired_count; }
     uint64_t tasks_max_capacity() const { return tasks_max_capacity_; }
+    Scheduling scheduling() const { return scheduling_; }
+    const std::vector<unsigned>& cpus() const { return cpus_; }
 
     uint64_t tasks_total_count() const { return statistic_.tasks_last_id; }
     uint64_t tasks_completed_count() const { return statistic_.tasks_completed_count; }
     uint64_t tasks_refused_count() const { return statistic_.tasks_refused_count; }
-    uint64_t tasks_active_count() const { return tasks_.size(); }
+    uint64_t tasks_stolen_count() const { return statistic_.tasks_stolen_count; }
+    uint64_t tasks_active_count() const;
+    // потоки, выполняющие задачи
+    uint64_t threads_busy_count() const;
+    // время ожидания в очереди и выполнения задач, добавленных при включенном учете времени
+    void tasks_timings(Timings& wait, Timings& run) const;
     // </statistic>
 
+    // вызывает 'func' для каждого пула процесса под блокировкой списка пулов:
+    // пул не удаляется, пока 'func' к нему обращается
+    static void for_each(const std::function<void(const ThreadPool&)>& func);
+
+    // учет времени задач во всех пулах процесса (Timings): метка времени при
+    // добавлении задачи и по одной на задачу в потоке пула. выключен по умолчанию
+    static void enable_timings(bool enable) noexcept { timings_enabled_.store(enable, std::memory_order_relaxed); }
+
+    // пул, в потоке которого выполняется код, nullptr вне потоков пулов
+    static ThreadPool* current() noexcept { return current_worker_.pool; }
+
 private:
     std::shared_ptr<Logging::Logger> logger_{};
+    const std::string name_{};
+    const uint64_t threads_min_count_{0};
     const uint64_t threads_max_count_{0};
     const uint64_t tasks_max_capacity_{0};
+    const Scheduling scheduling_{Scheduling::SharedQueue};
 
     struct statistic_s {
         std::atomic<uint64_t> tasks_last_id{0};
         std::atomic<uint64_t> tasks_completed_count{0};
         std::atomic<uint64_t> tasks_refused_count{0};
+        std::atomic<uint64_t> tasks_stolen_count{0};
+        std::atomic<uint64_t> tasks_started_count{0};
+        std::atomic<uint64_t> threads_grown_count{0};
+        std::atomic<uint64_t> threads_retired_count{0};
     } statistic_{};
 
     std::atomic<bool>        threads_stop_{false};
-    std::vector<std::thread> threads_{};
+    std::vector<std::thread> threads_{};    // по порядковому номеру потока, до threads_max_count_
+    std::atomic<uint64_t>    threads_running_{0};
+
+    // эластичный размер: состояние места потока в threads_ меняют управляющий
+    // поток (запуск, join) и сам поток пула (завершение по простою)
+    enum class Slot : uint8_t { Free, Running, Retired };
+    const Elasticity                         elasticity_{};
+    std::unique_ptr<std::atomic<Slot>[]>     slots_{};
+    std::unique_ptr<std::atomic<pid_t>[]>    tids_{};       // для состояния потоков в /proc
+    std::thread                              control_thread_{};
+    std::atomic<uint32_t>                    control_epoch_{0};
+    const uint64_t                           cpus_limit_{0};
+
+    // ядра потоков по порядковому номеру (поток N - ядро N % размер, см.
+    // CpuTopology::placement), пустой - потоки не закрепляются. если все ядра на
+    // одном узле NUMA, очередь пула переносится в память этого узла
+    const std::vector<unsigned>              cpus_{};
+
+    // сколько задач поток забирает из общей очереди за раз: не больше своей доли
+    // очереди (размер очереди на количество потоков), чтобы задачи не ждали в
+    // буфере занятого потока, пока другие простаивают. по умолчанию и в
+    // эластичном пуле - по одной: пачка подходит только коротким задачам, которые
+    // не блокируются, иначе задачи пачки ждут, пока выполняется первая
+    const size_t                             tasks_batch_max_{1};
+
+    // статистика, которую пишет только поток пула со своим порядковым номером:
+    // счетчики обновляются без атомарных операций чтения-записи и в своей кэш-линии,
+    // поэтому потоки не конкурируют за них. суммируются при чтении статистики
+    struct alignas(64) shard_s {
+        std::array<std::atomic<uint64_t>, timing_bounds_ns.size() + 1> wait{};
+        std::array<std::atomic<uint64_t>, timing_bounds_ns.size() + 1> run{};
+        std::atomic<uint64_t> wait_sum_ns{0};
+        std::atomic<uint64_t> run_sum_ns{0};
+        std::atomic<bool>     busy{false};
+    };
+    std::unique_ptr<shard_s[]> shards_{};
+
+    static inline std::atomic<bool> timings_enabled_{false};
+
+    // метка времени для TaskMeta::queued_ns_, 0 - учет времени выключен
+    static uint64_t timing_stamp_() noexcept {
+        if (!timings_enabled_.load(std::memory_order_relaxed)) return 0;
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // сколько раз поток уступает процессор, прежде чем уснуть на пустой очереди:
+    // при частых задачах он подхватывает следующую без пробуждения через futex
+    static constexpr unsigned idle_spins_{16};
+
+    // очередь без блокировок; простаивающие потоки спят на wake_epoch_ (eventcount):
+    // производитель будит поток, только если есть спящие, без мьютекса и системного
+    // вызова на каждую задачу
+    MpmcQueue<QueuedTask>   tasks_;
+    std::atomic<uint32_t>   wake_epoch_{0};
+    std::atomic<uint32_t>   sleepers_{0};
+
+    // то же для wait_all(): завершение задачи будит ожидающих, только если они есть
+    std::atomic<uint32_t>   results_epoch_{0};
+    std::atomic<uint32_t>   results_waiters_{0};
+
+    // Scheduling::WorkStealing: деки потоков по порядковому номеру. емкость деки
+    // равна емкости пула, при переполнении задача идет в общую очередь
+    using LocalDeque = WorkStealingDeque<QueuedTask*>;
+    std::vector<std::unique_ptr<LocalDeque>> deques_{};
+
+    // поток пула, в котором выполняется код (nullptr вне потоков пулов)
+    struct worker_s {
+        ThreadPool* pool;
+        size_t      serial;
+    };
+    static inline thread_local worker_s current_worker_{};
+
+    LocalDeque* local_deque_() const noexcept {
+        if (current_worker_.pool != this || deques_.empty()) return nullptr;
+        return deques_[current_worker_.serial].get();
+    }
+
+    void wake_worker_(uint32_t count = 1) noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (const auto sleepers = sleepers_.load(std::memory_order_relaxed); sleepers > 0) {
+            wake_epoch_.fetch_add(1, std::memory_order_release);
+            futex_wake(wake_epoch_, static_cast<int>(std::min(count, sleepers)));
+        }
+    }
 
-    std::mutex                                  tasks_mutex_{};
-    std::condition_variable                     tasks_condition_{};
-    std::queue<std::pair<PooledTask, TaskMeta>> tasks_{};
+    // wait_all() ждет, пока пул не опустеет, поэтому будится, только когда все
+    // добавленные задачи выполнены или отклонены, а не после каждой задачи
+    void notify_results_() noexcept {
+        if (statistic_.tasks_completed_count + statistic_.tasks_refused_count != statistic_.tasks_last_id) return;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (results_waiters_.load(std::memory_order_relaxed) > 0) {
+            results_epoch_.fetch_add(1, std::memory_order_release);
+            futex_wake(results_epoch_, INT_MAX);
+        }
+    }
 
-    std::mutex              task_results_all_mutex_{};
-    std::condition_variable task_results_all_condition_{};
+    bool elastic_() const noexcept { return threads_max_count_ > threads_min_count_; }
 
-    void run(const std::string thread_name);
+    void start_thread_(size_t serial);
+    bool retire_thread_(size_t serial);
+    void control();
+    uint64_t runnable_threads_() const;
+
+    bool push_local_(LocalDeque& deque, PooledTask& task, uint64_t id);
+    size_t take_tasks_(size_t serial, std::vector<QueuedTask>& batch);
+    size_t pop_tasks_(size_t serial, std::vector<QueuedTask>& batch);
+    bool has_tasks_() const noexcept;
+    bool wait_task_();
+    void run(size_t serial, const std::string thread_name);
 };
 
+template<typename T>
+template<typename Func>
+auto TaskFuture<T>::then(Func func) && -> TaskFuture<then_result_t<Func>>
+{
+    using result_t = then_result_t<Func>;
+    auto next  = std::make_shared<TaskState<result_t>>();
+    auto input = std::exchange(state_, nullptr);
+    input->on_ready(PooledTask(nullptr, [input = input.get(), next, pool = pool_, func = std::move(func)]() mutable {
+        if (input->error()) {
+            next->set_exception(input->take_error());
+            return;
+        }
+        auto step = [next, func = std::move(func)](auto&... value) mutable {
+            next->fulfil(func, std::move(value)...);
+        };
+        if (pool == nullptr) {
+            if constexpr (std::is_void_v<T>) {
+                step();
+            } else {
+                auto value = input->take_value();
+                step(value);
+            }
+            return;
+        }
+        std::optional<uint64_t> accepted;
+        if constexpr (std::is_void_v<T>) accepted = pool->add_task(nullptr, std::move(step));
+        else accepted = pool->add_task(nullptr, std::move(step), input->take_value());
+        if (!accepted) next->set_exception(std::make_exception_ptr(task_refused("thread pool queue is full")));
+    }));
+    return TaskFuture<result_t>(std::move(next), pool_);
+}
+
 } // namespace ThreadHelpers
 
 } // namespace SocialNetwork
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include "helpers/pooled_task.h"
+
+namespace SocialNetwork {
+
+namespace ThreadHelpers {
+
+//
+// задачи, отложенные до момента времени: один поток ждет ближайший срок и
+// выполняет задачи по очереди. задача должна быть короткой (например, передать
+// продолжение в пул потоков), иначе она задерживает следующие
+//
+class TimerQueue
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    // отложенная задача для cancel()
+    struct Timer {
+        clock_t::time_point at{};
+        uint64_t            id{0};
+    };
+
+    TimerQueue(const TimerQueue&) = delete;
+    TimerQueue& operator=(const TimerQueue&) = delete;
+
+    explicit TimerQueue(const std::string& name);
+    ~TimerQueue();
+
+    // общая очередь процесса, поток создается при первом обращении
+    static TimerQueue& shared();
+
+    // 'task' выполняется в потоке очереди не раньше 'at'. задачи,
+    // не выполненные до разрушения очереди, отклоняются (PooledTask::refuse)
+    Timer add(clock_t::time_point at, PooledTask task);
+
+    // false - задача уже выполнена или отменена
+    bool cancel(const Timer& timer);
+
+private:
+    using timers_t = std::map<std::pair<clock_t::time_point, uint64_t>, PooledTask>;
+
+    std::mutex              mutex_{};
+    std::condition_variable condition_{};
+    timers_t                timers_{};
+    uint64_t                last_id_{0};
+    bool                    stop_{false};
+    std::thread             thread_{};
+
+    void run_();
+};
+
+} // namespace ThreadHelpers
+
+} // namespace SocialNetwork
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace SocialNetwork {
+
+namespace UuidHelpers {
+
+//
+// UUID в бинарном виде (16 байт, порядок байт как в текстовой записи и
+// в бинарном формате uuid PostgreSQL). вдвое компактнее текстовой записи,
+// поэтому используется как ключ во внутренних структурах, и передается
+// в запросы к БД бинарным параметром
+//
+class Uuid
+{
+public:
+    static constexpr size_t size_bytes  = 16;
+    static constexpr size_t size_string = 36;   // xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx
+
+    using Bytes  = std::array<std::byte, size_bytes>;
+    using String = std::array<char, size_string>;
+
+    constexpr Uuid() noexcept = default;
+    constexpr explicit Uuid(const Bytes& bytes) noexcept : bytes_(bytes) {}
+
+    // разбирает каноническую запись (36 символов, цифры в любом регистре),
+    // std::nullopt - запись некорректна
+    static std::optional<Uuid> parse(std::string_view s) noexcept;
+
+    // каноническая запись в нижнем регистре
+    String to_chars() const noexcept;
+    std::string to_string() const;
+
+    constexpr const std::byte* data() const noexcept { return bytes_.data(); }
+    constexpr size_t size() const noexcept { return bytes_.size(); }
+    constexpr const Bytes& bytes() const noexcept { return bytes_; }
+
+    friend constexpr bool operator==(const Uuid&, const Uuid&) noexcept = default;
+    friend constexpr auto operator<=>(const Uuid&, const Uuid&) noexcept = default;
+
+private:
+    Bytes bytes_{};
+};
+
+} // namespace UuidHelpers
+
+} // namespace SocialNetwork
+
+template <>
+struct std::hash<SocialNetwork::UuidHelpers::Uuid>
+{
+    size_t operator()(const SocialNetwork::UuidHelpers::Uuid& id) const noexcept {
+        // байты UUID v4/v7 и так достаточно случайны, смешиваем две половины
+        uint64_t lo = 0;
+        uint64_t hi = 0;
+        std::memcpy(&lo, id.data(), sizeof(lo));
+        std::memcpy(&hi, id.data() + sizeof(lo), sizeof(hi));
+        return static_cast<size_t>(lo ^ (hi * 0x9e3779b97f4a7c15ull));
+    }
+};
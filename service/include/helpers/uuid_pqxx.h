@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstring>
+#include <format>
+#include <pqxx/pqxx>
+#include "helpers/uuid.h"
+
+//
+// связка UuidHelpers::Uuid с libpqxx:
+//  - в запрос UUID передается бинарным параметром (binary_param),
+//    PostgreSQL принимает его как есть, без разбора текста;
+//  - из результата читается как row[0].as<Uuid>() (текстовый формат)
+//
+
+namespace pqxx {
+
+template <>
+struct nullness<SocialNetwork::UuidHelpers::Uuid> : no_null<SocialNetwork::UuidHelpers::Uuid> {};
+
+template <>
+struct string_traits<SocialNetwork::UuidHelpers::Uuid>
+{
+    using Uuid = SocialNetwork::UuidHelpers::Uuid;
+
+    static constexpr bool converts_to_string{true};
+    static constexpr bool converts_from_string{true};
+
+    static Uuid from_string(std::string_view text)
+    {
+        auto id = Uuid::parse(text);
+        if (!id) throw conversion_error(std::format("'{}' is not an UUID", text));
+        return *id;
+    }
+
+    static char* into_buf(char* begin, char* end, const Uuid& value)
+    {
+        if (end - begin < static_cast<std::ptrdiff_t>(Uuid::size_string + 1)) {
+            throw conversion_overrun("not enough buffer space for UUID");
+        }
+        const auto chars = value.to_chars();
+        std::memcpy(begin, chars.data(), chars.size());
+        begin[chars.size()] = '\0';
+        return begin + chars.size() + 1;
+    }
+
+    static zview to_buf(char* begin, char* end, const Uuid& value)
+    {
+        auto next = into_buf(begin, end, value);
+        return zview(begin, static_cast<size_t>(next - begin - 1));
+    }
+
+    static size_t size_buffer(const Uuid&) noexcept { return Uuid::size_string + 1; }
+};
+
+} // namespace pqxx
+
+namespace SocialNetwork {
+
+namespace UuidHelpers {
+
+// 16 байт в бинарном формате типа uuid (uuid_recv)
+inline pqxx::bytes_view binary_param(const Uuid& id) noexcept
+{
+    return pqxx::bytes_view(id.data(), id.size());
+}
+
+} // namespace UuidHelpers
+
+} // namespace SocialNetwork
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+namespace SocialNetwork {
+
+namespace ThreadHelpers {
+
+//
+// ограниченная дека Chase-Lev для планировщика с перехватом задач
+// (Lê, Pop, Cohen, Zappa Nardelli, "Correct and Efficient Work-Stealing for
+// Weak Memory Models").
+//
+// владелец кладет и забирает задачи с нижнего конца (push/pop, LIFO: свежая
+// задача еще в кэше), другие потоки перехватывают с верхнего (steal, FIFO).
+// владелец синхронизируется с перехватчиками только за последний элемент, так
+// что пока в деке больше одной задачи, push/pop обходятся без CAS.
+//
+// буфер не растет: емкость соблюдается точно, push() в заполненную деку
+// возвращает false. хранит значения, которые копируются атомарно (указатели)
+//
+template <typename T>
+class WorkStealingDeque
+{
+    static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque stores trivially copyable values");
+
+public:
+    WorkStealingDeque() = delete;
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    explicit WorkStealingDeque(size_t capacity)
+    :   capacity_(capacity > 0 ? capacity : 1),
+        mask_(std::bit_ceil(capacity_) - 1),
+        buffer_(std::make_unique<std::atomic<T>[]>(mask_ + 1)) {}
+
+    size_t capacity() const noexcept { return capacity_; }
+
+    // приблизительный размер: при одновременных операциях может быть неточным
+    size_t size() const noexcept {
+        const auto b = bottom_.load(std::memory_order_relaxed);
+        const auto t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+    // только поток-владелец
+    bool push(T item) noexcept {
+        const auto b = bottom_.load(std::memory_order_relaxed);
+        const auto t = top_.load(std::memory_order_acquire);
+        if (b - t >= static_cast<int64_t>(capacity_)) return false;
+        buffer_[b & mask_].store(item, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // только поток-владелец
+    std::optional<T> pop() noexcept {
+        const auto b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // дека пуста
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        const T item = buffer_[b & mask_].load(std::memory_order_relaxed);
+        if (t == b) {
+            // последний элемент: соревнуемся с перехватчиками за top
+            const bool won = top_.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            if (!won) return std::nullopt;
+        }
+        return item;
+    }
+
+    // любой поток
+    std::optional<T> steal() noexcept {
+        auto t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return std::nullopt;
+
+        const T item = buffer_[t & mask_].load(std::memory_order_acquire);
+        if (!top_.compare_exchange_strong(t, t + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed)) return std::nullopt;
+        return item;
+    }
+
+private:
+    static constexpr size_t cache_line_size = 64;
+
+    const size_t                            capacity_;
+    const size_t                            mask_;
+    const std::unique_ptr<std::atomic<T>[]> buffer_;
+
+    // top меняют перехватчики, bottom - только владелец
+    alignas(cache_line_size) std::atomic<int64_t> top_{0};
+    alignas(cache_line_size) std::atomic<int64_t> bottom_{0};
+};
+
+} // namespace ThreadHelpers
+
+} // namespace SocialNetwork
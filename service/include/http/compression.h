@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace SocialNetwork {
+
+namespace Http {
+
+//
+// сжатие тел ответов (Content-Encoding). gzip доступен при сборке с zlib,
+// zstd и br - при сборке с libzstd и libbrotlienc (см. sources/CMakeLists.txt).
+// сжатие выполняется в потоке пула, контексты компрессоров создаются один раз
+// на поток и переиспользуются для всех ответов
+//
+enum class Encoding : uint8_t {
+    IDENTITY,
+    GZIP,
+    ZSTD,
+    BROTLI
+};
+
+constexpr size_t encodings_count = 4;
+
+// значение для заголовка Content-Encoding
+std::string_view to_string(Encoding encoding) noexcept;
+
+// сервис собран с поддержкой кодировки
+bool is_supported(Encoding encoding) noexcept;
+
+// выбирает кодировку по заголовку Accept-Encoding (RFC 9110, 12.5.3): из поддерживаемых
+// с наибольшим q, при равных q - zstd, br, gzip. IDENTITY - ответ не сжимается
+Encoding negotiate(std::string_view accept_encoding) noexcept;
+
+struct CompressionStats
+{
+    size_t plain_size{0};
+    size_t encoded_size{0};
+    double cpu_seconds{0.0};    // процессорное время потока, затраченное на сжатие
+
+    double ratio() const noexcept {
+        return encoded_size ? static_cast<double>(plain_size) / static_cast<double>(encoded_size) : 0.0;
+    }
+};
+
+// сжимает 'in' в 'out' (содержимое 'out' заменяется). false - кодировка
+// не поддерживается, либо ошибка компрессора
+bool compress(Encoding encoding, std::string_view in, std::string& out, CompressionStats& stats);
+
+//
+// тело ответа вместе с его сжатыми вариантами - запись для кэша ответов.
+// каждый вариант сжимается один раз, при первом запросе в этой кодировке,
+// а дальше отдается готовым. разделяется между потоками как
+// std::shared_ptr<const EncodedBody>
+//
+class EncodedBody
+{
+public:
+    EncodedBody(std::string body, std::string content_type)
+    :   plain_(std::move(body)),
+        content_type_(std::move(content_type)) {}
+
+    const std::string& plain() const noexcept { return plain_; }
+    const std::string& content_type() const noexcept { return content_type_; }
+
+    // тело в кодировке 'encoding', nullptr - нужно отдать несжатое тело
+    // (кодировка не поддерживается, либо сжатие не уменьшает размер).
+    // 'stats' заполняется, если сжатие было выполнено именно в этом вызове
+    const std::string* encoded(Encoding encoding, std::optional<CompressionStats>& stats) const;
+
+private:
+    struct variant_s {
+        bool        done{false};
+        bool        useful{false};
+        std::string data{};
+    };
+
+    const std::string plain_{};
+    const std::string content_type_{};
+
+    // готовый вариант больше не меняется, поэтому указатель на него
+    // остается действительным все время жизни объекта
+    mutable std::mutex                                mutex_{};
+    mutable std::array<variant_s, encodings_count>    variants_{};
+};
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include "http/http_connection.h"
+#include "http/reactor_server.h"
+#include "http/worker_lanes.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+//
+// учет соединений одного слушающего адреса, общий для всех reactor-потоков сервера:
+//  - лимит соединений с одного IP-адреса проверяется при приеме соединения
+//  - политика закрытия: keep-alive таймаут, таймаут чтения, а пока пул потоков
+//    перегружен - досрочное закрытие простаивающих соединений, чтобы клиенты,
+//    которым соединение сейчас не нужно, не держали ресурсы сервера
+//  - уведомления для метрик об открытых, простаивающих и закрытых сервером соединениях
+//
+// сами соединения принадлежат reactor-потокам, здесь только счетчики
+//
+class ConnectionManager
+{
+public:
+    ConnectionManager() = delete;
+    ConnectionManager(const ConnectionManager&) = delete;
+    ConnectionManager& operator=(const ConnectionManager&) = delete;
+
+    ConnectionManager(const ReactorOptions& options, const WorkerLanes& lanes)
+    :   options_(options),
+        lanes_(lanes) {}
+
+    // принято соединение с адреса 'ip'. false - превышен max_connections_per_ip,
+    // соединение нужно отклонить (reject()), close() для него не вызывается
+    bool open(const std::string& ip);
+
+    // соединение, для которого open() вернул true, закрыто
+    void close(const std::string& ip);
+
+    // отвечает 503 без чтения запроса и закрывает сокет
+    void reject(int fd) const;
+
+    // все потоки пула какой-либо дорожки заняты, и в ее очереди есть запросы
+    bool saturated() const noexcept { return lanes_.saturated(); }
+
+    // пора ли закрыть соединение, и почему. std::nullopt - нет
+    std::optional<ReapReason> check(const Connection& conn, std::chrono::steady_clock::time_point now) const;
+
+    // простаивающих соединений у reactor-потока стало 'count',
+    // 'reported' - сколько он сообщил в прошлый раз
+    void report_idle(size_t count, size_t& reported) const;
+
+private:
+    const ReactorOptions& options_;
+    const WorkerLanes&    lanes_;
+
+    std::mutex                              per_ip_mutex_{};
+    std::unordered_map<std::string, size_t> per_ip_{};
+};
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "http/connection_manager.h"
+#include "http/reactor_server.h"
+#include "http/worker_lanes.h"
+#include "logger/logger.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+//
+// HTTP/1.1 сервер на edge-triggered epoll.
+// каждый reactor-поток имеет свой epoll и свой набор соединений,
+// новые соединения принимаются из общего слушающего сокета (EPOLLEXCLUSIVE).
+// простаивающие keep-alive соединения не занимают потоки пула
+//
+class EpollServer final : public ReactorServer
+{
+public:
+    ~EpollServer() override;
+    EpollServer() = delete;
+    EpollServer(const EpollServer&) = delete;
+    EpollServer(EpollServer&&) = delete;
+    EpollServer& operator=(const EpollServer&) = delete;
+    EpollServer& operator=(EpollServer&&) = delete;
+
+    explicit EpollServer(std::shared_ptr<Logging::Logger> logger,
+                         const ReactorOptions& options,
+                         RequestHandler handler);
+
+    bool bind_to_port(const NetHelpers::SocketAddress& addr) override;
+    bool start() override;
+    void stop() override;
+    bool is_running() const override { return running_; }
+
+private:
+    class Reactor;
+
+    std::shared_ptr<Logging::Logger> logger_{nullptr};
+    const ReactorOptions             options_{};
+    RequestHandler                   handler_{};
+    WorkerLanes                      lanes_;
+    ConnectionManager                conn_manager_;
+
+    int                                         listen_fd_{-1};
+    std::atomic<bool>                           running_{false};
+    std::vector<std::unique_ptr<Reactor>>       reactors_{};
+};
+
+} // namespace Http
+
+} // namespace SocialNetwork
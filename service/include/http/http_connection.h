@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+#include "http/http_parser.h"
+#include "http/reactor_server.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+//
+// состояние клиентского соединения, общее для всех reactor-серверов.
+// принадлежит одному reactor-потоку, из потоков пула не используется.
+//
+// запросы обрабатываются конвейером (HTTP/1.1 pipelining): из входного буфера
+// разбирается до pipeline_max_depth запросов, они параллельно выполняются
+// в пуле, а ответы отправляются строго в порядке поступления запросов
+//
+struct Connection
+{
+    enum class Input {
+        NEED_MORE,  // запрос еще не принят целиком, либо конвейер заполнен
+        REQUEST,    // очередной запрос принят и поставлен в конвейер
+        FAILED      // запрос некорректен или отклонен, в конвейер поставлен ответ с ошибкой
+    };
+
+    // ответ на один запрос конвейера
+    struct Pending {
+        std::string data{};
+        bool        ready{false};
+    };
+
+    Connection(uint64_t conn_id, int conn_fd, const ReactorOptions& options)
+    :   id(conn_id),
+        fd(conn_fd),
+        parser(options.headers_max_length, options.payload_max_length, options.on_headers),
+        last_activity(std::chrono::steady_clock::now()) {}
+
+    uint64_t          id{0};
+    int               fd{-1};
+    std::string       remote_addr{};
+    int               remote_port{-1};
+
+    std::string       in{};
+    size_t            in_off{0};
+    HttpRequestParser parser;
+
+    std::deque<Pending> pending{};          // ответы в порядке поступления запросов
+    uint64_t            pending_seq{0};     // номер запроса в pending.front()
+    size_t              out_off{0};         // отправлено байт из pending.front()
+
+    size_t            requests_served{0};
+    bool              input_closed{false};  // после запроса без keep-alive входные данные не разбираются
+    bool              peer_closed{false};
+
+    std::chrono::steady_clock::time_point last_activity{};
+
+    // разбирает накопленные во входном буфере данные, если конвейер не заполнен.
+    // при Input::REQUEST запрос забирается в 'req', 'seq' - его номер в конвейере,
+    // а 'keep_alive' говорит, можно ли оставить соединение открытым после ответа на него
+    Input next_request(const ReactorOptions& options, httplib::Request& req, bool& keep_alive, uint64_t& seq);
+
+    // сохраняет готовый ответ на запрос 'seq', false - такого запроса нет
+    bool complete(uint64_t seq, std::string&& data);
+
+    // заполняет 'iov' готовыми к отправке ответами с начала конвейера
+    void ready_output(std::vector<iovec>& iov, size_t iov_max) const;
+
+    // убирает из конвейера 'bytes' отправленных байт
+    void consume_output(size_t bytes);
+
+    // количество запросов конвейера, для которых еще нет ответа
+    size_t in_flight() const noexcept;
+
+    bool has_ready_output() const noexcept {
+        return !pending.empty() && pending.front().ready;
+    }
+
+    bool pipeline_full(const ReactorOptions& options) const noexcept {
+        return pending.size() >= options.pipeline_max_depth;
+    }
+
+    // все ответы отправлены и новых запросов не будет
+    bool is_finished() const noexcept {
+        return pending.empty() && input_closed;
+    }
+
+    // соединение ничего не ждет от клиента и ничего ему не отправляет
+    bool is_idle() const noexcept {
+        return pending.empty() && in_off == in.size();
+    }
+};
+
+// выполняет обработчик в потоке пула: 'done' вызывается, когда ответ 'res'
+// готов - обработчиком, либо здесь же с ответом 500, если обработчик выбросил исключение
+void run_request(const RequestHandler& handler,
+                 httplib::Request& req,
+                 httplib::Response& res,
+                 std::chrono::steady_clock::time_point received,
+                 const RequestDone& done);
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <httplib.h>
+
+namespace SocialNetwork {
+
+namespace Http {
+
+// проверка запроса сразу после разбора заголовков, до приема тела.
+// false - запрос отклонен, ответ на него заполнен в 'res'
+using HeadersHandler = std::function<bool(const httplib::Request& req, httplib::Response& res)>;
+
+//
+// инкрементальный разборщик HTTP/1.x запросов.
+// данные подаются порциями (как пришли из сокета), разборщик сам помнит
+// на каком этапе он находится. результат разбора - заполненный
+// httplib::Request, чтобы обработчики App работали с ним без изменений
+//
+class HttpRequestParser
+{
+public:
+    enum class State {
+        HEADERS,    // ожидаем окончания стартовой строки и заголовков
+        BODY,       // заголовки разобраны, ожидаем тело запроса
+        COMPLETE,   // запрос полностью разобран
+        REJECTED,   // запрос отклонен после заголовков, тело не принимается, см. rejection()
+        FAILED      // запрос некорректен, см. failed_status()
+    };
+
+    ~HttpRequestParser() = default;
+    HttpRequestParser() = delete;
+    HttpRequestParser(const HttpRequestParser&) = delete;
+    HttpRequestParser(HttpRequestParser&&) = default;
+    HttpRequestParser& operator=(const HttpRequestParser&) = delete;
+    HttpRequestParser& operator=(HttpRequestParser&&) = default;
+
+    explicit HttpRequestParser(size_t headers_max_length,
+                               size_t payload_max_length,
+                               HeadersHandler on_headers = {})
+    :   headers_max_length_(headers_max_length),
+        payload_max_length_(payload_max_length),
+        on_headers_(std::move(on_headers)) {}
+
+    // разбирает очередную порцию данных, возвращает сколько байт из 'data'
+    // было потреблено. непотребленные байты нужно подать повторно вместе
+    // со следующей порцией (это возможно только на этапе HEADERS)
+    size_t parse(std::string_view data);
+
+    State state() const noexcept { return state_; }
+    bool is_complete() const noexcept { return state_ == State::COMPLETE; }
+    bool is_rejected() const noexcept { return state_ == State::REJECTED; }
+    bool is_failed() const noexcept { return state_ == State::FAILED; }
+    int  failed_status() const noexcept { return failed_status_; }
+
+    // ответ на отклоненный запрос
+    const httplib::Response& rejection() const noexcept { return rejection_; }
+
+    // соединение должно оставаться открытым после ответа на этот запрос
+    bool keep_alive() const noexcept { return keep_alive_; }
+
+    httplib::Request& request() noexcept { return req_; }
+
+    // забирает разобранный запрос и возвращает разборщик в начальное состояние
+    httplib::Request take_request();
+    void reset();
+
+private:
+    const size_t headers_max_length_{0};
+    const size_t payload_max_length_{0};
+    HeadersHandler on_headers_{};
+
+    State            state_{State::HEADERS};
+    int              failed_status_{0};
+    bool             keep_alive_{true};
+    size_t           scanned_{0};         // сколько байт заголовков уже просмотрено
+    size_t           body_expected_{0};
+    httplib::Request req_{};
+    httplib::Response rejection_{};
+
+    bool parse_headers_(std::string_view head);
+    bool parse_body_length_();
+    bool parse_request_line_(std::string_view line);
+    void fail_(int status);
+};
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <httplib.h>
+
+namespace SocialNetwork {
+
+namespace Http {
+
+// сериализует ответ на запрос 'req' в конец буфера 'out'.
+// заголовки Content-Length и Connection проставляются здесь,
+// остальные заголовки берутся из 'res' как есть
+void write_response(const httplib::Request& req,
+                    const httplib::Response& res,
+                    bool keep_alive,
+                    std::string& out);
+
+// короткий ответ без тела, когда до обработчиков дело не дошло
+// (запрос не разобран, очередь переполнена и т.п.). соединение закрывается
+void write_error_response(int status, std::string& out);
+
+// 503 с Retry-After на запрос, отброшенный до обработчика из-за перегрузки пула потоков
+void write_overload_response(const httplib::Request& req, int retry_after_sec, bool keep_alive, std::string& out);
+
+} // namespace Http
+
+} // namespace SocialNetwork
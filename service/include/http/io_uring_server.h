@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "http/connection_manager.h"
+#include "http/reactor_server.h"
+#include "http/worker_lanes.h"
+#include "logger/logger.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+//
+// HTTP/1.1 сервер на io_uring (ядро 6.0+, сборка с liburing).
+// каждый reactor-поток имеет свое кольцо и свой слушающий сокет (SO_REUSEPORT):
+//  - соединения принимаются одним multishot accept
+//  - данные читаются multishot recv в буферы из provided buffer ring
+//  - ответы отправляются send, связанным (IOSQE_IO_LINK) с таймаутом записи
+// если сервис собран без liburing, либо ядро не поддерживает нужные операции,
+// is_supported() возвращает false и нужно использовать другой режим
+//
+class IoUringServer final : public ReactorServer
+{
+public:
+    ~IoUringServer() override;
+    IoUringServer() = delete;
+    IoUringServer(const IoUringServer&) = delete;
+    IoUringServer(IoUringServer&&) = delete;
+    IoUringServer& operator=(const IoUringServer&) = delete;
+    IoUringServer& operator=(IoUringServer&&) = delete;
+
+    explicit IoUringServer(std::shared_ptr<Logging::Logger> logger,
+                           const ReactorOptions& options,
+                           RequestHandler handler);
+
+    static bool is_supported();
+
+    bool bind_to_port(const NetHelpers::SocketAddress& addr) override;
+    bool start() override;
+    void stop() override;
+    bool is_running() const override { return running_ && !failed_; }
+
+private:
+    class Reactor;
+
+    std::shared_ptr<Logging::Logger> logger_{nullptr};
+    const ReactorOptions             options_{};
+    RequestHandler                   handler_{};
+    WorkerLanes                      lanes_;
+    ConnectionManager                conn_manager_;
+
+    std::unique_ptr<NetHelpers::SocketAddress>  addr_{nullptr};
+    int                                         listen_fd_{-1};
+    std::atomic<bool>                           running_{false};
+    std::atomic<bool>                           failed_{false};     // reactor завершился с ошибкой
+    std::vector<std::unique_ptr<Reactor>>       reactors_{};
+};
+
+} // namespace Http
+
+} // namespace SocialNetwork
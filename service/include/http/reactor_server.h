@@ -0,0 +1,125 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <functional>
+#include <vector>
+#include <httplib.h>
+#include "helpers/socket_address.h"
+#include "http/http_parser.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+// ответ готов: вызывается обработчиком запроса один раз, в любом потоке
+using RequestDone = std::function<void()>;
+
+// обработчик полностью разобранного запроса, начинает выполняться в пуле потоков.
+// 'received' - когда запрос был принят, до ожидания в очереди пула. обработчик
+// может закончить запрос позже, в другом потоке (сопрограмма ждет БД): ответ
+// отправляется после вызова 'done', а исключение до вызова 'done' дает 500
+using RequestHandler = std::function<void(httplib::Request&, httplib::Response&,
+                                          std::chrono::steady_clock::time_point received, RequestDone done)>;
+
+// почему сервер сам закрыл соединение
+enum class ReapReason : uint8_t {
+    IDLE_TIMEOUT,   // между запросами прошло больше keep_alive_timeout_sec
+    READ_TIMEOUT,   // начатый запрос не принят целиком за read_timeout_sec
+    SATURATED       // пул потоков перегружен, простаивающее соединение закрыто досрочно
+};
+
+// дорожка (lane) - отдельный пул потоков для группы маршрутов со своей очередью
+// и своим отбором запросов, чтобы дорогие по CPU обработчики не занимали потоки,
+// нужные быстрым запросам к БД
+struct LaneOptions {
+    std::string name{"default"};            // метка lane для метрик
+    size_t      threads_count{1};
+    size_t      threads_max_count{0};           // эластичный пул: до стольких потоков под нагрузкой, 0 - фиксированный
+    time_t      threads_idle_timeout_ms{30000}; // эластичный пул: поток без задач дольше завершается
+    size_t      queue_capacity{1};
+    time_t      queue_target_delay_ms{0};   // CoDel: допустимое ожидание запроса в очереди пула, 0 - не отбрасывать
+    time_t      queue_interval_ms{500};     // CoDel: сколько ожидание может быть выше допустимого
+    std::vector<unsigned> cpus{};           // ядра потоков пула (CpuTopology::placement), пустой - не закреплять
+    size_t      cpus_limit{0};              // эластичный пул: не больше стольких готовых выполняться потоков, 0 - ядра процесса
+};
+
+struct ReactorOptions {
+    std::string name{"HttpSrv"};
+    size_t      reactors_count{1};
+    size_t      keep_alive_max_count{2};
+    time_t      keep_alive_timeout_sec{10};
+    size_t      max_connections_per_ip{0};          // 0 - без ограничения
+    time_t      saturated_idle_timeout_ms{500};     // при перегрузке пула простаивающее дольше соединение закрывается
+    time_t      read_timeout_sec{5};
+    size_t      headers_max_length{16 * 1024};
+    size_t      payload_max_length{1 * 1024 * 1024};
+    size_t      pipeline_max_depth{1};    // запросов одного соединения, обрабатываемых одновременно
+    std::vector<unsigned> reactor_cpus{}; // ядра reactor-потоков по номеру потока, пустой - не закреплять
+
+    // пулы потоков, в которых выполняются запросы, и выбор пула для запроса:
+    // lane_of() выполняется в reactor-потоке для разобранного запроса и возвращает
+    // индекс в lanes. без lane_of() все запросы идут в первую дорожку
+    std::vector<LaneOptions>                            lanes{LaneOptions{}};
+    std::function<size_t(const httplib::Request&)>      lane_of{};
+
+    // выполняется в reactor-потоке после приема заголовков. ответ на отклоненный
+    // запрос отправляется без приема тела, после чего соединение закрывается
+    HeadersHandler on_headers{};
+
+    // уведомления для метрик, вызываются из reactor-потоков
+    std::function<void(size_t)> on_pipeline_depth{};  // запрос передан в пул, аргумент - глубина конвейера соединения
+    std::function<void(int)>    on_inflight{};        // изменилось количество запросов в пуле (+1/-1)
+    std::function<void()>       on_pipeline_stall{};  // разбор остановлен, т.к. достигнут pipeline_max_depth
+
+    std::function<void(int)>        on_open_connections{};  // изменилось количество открытых соединений
+    std::function<void(int)>        on_idle_connections{};  // изменилось количество простаивающих соединений
+    std::function<void(ReapReason)> on_reaped{};            // сервер закрыл соединение
+    std::function<void()>           on_rejected{};          // соединение не принято из-за max_connections_per_ip
+
+    // вызываются из потоков пула, первый аргумент - индекс дорожки
+    std::function<void(size_t, double)> on_queue_sojourn{};   // запрос извлечен из очереди, аргумент - ожидание в секундах
+    std::function<void(size_t)>         on_shed{};            // запрос отброшен из-за ожидания в очереди (ответ 503)
+    std::function<void(size_t, double)> on_lane_task{};       // запрос выполнен, аргумент - время выполнения в секундах
+    // вызывается из reactor-потоков и потоков пула
+    std::function<void(size_t, int)>    on_lane_queue{};      // изменилось количество запросов в очереди дорожки
+    std::function<void(size_t, int)>    on_lane_threads{};    // изменилось количество потоков эластичного пула дорожки
+
+    void notify_pipeline_depth(size_t depth) const  { if (on_pipeline_depth) on_pipeline_depth(depth); }
+    void notify_inflight(int delta) const           { if (on_inflight) on_inflight(delta); }
+    void notify_pipeline_stall() const              { if (on_pipeline_stall) on_pipeline_stall(); }
+    void notify_open_connections(int delta) const   { if (on_open_connections) on_open_connections(delta); }
+    void notify_idle_connections(int delta) const   { if (on_idle_connections) on_idle_connections(delta); }
+    void notify_reaped(ReapReason reason) const     { if (on_reaped) on_reaped(reason); }
+    void notify_rejected() const                    { if (on_rejected) on_rejected(); }
+    void notify_queue_sojourn(size_t lane, double seconds) const { if (on_queue_sojourn) on_queue_sojourn(lane, seconds); }
+    void notify_shed(size_t lane) const                          { if (on_shed) on_shed(lane); }
+    void notify_lane_task(size_t lane, double seconds) const     { if (on_lane_task) on_lane_task(lane, seconds); }
+    void notify_lane_queue(size_t lane, int delta) const         { if (on_lane_queue) on_lane_queue(lane, delta); }
+    void notify_lane_threads(size_t lane, int delta) const       { if (on_lane_threads) on_lane_threads(lane, delta); }
+};
+
+//
+// базовый класс для HTTP-серверов, построенных по схеме reactor:
+// небольшое количество потоков владеет всеми сокетами и разбирает запросы,
+// а в пул потоков уходят только полностью принятые запросы
+//
+class ReactorServer
+{
+public:
+    virtual ~ReactorServer() = default;
+
+    virtual bool bind_to_port(const NetHelpers::SocketAddress& addr) = 0;
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    virtual bool is_running() const = 0;
+};
+
+// создает неблокирующий сокет в состоянии LISTENING
+// (с включенными SO_REUSEADDR и SO_REUSEPORT), либо -1 в случае ошибки
+int open_listening_socket(const NetHelpers::SocketAddress& addr, int backlog);
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "http/compression.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+//
+// кэш готовых ответов с общим для всех записей временем жизни. вместе с
+// телом хранятся его сжатые варианты (EncodedBody), поэтому частый запрос
+// сжимается один раз на кодировку, а не на каждый ответ.
+// записи разделены на сегменты со своими мьютексами, чтобы потоки пула реже
+// ждали друг друга. при переполнении вытесняются самые старые записи - при
+// общем времени жизни это те, что истекли бы первыми
+//
+class ResponseCache
+{
+public:
+    using Entry = std::shared_ptr<const EncodedBody>;
+
+    ResponseCache() = delete;
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    ResponseCache(std::chrono::milliseconds ttl, size_t capacity)
+    :   ttl_(ttl),
+        shard_capacity_(capacity / shards_count + 1) {}
+
+    // nullptr - записи нет, или она устарела
+    Entry find(const std::string& key);
+
+    void insert(std::string key, Entry entry);
+
+private:
+    using clock_t = std::chrono::steady_clock;
+
+    static constexpr size_t shards_count = 16;
+
+    struct item_s {
+        Entry               entry{};
+        clock_t::time_point expires{};
+    };
+
+    struct shard_s {
+        std::mutex                                          mutex{};
+        std::unordered_map<std::string, item_s>             items{};
+        // порядок вставки для вытеснения; запись перезаписанного ключа
+        // остается в очереди и пропускается по несовпадению expires
+        std::deque<std::pair<std::string, clock_t::time_point>> order{};
+    };
+
+    shard_s& shard_(const std::string& key) noexcept {
+        return shards_[std::hash<std::string>{}(key) % shards_count];
+    }
+
+    const std::chrono::milliseconds     ttl_;
+    const size_t                        shard_capacity_;
+    std::array<shard_s, shards_count>   shards_{};
+};
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace SocialNetwork {
+
+namespace Http {
+
+//
+// таблица маршрутов, полностью построенная на этапе компиляции.
+//
+// маршрут - это метод, шаблон пути и произвольный обработчик (например,
+// указатель на метод класса) с меткой для метрик. шаблон - либо статический
+// путь ("/user/search"), либо путь с параметром в последнем сегменте
+// ("/user/get/:id").
+//
+// статические пути ищутся по совершенному хешу (seed подбирается при
+// компиляции так, чтобы у путей не было коллизий), пути с параметром -
+// сравнением префикса, их немного. для найденного пути сразу известны
+// все допустимые методы, что позволяет ответить 404 или 405 до приема
+// тела запроса
+//
+
+enum class Method : uint8_t {
+    GET,
+    HEAD,
+    POST,
+    PUT,
+    DELETE,
+    PATCH,
+    OPTIONS,
+    UNKNOWN
+};
+
+inline constexpr size_t methods_count = static_cast<size_t>(Method::UNKNOWN);
+
+constexpr Method to_method(std::string_view method) noexcept
+{
+    constexpr std::array<std::string_view, methods_count> names{
+        "GET", "HEAD", "POST", "PUT", "DELETE", "PATCH", "OPTIONS"
+    };
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == method) return static_cast<Method>(i);
+    }
+    return Method::UNKNOWN;
+}
+
+constexpr std::string_view to_string(Method method) noexcept
+{
+    constexpr std::array<std::string_view, methods_count + 1> names{
+        "GET", "HEAD", "POST", "PUT", "DELETE", "PATCH", "OPTIONS", ""
+    };
+    return names[static_cast<size_t>(method)];
+}
+
+template <typename Handler>
+struct Route
+{
+    Method           method{Method::UNKNOWN};
+    std::string_view pattern{};
+    Handler          handler{};
+    std::string_view metric{};  // метка endpoint для метрик, пустая - запросы не учитываются
+    uint32_t         timeout_ms{0};  // крайний срок обработки по умолчанию, 0 - без срока
+    uint8_t          lane{0};        // дорожка пула потоков (ReactorOptions::lanes)
+};
+
+template <typename Handler, size_t N>
+class Router
+{
+public:
+    struct Match {
+        const Route<Handler>* route{nullptr};   // маршрут для метода запроса
+        size_t                index{0};         // номер маршрута в таблице
+        uint32_t              allowed{0};       // маска допустимых для пути методов, 0 - путь неизвестен
+        std::string_view      param_name{};
+        std::string_view      param{};          // значение параметра пути (указывает в путь запроса)
+
+        constexpr bool path_found() const noexcept { return allowed != 0; }
+    };
+
+    constexpr explicit Router(const std::array<Route<Handler>, N>& routes)
+    :   routes_(routes)
+    {
+        for (size_t i = 0; i < N; ++i) {
+            const auto& route = routes_[i];
+            if (route.method == Method::UNKNOWN
+            ||  route.pattern.empty()
+            ||  route.pattern.front() != '/') fail_("invalid route");
+
+            auto& path = path_for_(route.pattern);
+            const auto method = static_cast<size_t>(route.method);
+            if (path.routes[method]) fail_("duplicate route");
+            path.routes[method] = static_cast<uint8_t>(i + 1);
+            path.allowed |= 1u << method;
+        }
+
+        // подбираем seed совершенного хеша для статических путей
+        for (seed_ = 0; seed_ < max_seed; ++seed_) {
+            slots_.fill(0);
+            bool collision = false;
+            for (size_t i = 0; i < paths_count_ && !collision; ++i) {
+                if (paths_[i].param_name.size()) continue;
+                auto& slot = slots_[slot_(paths_[i].pattern)];
+                collision  = (slot != 0);
+                slot       = static_cast<uint8_t>(i + 1);
+            }
+            if (!collision) return;
+        }
+        fail_("perfect hash seed is not found");
+    }
+
+    constexpr Match match(std::string_view method, std::string_view path) const noexcept
+    {
+        Match result;
+
+        const path_s* found = nullptr;
+        if (auto slot = slots_[slot_(path)]; slot && paths_[slot - 1].pattern == path) {
+            found = &paths_[slot - 1];
+        } else {
+            for (size_t i = 0; i < paths_count_; ++i) {
+                const auto& one = paths_[i];
+                if (one.param_name.empty() || !path.starts_with(one.prefix)) continue;
+                auto param = path.substr(one.prefix.size());
+                if (param.empty() || param.find('/') != std::string_view::npos) continue;
+                found        = &one;
+                result.param = param;
+                break;
+            }
+        }
+        if (!found) return result;
+
+        result.allowed    = found->allowed;
+        result.param_name = found->param_name;
+
+        auto m = to_method(method);
+        if (m == Method::UNKNOWN) return result;
+        if (auto index = found->routes[static_cast<size_t>(m)]) {
+            result.index = index - 1u;
+            result.route = &routes_[result.index];
+        }
+        return result;
+    }
+
+    constexpr const std::array<Route<Handler>, N>& routes() const noexcept { return routes_; }
+
+    // значение заголовка Allow для маски методов
+    static std::string allow_header(uint32_t allowed)
+    {
+        std::string result;
+        for (size_t i = 0; i < methods_count; ++i) {
+            if (!(allowed & (1u << i))) continue;
+            if (!result.empty()) result.append(", ");
+            result.append(to_string(static_cast<Method>(i)));
+        }
+        return result;
+    }
+
+private:
+    static constexpr uint64_t max_seed    = 1u << 16;
+    static constexpr size_t   slots_count = std::bit_ceil(2 * N);
+
+    struct path_s {
+        std::string_view                     pattern{};
+        std::string_view                     prefix{};      // часть шаблона до параметра
+        std::string_view                     param_name{};  // пустое - статический путь
+        std::array<uint8_t, methods_count>   routes{};      // номер маршрута + 1 для каждого метода
+        uint32_t                             allowed{0};
+    };
+
+    std::array<Route<Handler>, N>     routes_{};
+    std::array<path_s, N>             paths_{};
+    size_t                            paths_count_{0};
+    std::array<uint8_t, slots_count>  slots_{};             // номер статического пути + 1, 0 - пусто
+    uint64_t                          seed_{0};
+
+    static_assert(N > 0 && N < 255, "route table size is out of range");
+
+    // при построении таблицы на этапе компиляции исключение - ошибка компиляции
+    static constexpr void fail_(const char* reason) { throw std::logic_error(reason); }
+
+    constexpr path_s& path_for_(std::string_view pattern)
+    {
+        for (size_t i = 0; i < paths_count_; ++i) {
+            if (paths_[i].pattern == pattern) return paths_[i];
+        }
+
+        auto& path   = paths_[paths_count_++];
+        path.pattern = pattern;
+        path.prefix  = pattern;
+        if (auto pos = pattern.find("/:"); pos != std::string_view::npos) {
+            path.prefix     = pattern.substr(0, pos + 1);
+            path.param_name = pattern.substr(pos + 2);
+            if (path.param_name.empty()
+            ||  path.param_name.find('/') != std::string_view::npos) fail_("parameter should be the last path segment");
+        }
+        return path;
+    }
+
+    // FNV-1a со смешанным с seed начальным значением
+    constexpr size_t slot_(std::string_view s) const noexcept
+    {
+        uint64_t hash = 0xcbf29ce484222325ull ^ (seed_ * 0x9e3779b97f4a7c15ull);
+        for (char ch : s) {
+            hash ^= static_cast<unsigned char>(ch);
+            hash *= 0x100000001b3ull;
+        }
+        return static_cast<size_t>(hash ^ (hash >> 32)) & (slots_count - 1);
+    }
+};
+
+} // namespace Http
+
+} // namespace SocialNetwork
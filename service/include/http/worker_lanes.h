@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <httplib.h>
+#include "helpers/codel.h"
+#include "helpers/thread_pool.h"
+#include "http/reactor_server.h"
+#include "logger/logger.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+//
+// пулы потоков reactor-сервера, по одному на дорожку (ReactorOptions::lanes).
+// у каждой дорожки свои потоки, очередь и отбор запросов по CoDel, поэтому
+// всплеск дорогих по CPU запросов задерживает только запросы своей дорожки,
+// а быстрые запросы к БД продолжают обслуживаться потоками другой
+//
+class WorkerLanes
+{
+public:
+    // выполняется в потоке пула дорожки. 'admitted' равен false, если запрос
+    // слишком долго ждал в очереди (CoDel), и вместо обработчика нужен 503
+    using Task = std::function<void(bool admitted)>;
+
+    WorkerLanes() = delete;
+    WorkerLanes(const WorkerLanes&) = delete;
+    WorkerLanes& operator=(const WorkerLanes&) = delete;
+
+    WorkerLanes(std::shared_ptr<Logging::Logger> logger, const ReactorOptions& options);
+
+    void start();   // создает пулы потоков дорожек
+    void stop();    // ждет незаконченные запросы и останавливает пулы
+
+    // дорожка для разобранного запроса, вызывается в reactor-потоке
+    size_t select(const httplib::Request& req) const;
+
+    // ставит задачу запроса, принятого в 'queued', в очередь дорожки 'lane'.
+    // false - очередь дорожки переполнена. принятый запрос продолжается в пуле
+    // дорожки и после задачи, пока не будет вызван finish()
+    bool submit(size_t lane, std::chrono::steady_clock::time_point queued, Task task);
+
+    // ответ на принятый запрос готов
+    void finish() noexcept { unfinished_.fetch_sub(1, std::memory_order_acq_rel); }
+
+    // значение для заголовка Retry-After запросу, отброшенному дорожкой 'lane'
+    int retry_after_sec(size_t lane) const noexcept { return lanes_[lane]->codel.retry_after_sec(); }
+
+    // в какой-либо дорожке все потоки заняты, и в очереди есть запросы
+    bool saturated() const noexcept;
+
+private:
+    struct lane_s {
+        explicit lane_s(const LaneOptions& opts)
+        :   options(opts),
+            codel(std::chrono::milliseconds(opts.queue_target_delay_ms),
+                  std::chrono::milliseconds(opts.queue_interval_ms)) {}
+
+        const LaneOptions    options;
+        ThreadHelpers::CoDel codel;
+        std::atomic<size_t>  in_pool{0};    // переданы в пул, задача не закончена (ожидание в сопрограмме - не в счет)
+        std::unique_ptr<ThreadHelpers::ThreadPool> pool{nullptr};
+    };
+
+    std::shared_ptr<Logging::Logger>     logger_{nullptr};
+    const ReactorOptions&                options_;
+    std::vector<std::unique_ptr<lane_s>> lanes_{};
+    std::atomic<size_t>                  unfinished_{0};    // приняты и еще не закончены (finish)
+};
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -6,6 +6,7 @@
 #include <mutex>
 #include <chrono>
 #include <iostream>
+#include "helpers/coarse_clock.h"
 #include "logger/logger_common.h"
 
 namespace SocialNetwork {
@@ -39,9 +40,9 @@ public:
 protected:
     LogLevel max_level_{LogLevel::LogError};
 
-    // возвращает форматированную строку вида
-    // 'yyyy-mm-dd hh:mm:ss.xxxxxx'
-    static std::string get_timestamp();
+    // возвращает форматированную метку вида
+    // 'yyyy-mm-dd hh:mm:ss.xxx' (см. TimeHelpers::CoarseClock)
+    static TimeHelpers::CoarseClock::LogTime get_timestamp();
     static std::tm* get_gmtime(const std::time_t* time, std::tm* tm);
 };
 
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <httplib.h>
+#include <sys/types.h>
+#include "configuration/configuration.h"
+#include "logger/logger.h"
+
+namespace SocialNetwork {
+
+//
+// супервизор pre-fork режима (--workers N, WORKERS_COUNT).
+// запускает N процессов-обработчиков (fork + exec того же исполняемого файла
+// с WORKER_ID в окружении), которые слушают один и тот же http_listening
+// через SO_REUSEPORT, перезапускает упавшие процессы и отдает на
+// prometheus_listening объединенные метрики всех обработчиков с меткой "worker"
+//
+class Supervisor
+{
+public:
+    ~Supervisor();
+    Supervisor() = delete;
+    Supervisor(const Supervisor&) = delete;
+    Supervisor(Supervisor&&) = delete;
+    Supervisor& operator=(const Supervisor&) = delete;
+    Supervisor& operator=(Supervisor&&) = delete;
+
+    explicit Supervisor(std::shared_ptr<cxxopts::ParseResult> cli_opts, int argc, char** argv);
+
+    // true - процесс должен работать супервизором, а не обработчиком
+    bool is_required() const noexcept;
+
+    void run();
+
+private:
+    struct worker_s {
+        int                                   id{0};
+        pid_t                                 pid{-1};
+        uint16_t                              metrics_port{0};
+        uint64_t                              restarts{0};
+        std::chrono::seconds                  restart_delay{1};
+        std::chrono::steady_clock::time_point started{};
+        std::chrono::steady_clock::time_point restart_at{};
+    };
+
+    std::shared_ptr<Logging::Logger> logger_{nullptr};
+    std::shared_ptr<Configuration>   conf_{nullptr};
+    std::vector<std::string>         args_{};
+
+    std::mutex            workers_mutex_{};
+    std::vector<worker_s> workers_{};
+
+    std::unique_ptr<httplib::Server> metrics_server_{nullptr};
+    std::thread                      metrics_server_thread_{};
+
+    void spawn_(worker_s& worker);
+    void reap_();
+    void restart_();
+    void stop_workers_();
+
+    void metrics_start_();
+    std::string metrics_collect_();
+};
+
+} // namespace SocialNetwork
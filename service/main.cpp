@@ -1,10 +1,20 @@
 #include "app.h"
+#include "supervisor.h"
 
 int main(int argc, char **argv)
 {
     auto cli_opts = SocialNetwork::configure_cli_options(argc, argv);
     if (!cli_opts) return EXIT_FAILURE;
 
+    {
+        // pre-fork режим: этот процесс только запускает обработчики
+        SocialNetwork::Supervisor supervisor(cli_opts, argc, argv);
+        if (supervisor.is_required()) {
+            supervisor.run();
+            return EXIT_SUCCESS;
+        }
+    }
+
     SocialNetwork::App app(cli_opts);
     app.run();
 
@@ -1,17 +1,36 @@
+#include <algorithm>
+#include <charconv>
 #include <chrono>
 #include <ctime>
 #include <iostream>
-#include <regex>
-#include <nlohmann/json.hpp>
-#include <bcrypt/BCrypt.hpp>
+#include "helpers/coarse_clock.h"
+#include "helpers/cpu_topology.h"
+#include "helpers/number_parser.h"
 #include "helpers/url.h"
+#include "helpers/uuid_pqxx.h"
 #include "helpers/ip_address.h"
 #include "helpers/socket_address.h"
 #include "helpers/thread.h"
+#include "http/epoll_server.h"
+#include "http/io_uring_server.h"
+#include "http/compression.h"
+#include "http/router.h"
 #include "app.h"
+#include "app_requests.h"
+#include "app_responses.h"
 
 namespace SocialNetwork {
 
+// сколько разных запросов поиска пользователей хранит кэш ответов
+static constexpr size_t search_cache_capacity = 4096;
+
+// сколько паролей может ждать хеширования: больше ожидающих все равно
+// не успеют к крайнему сроку входа или регистрации
+static constexpr size_t password_hasher_queue_capacity = 256;
+
+// для скольких пользователей кэш хранит проверенный пароль
+static constexpr size_t credential_cache_capacity = 65536;
+
 static void set_options_(socket_t sock)
 {
     httplib::detail::set_socket_opt(sock, SOL_SOCKET, SO_REUSEADDR, 1);
@@ -20,44 +39,105 @@ static void set_options_(socket_t sock)
 #endif
 }
 
-static std::string time_local_str_()
+// дата рождения YYYY-MM-DD: существующая дата с 1900 по 2007 год (18 лет)
+static bool is_valid_birthdate_(std::string_view date)
 {
-    auto p = std::chrono::system_clock::now();
-    auto t = std::chrono::system_clock::to_time_t(p);
+    if (date.size() != 10 || date[4] != '-' || date[7] != '-') return false;
+
+    auto number = [](std::string_view s, auto& value) {
+        auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+        return ec == std::errc{} && ptr == s.data() + s.size();
+    };
+    int      year  = 0;
+    unsigned month = 0;
+    unsigned day   = 0;
+    if (!number(date.substr(0, 4), year)
+    ||  !number(date.substr(5, 2), month)
+    ||  !number(date.substr(8, 2), day)) return false;
+
+    const std::chrono::year_month_day ymd{std::chrono::year{year}, std::chrono::month{month}, std::chrono::day{day}};
+    return ymd.ok() && year >= 1900 && year <= 2007;
+}
 
-    std::stringstream ss;
-    //                                       08/Apr/2025:12:06:54 +0000
-    ss << std::put_time(std::localtime(&t), "%d/%b/%Y:%H:%M:%S %z");
-    return ss.str();
+// крайний срок запроса: таймаут маршрута, либо меньший таймаут из заголовка
+// X-Request-Timeout (в миллисекундах), отсчитанный от момента приема запроса
+static Deadline request_deadline_(const httplib::Request& req,
+                                  uint32_t route_timeout_ms,
+                                  std::chrono::steady_clock::time_point received)
+{
+    uint32_t timeout_ms = route_timeout_ms;
+    if (req.has_header("X-Request-Timeout")) {
+        uint32_t value = 0;
+        if (NumberParserHelpers::try_parse_uint(req.get_header_value("X-Request-Timeout"), value)
+        &&  value > 0
+        &&  (timeout_ms == 0 || value < timeout_ms)) timeout_ms = value;
+    }
+    if (timeout_ms == 0) return Deadline{};
+    return Deadline{received + std::chrono::milliseconds(timeout_ms)};
 }
 
-static std::string time_gmt_str_()
+// тело ответа с ошибкой: {"code":...,"message":"..."}
+static std::string error_json_(int code, std::string_view message)
 {
-    auto p = std::chrono::system_clock::now();
-    auto t = std::chrono::system_clock::to_time_t(p);
-    std::tm gmt_tm;
-    gmtime_r(&t, &gmt_tm);
+    return JsonHelpers::to_json(error_response_s{code, message}, message.size() + 32);
+}
 
-    std::stringstream ss;
-    //                                       Sat, 01 Jan 2005 11:00:00 GMT
-    ss << std::put_time(std::localtime(&t), "%a, %d %b %Y %H:%M:%S GMT");
-    return ss.str();
+static std::optional<std::string_view> nullable_view_(const pqxx::field& field)
+{
+    if (field.is_null()) return std::nullopt;
+    return field.view();
 }
 
-static bool is_valid_uuid_(const std::string& id) {
-    static const std::regex uuid_regex(
-        "^[0-9a-fA-F]{8}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{4}-[0-9a-fA-F]{12}$"
-    );
-    return std::regex_match(id, uuid_regex);
+// оценка размера JSON-объекта для строки результата: данные полей,
+// ключи с кавычками и запас на экранирование
+static size_t response_size_hint_(const pqxx::row& row)
+{
+    size_t size = 128;
+    for (size_t i = 0; i < row.size(); ++i) size += row[i].size();
+    return size + size / 8;
 }
 
 //-----------------------------------------------------------------------------
 
+struct App::Routes
+{
+    // false - запрос завершился ошибкой (учитывается в метриках)
+    using Handler = ThreadHelpers::Task<bool> (App::*)(const httplib::Request&, httplib::Response&, const Deadline&);
+
+    // дорожки пула потоков (режимы epoll и io_uring): быстрые запросы к БД
+    // и дорогие по CPU (bcrypt), у каждой свои потоки и очередь
+    enum Lane : uint8_t { IO = 0, CPU = 1 };
+
+    static constexpr Http::Router<Handler, 6> router{{{
+        //  метод              шаблон пути        обработчик                    метка для метрик   крайний срок, мс  дорожка
+        {Http::Method::POST, "/login",         &App::login_handler,         "/login",          2000,            CPU},
+        {Http::Method::POST, "/user/register", &App::user_register_handler, "/user/register",  2000,            CPU},
+        {Http::Method::GET,  "/user/get/:id",  &App::user_get_id_handler,   "/user/get/:id",   1000,            IO},
+        {Http::Method::GET,  "/user/search",   &App::user_search_handler,   "/user/search",    3000,            IO},
+        {Http::Method::GET,  "/livez",         &App::liveness_handler,      {},                0,               IO},
+        {Http::Method::GET,  "/readyz",        &App::readiness_handler,     {},                0,               IO},
+    }}};
+
+    // метки lane для Metrics в порядке Lane
+    static std::vector<std::string_view> lane_labels() { return {"io", "cpu"}; }
+
+    // метки endpoint для Metrics в порядке таблицы
+    static std::vector<std::string_view> metric_labels()
+    {
+        std::vector<std::string_view> labels;
+        for (const auto& route : router.routes()) labels.push_back(route.metric);
+        return labels;
+    }
+};
+
+//-----------------------------------------------------------------------------
+
 
 
 App::~App()
 {
     if (http_server_) http_server_->stop();
+    if (reactor_server_) reactor_server_->stop();
     if (http_server_thread_.joinable()) {
         http_server_thread_.join();
     }
@@ -161,7 +241,27 @@ void App::db_start()
             replicas.push_back(std::make_pair(conn_str, tag));
         }
 
-        db_pool_ = std::make_shared<ConnectionPool>(masters, replicas, conf_->config().http_threads_count);
+        // с БД одновременно работают потоки обеих дорожек пула, эластичный
+        // пул - до наибольшего количества потоков
+        const auto io_threads = std::max(conf_->config().http_threads_count, conf_->config().http_threads_max_count);
+        auto connections = io_threads + conf_->config().http_cpu_threads_count;
+
+        // в режимах epoll и io_uring запросы к БД может выполнять отдельный пул,
+        // пока обработчики приостановлены: тогда с БД работают только его потоки.
+        // в очереди - не больше запросов, чем принимают дорожки пула запросов
+        const auto& mode = conf_->config().http_server_mode;
+        const bool reactor = (mode == "epoll") || (mode == "io_uring" && Http::IoUringServer::is_supported());
+        if (reactor && conf_->config().http_db_threads_count > 0) {
+            connections = conf_->config().http_db_threads_count;
+            const auto queue_capacity = io_threads + conf_->config().http_queue_capacity
+                                      + conf_->config().http_cpu_threads_count + conf_->config().http_cpu_queue_capacity;
+            db_executor_ = std::make_unique<ThreadHelpers::ThreadPool>("DbPool", logger_, connections, queue_capacity);
+            LOG_INFOR(std::format("{}: DB executor threads: {}", db_client_thread_name, connections));
+        }
+        db_pool_ = std::make_shared<ConnectionPool>(masters, replicas, connections);
+        query_canceller_ = std::make_unique<QueryCanceller>([this]() {
+            if (metrics_) metrics_->count_cancelled_query();
+        });
         if (db_pool_) {
             db_client_started = true;
 
@@ -192,145 +292,362 @@ void App::http_start()
 
     if (http_server_
     &&  http_server_->is_running()) return;
+    if (reactor_server_
+    &&  reactor_server_->is_running()) return;
 
     try {
         // регистрируем сервер для Prometheus-метрик
         exposer_ = std::make_unique<prometheus::Exposer>(conf_->config().prometheus_listening);
-        metrics_ = std::make_shared<Metrics>(db_host_tags);
+        metrics_ = std::make_shared<Metrics>(db_host_tags, Routes::metric_labels(), Routes::lane_labels());
         exposer_->RegisterCollectable(metrics_->registry());
+        exposer_->RegisterCollectable(metrics_->pools());
+
+        // процессы-обработчики супервизора делят ядра между собой, чтобы их
+        // закрепленные потоки не выполнялись на одних и тех же ядрах
+        const auto& system = ThreadHelpers::CpuTopology::system();
+        const auto topology = (conf_->config().worker_id >= 0)
+                            ? system.slice(conf_->config().worker_id, conf_->config().workers_count)
+                            : system;
+        const auto placement = [&topology](const std::string& affinity) {
+            return topology.placement(ThreadHelpers::Affinity::parse(affinity).value_or(ThreadHelpers::Affinity{}));
+        };
+        http_cpus_    = placement(conf_->config().http_threads_affinity);
+        reactor_cpus_ = placement(conf_->config().http_reactors_affinity);
+        auto bcrypt_cpus = placement(conf_->config().http_bcrypt_affinity);
+        LOG_INFOR(std::format("{}: cpus: {}, numa nodes: {}, pinned cpus: pool {}, reactors {}, bcrypt {}",
+            http_server_thread_name, topology.cpus().size(), system.nodes().size(),
+            http_cpus_.size(), reactor_cpus_.size(), bcrypt_cpus.size()));
+
+        // процессы-обработчики супервизора делят квоту ядер cgroup поровну: ей
+        // ограничены пул хеширования и рост эластичных пулов
+        cpus_share_ = ThreadHelpers::available_cpus();
+        if (conf_->config().worker_id >= 0) {
+            cpus_share_ = std::max<size_t>(cpus_share_ / static_cast<size_t>(std::max(conf_->config().workers_count, 1)), 1);
+        }
 
-        // регистрируем HTTP-сервер
-        http_server_ = std::make_unique<httplib::Server>();
-        if (!http_server_->is_valid()) throw std::runtime_error("server has an error...");
+        const auto hasher_threads = conf_->config().http_bcrypt_threads_count > 0
+                                  ? static_cast<size_t>(conf_->config().http_bcrypt_threads_count)
+                                  : cpus_share_;
+        password_hasher_ = std::make_unique<PasswordHasher>(logger_, hasher_threads, password_hasher_queue_capacity,
+                                                            std::move(bcrypt_cpus));
+        LOG_INFOR(std::format("{}: password hashing threads: {}", http_server_thread_name, hasher_threads));
+
+        // кэши читают и пишут потоки пула запросов: если они закреплены за ядрами
+        // нескольких узлов NUMA, у каждого узла свой экземпляр кэша в своей памяти
+        const auto cache_nodes = (system.nodes().size() > 1) ? system.nodes_of(http_cpus_) : std::vector<unsigned>{};
+        if (const auto ttl = conf_->config().http_credential_cache_ttl) {
+            credential_cache_ = std::make_unique<ThreadHelpers::NodeLocal<CredentialCache>>(
+                system, cache_nodes, std::chrono::milliseconds(ttl), credential_cache_capacity);
+        }
+        if (const auto ttl = conf_->config().http_search_cache_ttl) {
+            search_cache_ = std::make_unique<ThreadHelpers::NodeLocal<Http::ResponseCache>>(
+                system, cache_nodes, std::chrono::milliseconds(ttl), search_cache_capacity);
+        }
 
-        NetHelpers::SocketAddress sock_addr(conf_->config().http_listening);
-        http_server_->bind_to_port(sock_addr.host().to_string(), sock_addr.port());
+        const auto& mode = conf_->config().http_server_mode;
+        if (mode == "io_uring"
+        &&  !Http::IoUringServer::is_supported()) {
+            LOG_WARNG(std::format("{}: io_uring is not supported by kernel or build, fallback to httplib mode",
+                http_server_thread_name));
+            http_start_httplib(http_server_thread_name);
+        } else if (mode == "httplib") {
+            http_start_httplib(http_server_thread_name);
+        } else {
+            http_start_reactor(http_server_thread_name);
+        }
+    }
+    catch (std::exception& ex) {
+        LOG_ERROR(std::format("{} exception: {}", http_server_thread_name, ex.what()));
+    }
+}
 
-        LOG_INFOR(std::format("{} socket was configured into listening state: {}",
-            http_server_thread_name, sock_addr.to_string()));
+void App::http_start_httplib(const std::string& name)
+{
+    // регистрируем HTTP-сервер
+    http_server_ = std::make_unique<httplib::Server>();
+    if (!http_server_->is_valid()) throw std::runtime_error("server has an error...");
+
+    NetHelpers::SocketAddress sock_addr(conf_->config().http_listening);
+    http_server_->bind_to_port(sock_addr.host().to_string(), sock_addr.port());
+
+    LOG_INFOR(std::format("{} socket was configured into listening state: {}",
+        name, sock_addr.to_string()));
+
+    // устанавливаем наш ThreadPool для обработки очереди запросов
+    http_server_->new_task_queue = [this, name] {
+        ThreadHelpers::Elasticity elasticity;
+        elasticity.threads_max_count = conf_->config().http_threads_max_count;
+        elasticity.cpus_limit        = cpus_share_;
+        elasticity.idle_timeout      = std::chrono::milliseconds(conf_->config().http_threads_idle_timeout);
+        elasticity.on_resize         = [metrics = metrics_](int delta) { metrics->change_lane_threads(Routes::IO, delta); };
+        auto* queue = new ThreadPoolAdaptor(name + std::string("Pool"),
+                                            logger_,
+                                            conf_->config().http_threads_count,
+                                            conf_->config().http_queue_capacity,
+                                            metrics_,
+                                            std::chrono::milliseconds(conf_->config().http_queue_target_delay),
+                                            std::chrono::milliseconds(conf_->config().http_queue_interval),
+                                            std::move(elasticity),
+                                            http_cpus_);
+        http_task_queue_ = queue;
+        metrics_->set_lane_limits(Routes::IO, conf_->config().http_threads_count, conf_->config().http_queue_capacity);
+        return queue;
+    };
+
+                // Keep-Alive connection
+    http_server_->set_keep_alive_max_count(conf_->config().http_keep_alive_max_count)
+                .set_keep_alive_timeout(conf_->config().http_keep_alive_timeout)
+                // Timeouts
+                .set_read_timeout(5, 0)
+                .set_write_timeout(5, 0)
+                .set_idle_interval(0, 100'000/*usec*/)
+                // включаем SO_REUSEADDR и SO_REUSEPORT
+                .set_socket_options(set_options_)
+                // лимит размера тела запроса, защита от DDoS: 1 MB
+                .set_payload_max_length(1 * 1024 * 1024)
+                // обработчик ошибок
+                .set_error_handler([this](const auto& req, auto& res) { error_handler(req, res); })
+                // обработчик исключений
+                .set_exception_handler([this](const auto& req, auto& res, std::exception_ptr ep) { exception_handler(req, res, ep); })
+                // предварительная обработка (после приема запроса)
+                .set_pre_routing_handler([this](const auto& req, auto& res) {
+                    // соединение слишком долго ждало поток: 503 без обращения к обработчикам
+                    if (ThreadPoolAdaptor::take_shed()) {
+                        auto* queue = http_task_queue_.load();
+                        shed_handler(req, res, queue ? queue->retry_after_sec() : 1);
+                        return httplib::Server::HandlerResponse::Handled;
+                    }
+                    return (pre_routing_handler(req, res)) ? (httplib::Server::HandlerResponse::Unhandled) : (httplib::Server::HandlerResponse::Handled);
+                })
+                // окончательная обработка (перед отправкой ответа)
+                .set_post_routing_handler([this](const auto& req, auto& res) { post_routing_handler(req, res); })
+                // логирование запросов
+                .set_logger([this](const auto& req, const auto& res) { log_handler(req, res); });
+
+    // маршрутизация по таблице маршрутов: неизвестные пути и методы отклоняет
+    // pre_routing_handler (до приема тела), а все остальное попадает сюда.
+    // httplib передает в обработчик свой локальный Request, поэтому снять
+    // const для заполнения path_params безопасно
+    const auto handler = [this](const httplib::Request& req, httplib::Response& res) {
+        auto& request = const_cast<httplib::Request&>(req);
+        {
+            struct busy_s {
+                Metrics& metrics;
+                explicit busy_s(Metrics& m) : metrics(m) { metrics.change_idle_connections(-1); }
+                ~busy_s() { metrics.change_idle_connections(1); }
+            } busy(*metrics_);
+
+            if (!ThreadHelpers::sync_wait(route_handler(request, res, std::chrono::steady_clock::now()))) {
+                res.status = httplib::StatusCode::NotFound_404;
+            }
+        }
+        // все потоки пула заняты соединениями: после ответа соединение закрывается
+        // (httplib смотрит на заголовок Connection запроса), иначе в ожидании
+        // следующего запроса оно держало бы поток, нужный клиентам из очереди
+        auto* queue = http_task_queue_.load();
+        if (queue && queue->saturated()) {
+            request.headers.erase("Connection");
+            request.set_header("Connection", "close");
+            metrics_->count_reaped_connection(Http::ReapReason::SATURATED);
+        }
+    };
+    http_server_->Get(".*", handler);
+    http_server_->Post(".*", handler);
+
+    http_server_thread_ = std::thread([this]()->void {
+        ThreadHelpers::block_signals();
+        http_server_->listen_after_bind();
+    });
+    ThreadHelpers::set_name(http_server_thread_.native_handle(), name);
+}
 
-        // устанавливаем наш ThreadPool для обработки очереди запросов
-        http_server_->new_task_queue = [this] {
-            return new ThreadPoolAdaptor(http_server_thread_name + std::string("Pool"),
-                                         logger_,
-                                         conf_->config().http_threads_count,
-                                         conf_->config().http_queue_capacity);
-        };
+void App::http_start_reactor(const std::string& name)
+{
+    Http::ReactorOptions options;
+    options.name                   = name;
+    options.reactors_count         = conf_->config().http_reactors_count;
+    options.keep_alive_max_count   = conf_->config().http_keep_alive_max_count;
+    options.keep_alive_timeout_sec = conf_->config().http_keep_alive_timeout;
+    options.max_connections_per_ip = conf_->config().http_max_connections_per_ip;
+    options.read_timeout_sec       = 5;
+    options.payload_max_length     = 1 * 1024 * 1024;
+    options.pipeline_max_depth     = conf_->config().http_pipeline_max_depth;
+    options.reactor_cpus           = reactor_cpus_;
+
+    // дорожки в порядке Routes::Lane. без потоков для CPU-дорожки ее маршруты
+    // обслуживает IO-дорожка (WorkerLanes::select)
+    // эластичный пул только у IO-дорожки: ее потоки ждут БД, а потоки CPU-дорожки
+    // заняты процессором, и лишние потоки только отнимали бы его друг у друга
+    options.lanes = {{"io",
+                      static_cast<size_t>(conf_->config().http_threads_count),
+                      static_cast<size_t>(conf_->config().http_threads_max_count),
+                      conf_->config().http_threads_idle_timeout,
+                      static_cast<size_t>(conf_->config().http_queue_capacity),
+                      conf_->config().http_queue_target_delay,
+                      conf_->config().http_queue_interval,
+                      http_cpus_}};
+    options.lanes.front().cpus_limit = cpus_share_;
+    if (conf_->config().http_cpu_threads_count > 0) {
+        // потоки CPU-дорожки закрепляются за ядрами, следующими за ядрами IO-дорожки
+        auto cpu_lane_cpus = http_cpus_;
+        if (!cpu_lane_cpus.empty()) {
+            const auto io_threads = std::max(options.lanes.front().threads_count, options.lanes.front().threads_max_count);
+            std::rotate(cpu_lane_cpus.begin(), cpu_lane_cpus.begin() + io_threads % cpu_lane_cpus.size(), cpu_lane_cpus.end());
+        }
+        options.lanes.push_back({"cpu",
+                                 static_cast<size_t>(conf_->config().http_cpu_threads_count),
+                                 0,
+                                 0,
+                                 static_cast<size_t>(conf_->config().http_cpu_queue_capacity),
+                                 conf_->config().http_cpu_queue_target_delay,
+                                 conf_->config().http_cpu_queue_interval,
+                                 cpu_lane_cpus});
+    }
+    options.lane_of = [](const httplib::Request& req)->size_t {
+        const auto match = Routes::router.match(req.method, req.path);
+        return match.route ? match.route->lane : static_cast<size_t>(Routes::IO);
+    };
+
+    size_t inflight_limit = 0;
+    for (size_t lane = 0; lane < options.lanes.size(); ++lane) {
+        metrics_->set_lane_limits(lane, options.lanes[lane].threads_count, options.lanes[lane].queue_capacity);
+        inflight_limit += std::max(options.lanes[lane].threads_count, options.lanes[lane].threads_max_count)
+                        + options.lanes[lane].queue_capacity;
+    }
+    metrics_->set_pipeline_limits(conf_->config().http_pipeline_max_depth, static_cast<int>(inflight_limit));
+    options.on_pipeline_depth = [this](size_t depth) { metrics_->store_pipeline_depth(depth); };
+    options.on_inflight       = [this](int delta) { metrics_->change_inflight_requests(delta); };
+    options.on_pipeline_stall = [this]() { metrics_->count_pipeline_stall(); };
+    options.on_open_connections = [this](int delta) { metrics_->change_open_connections(delta); };
+    options.on_idle_connections = [this](int delta) { metrics_->change_idle_connections(delta); };
+    options.on_reaped           = [this](auto reason) { metrics_->count_reaped_connection(reason); };
+    options.on_rejected         = [this]() { metrics_->count_rejected_connection(); };
+    options.on_queue_sojourn    = [this](size_t lane, double seconds) { metrics_->store_queue_sojourn(lane, seconds); };
+    options.on_shed             = [this](size_t lane) { metrics_->count_shed_request(lane); };
+    options.on_lane_task        = [this](size_t lane, double seconds) { metrics_->store_lane_task(lane, seconds); };
+    options.on_lane_queue       = [this](size_t lane, int delta) { metrics_->change_lane_queue(lane, delta); };
+    options.on_lane_threads     = [this](size_t lane, int delta) { metrics_->change_lane_threads(lane, delta); };
+    // неизвестные пути и методы отклоняются до приема тела запроса
+    options.on_headers = [this](const auto& req, auto& res) {
+        if (pre_routing_handler(req, res)) return true;
+        error_handler(req, res);
+        post_routing_handler(req, res);
+        log_handler(req, res);
+        return false;
+    };
 
-                    // Keep-Alive connection
-        http_server_->set_keep_alive_max_count(2)
-                    .set_keep_alive_timeout(10)
-                    // Timeouts
-                    .set_read_timeout(5, 0)
-                    .set_write_timeout(5, 0)
-                    .set_idle_interval(0, 100'000/*usec*/)
-                    // включаем SO_REUSEADDR и SO_REUSEPORT
-                    .set_socket_options(set_options_)
-                    // лимит размера тела запроса, защита от DDoS: 1 MB
-                    .set_payload_max_length(1 * 1024 * 1024)
-                    // обработчик ошибок
-                    .set_error_handler([this](const auto& req, auto& res) { error_handler(req, res); })
-                    // обработчик исключений
-                    .set_exception_handler([this](const auto& req, auto& res, std::exception_ptr ep) { exception_handler(req, res, ep); })
-                    // предварительная обработка (после приема запроса)
-                    .set_pre_routing_handler([this](const auto& req, auto& res) { return (pre_routing_handler(req, res)) ? (httplib::Server::HandlerResponse::Unhandled) : (httplib::Server::HandlerResponse::Handled); })
-                    // окончательная обработка (перед отправкой ответа)
-                    .set_post_routing_handler([this](const auto& req, auto& res) { post_routing_handler(req, res); })
-                    // логирование запросов
-                    .set_logger([this](const auto& req, const auto& res) { log_handler(req, res); })
-                    // обработчики
-                    .Post("/login", [this](const auto& req, auto& res) {
-                        auto start = std::chrono::steady_clock::now();
-                        bool ok    = login_handler(req, res);
-                        auto end   = std::chrono::steady_clock::now();
-                        metrics_->count_request_login();
-                        if (!ok) metrics_->count_failed_request_login();
-                        if (ok)  metrics_->store_latency_request_login(std::chrono::duration<double>(end - start).count());
-                    })
-                    .Post("/user/register", [this](const auto& req, auto& res) {
-                        auto start = std::chrono::steady_clock::now();
-                        bool ok    = user_register_handler(req, res);
-                        auto end   = std::chrono::steady_clock::now();
-                        metrics_->count_request_user_register();
-                        if (!ok) metrics_->count_failed_request_user_register();
-                        if (ok)  metrics_->store_latency_request_user_register(std::chrono::duration<double>(end - start).count());
-                    })
-                    .Get("/user/get/:id", [this](const auto& req, auto& res) {
-                        auto start = std::chrono::steady_clock::now();
-                        bool ok    = user_get_id_handler(req, res);
-                        auto end   = std::chrono::steady_clock::now();
-                        metrics_->count_request_user_get_id();
-                        if (!ok) metrics_->count_failed_request_user_get_id();
-                        if (ok)  metrics_->store_latency_request_user_get_id(std::chrono::duration<double>(end - start).count());
-                    })
-                    .Get("/user/search", [this](const auto& req, auto& res) {
-                        auto start = std::chrono::steady_clock::now();
-                        bool ok    = user_search_handler(req, res);
-                        auto end   = std::chrono::steady_clock::now();
-                        metrics_->count_request_user_search();
-                        if (!ok) metrics_->count_failed_request_user_search();
-                        if (ok)  metrics_->store_latency_request_user_search(std::chrono::duration<double>(end - start).count());
-                    })
-                    .Get("/livez",  [this](const auto& req, auto& res) { liveness_handler(req, res); })
-                    .Get("/readyz", [this](const auto& req, auto& res) { readiness_handler(req, res); });
-
-        http_server_thread_ = std::thread([this]()->void {
-            ThreadHelpers::block_signals();
-            http_server_->listen_after_bind();
-        });
-        ThreadHelpers::set_name(http_server_thread_.native_handle(), http_server_thread_name);
+    auto handler = [this](auto& req, auto& res, auto received, auto done) { dispatch_handler(req, res, received, std::move(done)); };
+    if (conf_->config().http_server_mode == "io_uring") {
+        reactor_server_ = std::make_unique<Http::IoUringServer>(logger_, options, handler);
+    } else {
+        reactor_server_ = std::make_unique<Http::EpollServer>(logger_, options, handler);
     }
-    catch (std::exception& ex) {
-        LOG_ERROR(std::format("{} exception: {}", http_server_thread_name, ex.what()));
+
+    NetHelpers::SocketAddress sock_addr(conf_->config().http_listening);
+    if (!reactor_server_->bind_to_port(sock_addr)) {
+        throw std::runtime_error(std::format("cannot bind to {}", sock_addr.to_string()));
+    }
+
+    LOG_INFOR(std::format("{} socket was configured into listening state: {} (mode: {}, reactors: {})",
+        name, sock_addr.to_string(), conf_->config().http_server_mode, options.reactors_count));
+
+    if (!reactor_server_->start()) {
+        throw std::runtime_error(std::format("cannot start {} server", conf_->config().http_server_mode));
     }
 }
 
+void App::dispatch_handler(httplib::Request& req, httplib::Response& res, std::chrono::steady_clock::time_point received,
+                           Http::RequestDone done)
+{
+    // повторяет порядок обработки запроса в httplib::Server, чтобы
+    // обработчики работали одинаково в любом режиме HTTP-сервера.
+    // pre_routing_handler уже выполнен в reactor-потоке (on_headers).
+    // сопрограмма продолжается в пуле дорожки, ответ готов по вызову 'done'
+    auto route = [](App& app, httplib::Request& req, httplib::Response& res,
+                    std::chrono::steady_clock::time_point received) -> ThreadHelpers::Task<void> {
+        if (!co_await app.route_handler(req, res, received)) res.status = httplib::StatusCode::NotFound_404;
+        if (res.status == -1) res.status = httplib::StatusCode::OK_200;
+    };
+    ThreadHelpers::spawn(route(*this, req, res, received), [this, &req, &res, done = std::move(done)](std::exception_ptr ep) {
+        if (ep) exception_handler(req, res, std::move(ep));
+
+        if (res.status >= 400) error_handler(req, res);
+        post_routing_handler(req, res);
+        log_handler(req, res);
+        done();
+    });
+}
+
 bool App::pre_routing_handler(const httplib::Request& req, httplib::Response& res)
 {
-    if (req.path == "/livez"
-    ||  req.path == "/readyz"
-    ||  req.path == "/login"
-    ||  req.path == "/user/register"
-    ||  req.path.starts_with("/user/get/")
-    ||  req.path == "/user/search") {
-        return true;
+    const auto match = Routes::router.match(req.method, req.path);
+    if (match.route) return true;
+
+    if (match.path_found()) {
+        res.status = httplib::StatusCode::MethodNotAllowed_405;
+        res.set_header("Allow", Routes::router.allow_header(match.allowed));
+    } else {
+        res.status = httplib::StatusCode::NotFound_404;
     }
-    res.status = httplib::StatusCode::NotImplemented_501;
     return false;
 }
 
-bool App::login_handler(const httplib::Request& req, httplib::Response& res)
+ThreadHelpers::Task<bool> App::route_handler(httplib::Request& req, httplib::Response& res, std::chrono::steady_clock::time_point received)
 {
-    auto json = nlohmann::json::parse(req.body);
-    nlohmann::json response{};
+    const auto match = Routes::router.match(req.method, req.path);
+    if (!match.route) co_return false;
 
-    if (!json.contains("id")
-    ||  !json.contains("password")) {
-        LOG_ERROR(std::format("login_handler: request params does not contain 'id' and/or 'password'"));
-        res.status = httplib::StatusCode::BadRequest_400;
-        return false;
+    if (!match.param_name.empty()) {
+        req.path_params.emplace(match.param_name, match.param);
     }
 
-    if (!json["id"].is_string()
-    ||  !json["password"].is_string()) {
-        LOG_ERROR(std::format("login_handler: request params 'id' and 'password' should be a string"));
+    const auto deadline = request_deadline_(req, match.route->timeout_ms, received);
+    auto start = std::chrono::steady_clock::now();
+    bool ok    = false;
+    // запрос, дождавшийся потока после своего крайнего срока, отбрасывается:
+    // клиент ответ уже не ждет
+    if (!deadline.expired(start)) {
+        ok = co_await (this->*match.route->handler)(req, res, deadline);
+        if (ok) compress_response(req, res, match.index);
+    }
+    auto end   = std::chrono::steady_clock::now();
+    if (!ok && deadline.expired(end) && (res.status == -1 || res.status >= 500)) {
+        // ошибка из-за истекшего срока (в т.ч. statement_timeout или отмена запроса к БД)
+        res.status = httplib::StatusCode::ServiceUnavailable_503;
+        metrics_->count_expired_request(match.index);
+    }
+    metrics_->count_request(match.index);
+    if (!ok) metrics_->count_failed_request(match.index);
+    if (ok)  metrics_->store_latency_request(match.index, std::chrono::duration<double>(end - start).count());
+    co_return true;
+}
+
+ThreadHelpers::Task<bool> App::login_handler(const httplib::Request& req, httplib::Response& res, const Deadline& deadline)
+{
+    std::string response;
+
+    std::string scratch;
+    login_request_s request;
+    if (auto result = JsonHelpers::read_object(req.body, request, scratch); !result) {
+        LOG_ERROR(std::format("login_handler: {}", result.message()));
         res.status = httplib::StatusCode::BadRequest_400;
-        return false;
+        co_return false;
     }
 
-    if (!is_valid_uuid_(json["id"].get<std::string>())) {
+    const auto id = UuidHelpers::Uuid::parse(request.id);
+    if (!id) {
         LOG_ERROR(std::format("login_handler: request param 'id' is not an UUID format"));
         res.status = httplib::StatusCode::BadRequest_400;
-        return false;
+        co_return false;
     }
 
     if (!db_pool_) {
         LOG_ERROR(std::format("login_handler: there is no connection to DB"));
 
-        response = {{"code", 503}, {"message", "Server Error: login_handler: there is no connection to DB"}};
+        response = error_json_(503, "Server Error: login_handler: there is no connection to DB");
         res.status = httplib::StatusCode::ServiceUnavailable_503;
-        res.set_content(response.dump(), "application/json");
-        return false;
+        res.set_content(std::move(response), "application/json");
+        co_return false;
     }
 
     static const std::string query =
@@ -340,98 +657,90 @@ bool App::login_handler(const httplib::Request& req, httplib::Response& res)
 
     bool ok = false;
     try {
-        const std::string id{json["id"].get<std::string>()};
-        const std::string pwd{json["password"].get<std::string>()};
-
-        ScopedConnection scoped_conn(db_pool_, ConnectionPool::NodeType::REPLICA);
-        metrics_->count_request_to_host(scoped_conn.node_tag);
-        LOG_TRACE(std::format("login_handler: query to {} #{} tag='{}'",
-            (scoped_conn.node_type == ConnectionPool::NodeType::MASTER ? "MASTER" : "REPLICA"), scoped_conn.node_num, scoped_conn.node_tag));
+        std::string row_id;
+        std::string row_pwd_hash;
+        co_await ThreadHelpers::run_in(db_executor_.get(), [&]() {
+            ScopedConnection scoped_conn(db_pool_, ConnectionPool::NodeType::REPLICA);
+            metrics_->count_request_to_host(scoped_conn.node_tag);
+            LOG_TRACE(std::format("login_handler: query to {} #{} tag='{}'",
+                (scoped_conn.node_type == ConnectionPool::NodeType::MASTER ? "MASTER" : "REPLICA"), scoped_conn.node_num, scoped_conn.node_tag));
+
+            pqxx::work tx(*scoped_conn.conn.get());
+            DeadlineScope scoped_deadline(query_canceller_.get(), *scoped_conn.conn, tx, deadline);
+            pqxx::result result = tx.exec(query, pqxx::params{UuidHelpers::binary_param(*id)});
+            if (!result.empty()) {
+                row_id       = result[0][0].as<std::string>();
+                row_pwd_hash = result[0][1].as<std::string>();
+            }
+        });
 
-        pqxx::work tx(*scoped_conn.conn.get());
-        pqxx::result result = tx.exec(query, pqxx::params{id});
-        if (result.empty()) {
+        // соединение уже возвращено в пул: на время проверки пароля оно не нужно
+        if (row_id.empty()) {
             // пользователь не найден
             res.status = httplib::StatusCode::NotFound_404;
         } else {
-            for (const auto& row : result) {
-                const auto& [row_id, row_pwd_hash] = row.as<std::string, std::string>();
-                if (!BCrypt::validatePassword(pwd, row_pwd_hash)) {
+            // пароль, уже проверенный с тем же хешем, повторно bcrypt не проверяется
+            const bool cached = credential_cache_ && credential_cache_->local().verified(*id, request.password, row_pwd_hash);
+            if (credential_cache_) metrics_->count_credential_cache(cached);
+            if (!cached) {
+                if (!co_await password_hasher_->validate(std::string(request.password), row_pwd_hash, deadline)) {
                     // неверный пароль
                     LOG_ERROR(std::format("login_handler: request param 'password' is not match"));
                     res.status = httplib::StatusCode::BadRequest_400;
-                    return false;
+                    co_return false;
                 }
-                // успешная аутентификация
-                response = {{"token", row_id}};
-                break;
+                if (credential_cache_) credential_cache_->local().insert(*id, request.password, std::move(row_pwd_hash));
             }
+            // успешная аутентификация
+            response = JsonHelpers::to_json(login_response_s{row_id}, 64);
             ok = true;
         }
+    } catch (hasher_overloaded& ex) {
+        LOG_ERROR(std::format("login_handler: {}", ex.what()));
+
+        response = error_json_(503, std::format("Server Error: login_handler: {}", ex.what()));
+        res.status = httplib::StatusCode::ServiceUnavailable_503;
+    } catch (ThreadHelpers::task_refused& ex) {
+        LOG_ERROR(std::format("login_handler: DB executor: {}", ex.what()));
+
+        response = error_json_(503, std::format("Server Error: login_handler: {}", ex.what()));
+        res.status = httplib::StatusCode::ServiceUnavailable_503;
     } catch (std::exception& ex) {
         LOG_ERROR(std::format("SQL connection exception: {} (query: {})", ex.what(), query));
 
-        response = {{"code", 500}, {"message", std::format("Error SQL: {}", ex.what())}};
+        response = error_json_(500, std::format("Error SQL: {}", ex.what()));
         res.status = httplib::StatusCode::InternalServerError_500;
     }
 
-    res.set_content(response.dump(), "application/json");
-    return ok;
+    res.set_content(std::move(response), "application/json");
+    co_return ok;
 }
 
-bool App::user_register_handler(const httplib::Request& req, httplib::Response& res)
+ThreadHelpers::Task<bool> App::user_register_handler(const httplib::Request& req, httplib::Response& res, const Deadline& deadline)
 {
-    auto json = nlohmann::json::parse(req.body);
-    nlohmann::json response{};
-
-    if (!json.contains("password")
-    ||  !json.contains("first_name")
-    ||  !json.contains("second_name")
-    ||  !json.contains("birthdate")
-    ||  !json.contains("biography")
-    ||  !json.contains("city")) {
-        LOG_ERROR(std::format("login_handler: request params does not contain 'password', 'first_name', 'second_name', 'birthdate', 'biography' and/or 'city'"));
-        res.status = httplib::StatusCode::BadRequest_400;
-        return false;
-    }
+    std::string response;
 
-    if (!json["password"].is_string()
-    ||  !json["first_name"].is_string()
-    ||  !json["second_name"].is_string()
-    ||  !json["birthdate"].is_string()
-    ||  !json["biography"].is_string()
-    ||  !json["city"].is_string()) {
-        LOG_ERROR(std::format("user_register_handler: request params 'password', 'first_name', 'second_name', 'birthdate', 'biography' and 'city' should be a string"));
+    std::string scratch;
+    user_register_request_s request;
+    if (auto result = JsonHelpers::read_object(req.body, request, scratch); !result) {
+        LOG_ERROR(std::format("user_register_handler: {}", result.message()));
         res.status = httplib::StatusCode::BadRequest_400;
-        return false;
+        co_return false;
     }
 
-    if (json["password"].get<std::string>().length() < 8) {
-        // минимальная длина 8 символов
-        LOG_ERROR(std::format("user_register_handler: request param 'password' should contain at least 8 characters"));
+    if (!is_valid_birthdate_(request.birthdate)) {
+        LOG_ERROR(std::format("user_register_handler: request param 'birthdate' is invalid"));
         res.status = httplib::StatusCode::BadRequest_400;
-        return false;
-    }
-
-    {
-        std::tm t{};
-        std::istringstream ss(json["birthdate"].get<std::string>());
-        ss >> std::get_time(&t, "%Y-%m-%d"); // 2017-02-01
-        if (ss.fail() || t.tm_year < 0 || t.tm_year > 107) {
-            // 18лет (с 2007 г.д.), 2007 - 1900 = 107
-            LOG_ERROR(std::format("user_register_handler: request param 'birthdate' is invalid"));
-            res.status = httplib::StatusCode::BadRequest_400;
-            return false;
-        }
+        co_return false;
     }
 
     if (!db_pool_) {
         LOG_ERROR(std::format("user_register_handler: there is no connection to DB"));
 
-        response = {{"code", 503}, {"message", "Server Error: user_register_handler: there is no connection to DB"}};
+        response = error_json_(503, "Server Error: user_register_handler: there is no connection to DB");
         res.status = httplib::StatusCode::ServiceUnavailable_503;
-        res.set_content(response.dump(), "application/json");
-        return false;
+        res.set_content(std::move(response), "application/json");
+        co_return false;
     }
 
     static const std::string query =
@@ -441,68 +750,82 @@ bool App::user_register_handler(const httplib::Request& req, httplib::Response&
 
     bool ok = false;
     try {
-        const std::string pwd{json["password"].get<std::string>()};
-        const std::string fname{json["first_name"].get<std::string>()};
-        const std::string sname{json["second_name"].get<std::string>()};
-        const std::string bdate{json["birthdate"].get<std::string>()};
-        const std::string bio{json["biography"].get<std::string>()};
-        const std::string city{json["city"].get<std::string>()};
-        std::string hashed_pwd = BCrypt::generateHash(pwd, 12);
-
-        ScopedConnection scoped_conn(db_pool_, ConnectionPool::NodeType::MASTER);
-        metrics_->count_request_to_host(scoped_conn.node_tag);
-        LOG_TRACE(std::format("user_register_handler: query to {} #{} tag='{}'",
-            (scoped_conn.node_type == ConnectionPool::NodeType::MASTER ? "MASTER" : "REPLICA"), scoped_conn.node_num, scoped_conn.node_tag));
-
-        pqxx::work tx(*scoped_conn.conn.get());
-        pqxx::result result = tx.exec(query, pqxx::params{fname, sname, bdate, bio, city, hashed_pwd});
-        tx.commit();
+        // хеш считается до получения соединения, чтобы не держать его на время bcrypt
+        std::string hashed_pwd = co_await password_hasher_->hash(std::string(request.password), deadline);
+
+        pqxx::result result = co_await ThreadHelpers::run_in(db_executor_.get(), [&]() {
+            ScopedConnection scoped_conn(db_pool_, ConnectionPool::NodeType::MASTER);
+            metrics_->count_request_to_host(scoped_conn.node_tag);
+            LOG_TRACE(std::format("user_register_handler: query to {} #{} tag='{}'",
+                (scoped_conn.node_type == ConnectionPool::NodeType::MASTER ? "MASTER" : "REPLICA"), scoped_conn.node_num, scoped_conn.node_tag));
+
+            pqxx::work tx(*scoped_conn.conn.get());
+            DeadlineScope scoped_deadline(query_canceller_.get(), *scoped_conn.conn, tx, deadline);
+            pqxx::result result = tx.exec(query, pqxx::params{request.first_name,
+                                                                    request.second_name,
+                                                                    request.birthdate,
+                                                                    request.biography,
+                                                                    request.city,
+                                                                    hashed_pwd});
+            tx.commit();
+            return result;
+        });
         if (result.empty()) {
-            response = {{"code", 500}, {"message", std::format("Can't register user '{} {}'", fname, sname)}};
+            response = error_json_(500, std::format("Can't register user '{} {}'", request.first_name, request.second_name));
             res.status = httplib::StatusCode::InternalServerError_500;
         } else {
             for (const auto& row : result) {
-                const auto& [row_id] = row.as<std::string>();
                 // успешная регистрация
-                response = {{"user_id", row_id}};
+                response = JsonHelpers::to_json(user_register_response_s{row[0].view()}, 64);
                 break;
             }
             ok = true;
         }
+    } catch (hasher_overloaded& ex) {
+        LOG_ERROR(std::format("user_register_handler: {}", ex.what()));
+
+        response = error_json_(503, std::format("Server Error: user_register_handler: {}", ex.what()));
+        res.status = httplib::StatusCode::ServiceUnavailable_503;
+    } catch (ThreadHelpers::task_refused& ex) {
+        LOG_ERROR(std::format("user_register_handler: DB executor: {}", ex.what()));
+
+        response = error_json_(503, std::format("Server Error: user_register_handler: {}", ex.what()));
+        res.status = httplib::StatusCode::ServiceUnavailable_503;
     } catch (std::exception& ex) {
         LOG_ERROR(std::format("SQL connection exception: {} (query: {})", ex.what(), query));
 
-        response = {{"code", 500}, {"message", std::format("Error SQL: {}", ex.what())}};
+        response = error_json_(500, std::format("Error SQL: {}", ex.what()));
         res.status = httplib::StatusCode::InternalServerError_500;
     }
 
-    res.set_content(response.dump(), "application/json");
-    return ok;
+    res.set_content(std::move(response), "application/json");
+    co_return ok;
 }
 
-bool App::user_get_id_handler(const httplib::Request& req, httplib::Response& res)
+ThreadHelpers::Task<bool> App::user_get_id_handler(const httplib::Request& req, httplib::Response& res, const Deadline& deadline)
 {
-    nlohmann::json response{};
+    std::string response;
 
     if (!req.path_params.contains("id")) {
         LOG_ERROR(std::format("user_get_id_handler: request params does not contain 'id'"));
         res.status = httplib::StatusCode::BadRequest_400;
-        return false;
+        co_return false;
     }
 
-    if (!is_valid_uuid_(req.path_params.at("id"))) {
+    const auto id = UuidHelpers::Uuid::parse(req.path_params.at("id"));
+    if (!id) {
         LOG_ERROR(std::format("user_get_id_handler: request param 'id' is not an UUID format"));
         res.status = httplib::StatusCode::BadRequest_400;
-        return false;
+        co_return false;
     }
 
     if (!db_pool_) {
         LOG_ERROR(std::format("user_get_id_handler: there is no connection to DB"));
 
-        response = {{"code", 503}, {"message", "Server Error: user_get_id_handler: there is no connection to DB"}};
+        response = error_json_(503, "Server Error: user_get_id_handler: there is no connection to DB");
         res.status = httplib::StatusCode::ServiceUnavailable_503;
-        res.set_content(response.dump(), "application/json");
-        return false;
+        res.set_content(std::move(response), "application/json");
+        co_return false;
     }
 
     static const std::string query =
@@ -512,61 +835,68 @@ bool App::user_get_id_handler(const httplib::Request& req, httplib::Response& re
 
     bool ok = false;
     try {
-        const std::string id{req.path_params.at("id")};
-
-        ScopedConnection scoped_conn(db_pool_, ConnectionPool::NodeType::REPLICA);
-        metrics_->count_request_to_host(scoped_conn.node_tag);
-        LOG_TRACE(std::format("user_get_id_handler: query to {} #{} tag='{}'",
-            (scoped_conn.node_type == ConnectionPool::NodeType::MASTER ? "MASTER" : "REPLICA"), scoped_conn.node_num, scoped_conn.node_tag));
-
-        pqxx::work tx(*scoped_conn.conn.get());
-        pqxx::result result = tx.exec(query, pqxx::params{id});
+        pqxx::result result = co_await ThreadHelpers::run_in(db_executor_.get(), [&]() {
+            ScopedConnection scoped_conn(db_pool_, ConnectionPool::NodeType::REPLICA);
+            metrics_->count_request_to_host(scoped_conn.node_tag);
+            LOG_TRACE(std::format("user_get_id_handler: query to {} #{} tag='{}'",
+                (scoped_conn.node_type == ConnectionPool::NodeType::MASTER ? "MASTER" : "REPLICA"), scoped_conn.node_num, scoped_conn.node_tag));
+
+            pqxx::work tx(*scoped_conn.conn.get());
+            DeadlineScope scoped_deadline(query_canceller_.get(), *scoped_conn.conn, tx, deadline);
+            return tx.exec(query, pqxx::params{UuidHelpers::binary_param(*id)});
+        });
         if (result.empty()) {
             // анкета не найдена
             res.status = httplib::StatusCode::NotFound_404;
         } else {
             for (const auto& row : result) {
-                const auto& [row_fname, row_sname, row_bdate, row_bio, row_city] = row.as<std::string, std::string, std::string, std::string, std::string>();
                 // успешное получение анкеты пользователя
-                response = {{"id", id},
-                            {"first_name", row_fname},
-                            {"second_name", row_sname},
-                            {"birthdate", row_bdate},
-                            {"biography", row_bio},
-                            {"city", row_city}};
+                const auto id_chars = id->to_chars();
+                const user_response_s user{std::string_view(id_chars.data(), id_chars.size()),
+                                           row[0].view(),
+                                           row[1].view(),
+                                           nullable_view_(row[2]),
+                                           nullable_view_(row[3]),
+                                           nullable_view_(row[4])};
+                response = JsonHelpers::to_json(user, response_size_hint_(row));
                 break;
             }
             ok = true;
         }
+    } catch (ThreadHelpers::task_refused& ex) {
+        LOG_ERROR(std::format("user_get_id_handler: DB executor: {}", ex.what()));
+
+        response = error_json_(503, std::format("Server Error: user_get_id_handler: {}", ex.what()));
+        res.status = httplib::StatusCode::ServiceUnavailable_503;
     } catch (std::exception& ex) {
         LOG_ERROR(std::format("SQL connection exception: {} (query: {})", ex.what(), query));
 
-        response = {{"code", 500}, {"message", std::format("Error SQL: {}", ex.what())}};
+        response = error_json_(500, std::format("Error SQL: {}", ex.what()));
         res.status = httplib::StatusCode::InternalServerError_500;
     }
 
-    res.set_content(response.dump(), "application/json");
-    return ok;
+    res.set_content(std::move(response), "application/json");
+    co_return ok;
 }
 
-bool App::user_search_handler(const httplib::Request& req, httplib::Response& res)
+ThreadHelpers::Task<bool> App::user_search_handler(const httplib::Request& req, httplib::Response& res, const Deadline& deadline)
 {
-    nlohmann::json response = nlohmann::json::array({});
+    std::string response;
 
     if (!req.has_param("first_name")
     ||  !req.has_param("last_name")) {
         LOG_ERROR(std::format("user_search_handler: request params does not contain 'first_name' and/or 'last_name'"));
         res.status = httplib::StatusCode::BadRequest_400;
-        return false;
+        co_return false;
     }
 
     if (!db_pool_) {
         LOG_ERROR(std::format("user_search_handler: there is no connection to DB"));
 
-        response = {{"code", 503}, {"message", "Server Error: user_search_handler: there is no connection to DB"}};
+        response = error_json_(503, "Server Error: user_search_handler: there is no connection to DB");
         res.status = httplib::StatusCode::ServiceUnavailable_503;
-        res.set_content(response.dump(), "application/json");
-        return false;
+        res.set_content(std::move(response), "application/json");
+        co_return false;
     }
 
     static const std::string query =
@@ -576,42 +906,80 @@ bool App::user_search_handler(const httplib::Request& req, httplib::Response& re
         " ORDER BY id "
         " LIMIT 100";
 
+    // одинаковые запросы в пределах http_search_cache_ttl отдаются из кэша,
+    // вместе с уже сжатыми вариантами ответа
+    static constexpr auto route = Routes::router.match("GET", "/user/search").index;
+    std::string cache_key;
+    if (search_cache_) {
+        // параметры после URL-декодирования могут содержать любой разделитель:
+        // длина первого из них делает ключ однозначным
+        const auto first_name = req.get_param_value("first_name");
+        cache_key = std::format("{}:{}{}", first_name.size(), first_name, req.get_param_value("last_name"));
+        if (auto entry = search_cache_->local().find(cache_key)) {
+            set_encoded_content(req, res, route, *entry);
+            co_return true;
+        }
+    }
+
     bool ok = false;
     try {
         const std::string first_name{req.get_param_value("first_name") + "%"};
         const std::string second_name{req.get_param_value("last_name") + "%"};
 
-        ScopedConnection scoped_conn(db_pool_, ConnectionPool::NodeType::REPLICA);
-        metrics_->count_request_to_host(scoped_conn.node_tag);
-        LOG_TRACE(std::format("user_search_handler: query to {} #{} tag='{}'",
-            (scoped_conn.node_type == ConnectionPool::NodeType::MASTER ? "MASTER" : "REPLICA"), scoped_conn.node_num, scoped_conn.node_tag));
+        pqxx::result result = co_await ThreadHelpers::run_in(db_executor_.get(), [&]() {
+            ScopedConnection scoped_conn(db_pool_, ConnectionPool::NodeType::REPLICA);
+            metrics_->count_request_to_host(scoped_conn.node_tag);
+            LOG_TRACE(std::format("user_search_handler: query to {} #{} tag='{}'",
+                (scoped_conn.node_type == ConnectionPool::NodeType::MASTER ? "MASTER" : "REPLICA"), scoped_conn.node_num, scoped_conn.node_tag));
 
-        pqxx::work tx(*scoped_conn.conn.get());
-        pqxx::result result = tx.exec(query, pqxx::params{first_name, second_name});
-
-        for (const auto& row : result) {
-            const auto& [row_id, row_fname, row_sname, row_bdate, row_bio, row_city] = row.as<std::string, std::string, std::string, std::string, std::string, std::string>();
-            // собираем массив
-            response.push_back({{"id", row_id},
-                                {"first_name", row_fname},
-                                {"second_name", row_sname},
-                                {"birthdate", row_bdate},
-                                {"biography", row_bio},
-                                {"city", row_city}});
+            pqxx::work tx(*scoped_conn.conn.get());
+            DeadlineScope scoped_deadline(query_canceller_.get(), *scoped_conn.conn, tx, deadline);
+            return tx.exec(query, pqxx::params{first_name, second_name});
+        });
+
+        // собираем массив сразу в тело ответа
+        size_t size_hint = 2;
+        for (const auto& row : result) size_hint += response_size_hint_(row);
+        response.reserve(size_hint);
+
+        response.push_back('[');
+        for (bool first = true; const auto& row : result) {
+            if (!first) response.push_back(',');
+            first = false;
+            const user_response_s user{row[0].view(),
+                                       row[1].view(),
+                                       row[2].view(),
+                                       nullable_view_(row[3]),
+                                       nullable_view_(row[4]),
+                                       nullable_view_(row[5])};
+            JsonHelpers::write_value(response, user);
         }
+        response.push_back(']');
         ok = true;
+    } catch (ThreadHelpers::task_refused& ex) {
+        LOG_ERROR(std::format("user_search_handler: DB executor: {}", ex.what()));
+
+        response = error_json_(503, std::format("Server Error: user_search_handler: {}", ex.what()));
+        res.status = httplib::StatusCode::ServiceUnavailable_503;
     } catch (std::exception& ex) {
         LOG_ERROR(std::format("SQL connection exception: {} (query: {})", ex.what(), query));
 
-        response = {{"code", 500}, {"message", std::format("Error SQL: {}", ex.what())}};
+        response = error_json_(500, std::format("Error SQL: {}", ex.what()));
         res.status = httplib::StatusCode::InternalServerError_500;
     }
 
-    res.set_content(response.dump(), "application/json");
-    return ok;
+    if (ok && search_cache_) {
+        auto entry = std::make_shared<const Http::EncodedBody>(std::move(response), "application/json");
+        search_cache_->local().insert(std::move(cache_key), entry);
+        set_encoded_content(req, res, route, *entry);
+        co_return ok;
+    }
+
+    res.set_content(std::move(response), "application/json");
+    co_return ok;
 }
 
-void App::liveness_handler(const httplib::Request& /*req*/, httplib::Response& res)
+ThreadHelpers::Task<bool> App::liveness_handler(const httplib::Request& /*req*/, httplib::Response& res, const Deadline& /*deadline*/)
 {
     constexpr auto result_html = "{}\n";
     constexpr auto ok          = "ok";
@@ -623,10 +991,12 @@ void App::liveness_handler(const httplib::Request& /*req*/, httplib::Response& r
     } else {
         res.set_content(std::format(result_html, fail), "text/plain");
         res.status = httplib::StatusCode::InternalServerError_500;
+        co_return false;
     }
+    co_return true;
 }
 
-void App::readiness_handler(const httplib::Request& /*req*/, httplib::Response& res)
+ThreadHelpers::Task<bool> App::readiness_handler(const httplib::Request& /*req*/, httplib::Response& res, const Deadline& /*deadline*/)
 {
     constexpr auto result_html = "{}\n";
     constexpr auto ok          = "ok";
@@ -638,7 +1008,9 @@ void App::readiness_handler(const httplib::Request& /*req*/, httplib::Response&
     } else {
         res.set_content(std::format(result_html, fail), "text/plain");
         res.status = httplib::StatusCode::InternalServerError_500;
+        co_return false;
     }
+    co_return true;
 }
 
 void App::post_routing_handler(const httplib::Request& /*req*/, httplib::Response& res)
@@ -646,7 +1018,7 @@ void App::post_routing_handler(const httplib::Request& /*req*/, httplib::Respons
     static const std::string srv_name(std::string("social_network/1.0")
                                     + std::format(" (Linux) httplib/{}", CPPHTTPLIB_VERSION));
 
-    res.set_header("Date", time_gmt_str_());
+    res.set_header("Date", std::string(TimeHelpers::CoarseClock::http_date().view()));
     res.set_header("Server", srv_name);
     res.set_header("X-Content-Type-Options", "nosniff");
     res.set_header("X-Frame-Options", "DENY");
@@ -683,6 +1055,9 @@ void App::exception_handler(const httplib::Request& /*req*/, httplib::Response&
 
 void App::log_handler(const httplib::Request& req, const httplib::Response& res)
 {
+    // строка журнала собирается только если она будет записана
+    if (!logger_ || !logger_->available(Logging::LogLevel::LogTrace)) return;
+
     auto request         = std::format("{} {} {}", req.method, req.path, req.version);
     auto body_bytes_sent = res.get_header_value("Content-Length");
     auto http_user_agent = req.get_header_value("User-Agent", "-");
@@ -696,7 +1071,7 @@ void App::log_handler(const httplib::Request& req, const httplib::Response& res)
     // 127.0.0.1 - - [08/Apr/2025:12:07:01 +0000] "GET /livez HTTP/1.1" 200 3 "-" "curl/8.12.1"
     LOG_TRACE(std::format(log_html, req.remote_addr,
                                     /*remote_user=*/"-",
-                                    time_local_str_(),
+                                    TimeHelpers::CoarseClock::local_time().view(),
                                     request,
                                     res.status,
                                     body_bytes_sent,
@@ -704,6 +1079,64 @@ void App::log_handler(const httplib::Request& req, const httplib::Response& res)
                                     http_user_agent));
 }
 
+void App::shed_handler(const httplib::Request& /*req*/, httplib::Response& res, int retry_after_sec)
+{
+    // поток освобождается сразу после ответа, клиент повторит запрос позже
+    res.status = httplib::StatusCode::ServiceUnavailable_503;
+    res.set_header("Retry-After", std::to_string(retry_after_sec));
+    res.set_header("Connection", "close");
+    metrics_->count_shed_request(0);
+}
+
+void App::compress_response(const httplib::Request& req, httplib::Response& res, size_t route)
+{
+    // Vary уже выставлен, если обработчик сам выбрал кодировку ответа (set_encoded_content)
+    const auto min_size = static_cast<size_t>(conf_->config().http_compression_min_size);
+    if (!min_size
+    ||  res.body.size() < min_size
+    ||  res.has_header("Vary")) return;
+
+    res.set_header("Vary", "Accept-Encoding");
+    const auto encoding = Http::negotiate(req.get_header_value("Accept-Encoding"));
+    if (encoding == Http::Encoding::IDENTITY) return;
+
+    std::string encoded;
+    Http::CompressionStats stats;
+    if (!Http::compress(encoding, res.body, encoded, stats)) {
+        LOG_ERROR(std::format("compress_response: {} compression failed", Http::to_string(encoding)));
+        return;
+    }
+    metrics_->store_compression(route, stats.ratio(), stats.cpu_seconds);
+    if (encoded.size() >= res.body.size()) return;
+
+    res.body.swap(encoded);
+    res.set_header("Content-Encoding", std::string(Http::to_string(encoding)));
+}
+
+void App::set_encoded_content(const httplib::Request& req, httplib::Response& res, size_t route,
+                              const Http::EncodedBody& body)
+{
+    const auto min_size = static_cast<size_t>(conf_->config().http_compression_min_size);
+    if (!min_size
+    ||  body.plain().size() < min_size) {
+        res.set_content(body.plain(), body.content_type());
+        return;
+    }
+
+    res.set_header("Vary", "Accept-Encoding");
+    const auto encoding = Http::negotiate(req.get_header_value("Accept-Encoding"));
+    std::optional<Http::CompressionStats> stats;
+    const auto encoded = body.encoded(encoding, stats);
+    if (stats) metrics_->store_compression(route, stats->ratio(), stats->cpu_seconds);
+    if (!encoded) {
+        res.set_content(body.plain(), body.content_type());
+        return;
+    }
+
+    res.set_header("Content-Encoding", std::string(Http::to_string(encoding)));
+    res.set_content(*encoded, body.content_type());
+}
+
 void App::db_create_users_table()
 {
     static const std::string query =
@@ -0,0 +1,74 @@
+#include <stdexcept>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include "app_credential_cache.h"
+
+namespace SocialNetwork {
+
+CredentialCache::CredentialCache(std::chrono::milliseconds ttl, size_t capacity)
+:   ttl_(ttl),
+    shard_capacity_(capacity / shards_count + 1)
+{
+    if (RAND_bytes(secret_.data(), static_cast<int>(secret_.size())) != 1) {
+        throw std::runtime_error("cannot generate credential cache secret");
+    }
+}
+
+bool CredentialCache::verified(const UuidHelpers::Uuid& id, std::string_view password, std::string_view pwd_hash)
+{
+    const auto digest = digest_(id, password);
+    auto& shard = shard_(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.items.find(id);
+    if (it == shard.items.end()) return false;
+    if (it->second.expires <= clock_t::now()
+    ||  it->second.pwd_hash != pwd_hash) {
+        // запись устарела, или пароль сменился
+        shard.items.erase(it);
+        return false;
+    }
+    // сравнение за постоянное время, чтобы по времени ответа нельзя было подбирать HMAC
+    return CRYPTO_memcmp(it->second.digest.data(), digest.data(), digest.size()) == 0;
+}
+
+void CredentialCache::insert(const UuidHelpers::Uuid& id, std::string_view password, std::string pwd_hash)
+{
+    const auto digest  = digest_(id, password);
+    const auto now     = clock_t::now();
+    const auto expires = now + ttl_;
+    auto& shard = shard_(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // удаляем устаревшие записи и, если сегмент заполнен, самые старые
+    while (!shard.order.empty()
+       && (shard.order.front().second <= now || shard.items.size() >= shard_capacity_)) {
+        auto& [old_id, old_expires] = shard.order.front();
+        auto it = shard.items.find(old_id);
+        if (it != shard.items.end() && it->second.expires == old_expires) shard.items.erase(it);
+        shard.order.pop_front();
+    }
+
+    shard.order.emplace_back(id, expires);
+    shard.items.insert_or_assign(id, item_s{digest, std::move(pwd_hash), expires});
+}
+
+CredentialCache::digest_t CredentialCache::digest_(const UuidHelpers::Uuid& id, std::string_view password) const
+{
+    std::string message;
+    message.reserve(id.size() + password.size());
+    message.append(reinterpret_cast<const char*>(id.data()), id.size());
+    message.append(password);
+
+    digest_t digest{};
+    unsigned int length = 0;
+    if (!HMAC(EVP_sha256(), secret_.data(), static_cast<int>(secret_.size()),
+              reinterpret_cast<const unsigned char*>(message.data()), message.size(),
+              digest.data(), &length)
+    ||  length != digest.size()) throw std::runtime_error("cannot calculate HMAC");
+    return digest;
+}
+
+} // namespace SocialNetwork
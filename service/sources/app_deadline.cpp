@@ -0,0 +1,99 @@
+#include <format>
+#include "helpers/thread.h"
+#include "app_deadline.h"
+
+namespace SocialNetwork {
+
+QueryCanceller::QueryCanceller(OnCancelFunc on_cancel)
+:   on_cancel_(std::move(on_cancel))
+{
+    thread_ = std::thread(&QueryCanceller::run_, this);
+    ThreadHelpers::set_name(thread_.native_handle(), "QueryCancel");
+}
+
+QueryCanceller::~QueryCanceller()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_one();
+    thread_.join();
+}
+
+void QueryCanceller::watch_(entry_s& entry, Deadline::clock_t::time_point at)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry.it = entries_.emplace(at, &entry);
+    // поток ждет ближайший срок, будим его, только если новый срок раньше
+    if (entry.it == entries_.begin()) condition_.notify_one();
+}
+
+void QueryCanceller::unwatch_(entry_s& entry)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!entry.cancelled) {
+        entries_.erase(entry.it);
+        return;
+    }
+    // отмена этого соединения уже началась: ждем ее окончания, чтобы она не
+    // попала в запрос, который соединение выполнит после возврата в пул
+    cancel_done_.wait(lock, [&entry]() { return !entry.cancelling; });
+}
+
+void QueryCanceller::run_()
+{
+    ThreadHelpers::block_signals();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        if (entries_.empty()) {
+            condition_.wait(lock);
+            continue;
+        }
+        const auto at = entries_.begin()->first;
+        if (Deadline::clock_t::now() < at) {
+            condition_.wait_until(lock, at);
+            continue;
+        }
+
+        auto* entry = entries_.begin()->second;
+        entries_.erase(entries_.begin());
+        entry->cancelled  = true;
+        entry->cancelling = true;
+        // PQcancel открывает новое соединение с сервером БД и ждет ответа:
+        // без мьютекса, чтобы не задерживать watch_() и unwatch_() других запросов
+        lock.unlock();
+        try {
+            entry->conn->cancel_query();
+            if (on_cancel_) on_cancel_();
+        }
+        catch (...) {
+            // соединение могло уже закрыться, запрос все равно закончится
+        }
+        lock.lock();
+        entry->cancelling = false;
+        cancel_done_.notify_all();
+    }
+}
+
+DeadlineScope::DeadlineScope(QueryCanceller* canceller, pqxx::connection& conn, pqxx::work& tx, const Deadline& deadline)
+{
+    if (!deadline.is_set()) return;
+
+    const auto remaining = deadline.remaining();
+    if (remaining.count() == 0) throw deadline_exceeded("request deadline exceeded");
+
+    tx.exec(std::format("SET LOCAL statement_timeout = {}", remaining.count())).no_rows();
+    if (canceller) {
+        canceller_   = canceller;
+        entry_.conn  = &conn;
+        canceller->watch_(entry_, deadline.at());
+    }
+}
+
+DeadlineScope::~DeadlineScope()
+{
+    if (canceller_) canceller_->unwatch_(entry_);
+}
+
+} // namespace SocialNetwork
@@ -0,0 +1,56 @@
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <bcrypt/BCrypt.hpp>
+#include "app_password_hasher.h"
+
+namespace SocialNetwork {
+
+PasswordHasher::PasswordHasher(std::shared_ptr<Logging::Logger> logger, size_t threads_count, size_t queue_capacity,
+                               std::vector<unsigned> cpus)
+:   pool_("BCryptPool", std::move(logger), threads_count, queue_capacity,
+          ThreadHelpers::Scheduling::SharedQueue, {}, std::move(cpus))
+{
+}
+
+ThreadHelpers::Task<std::string> PasswordHasher::hash(std::string password, Deadline deadline)
+{
+    co_return co_await run_([pwd = std::move(password)]() {
+        return BCrypt::generateHash(pwd, cost_);
+    }, deadline);
+}
+
+ThreadHelpers::Task<bool> PasswordHasher::validate(std::string password, std::string hash, Deadline deadline)
+{
+    co_return co_await run_([pwd = std::move(password), pwd_hash = std::move(hash)]() {
+        return BCrypt::validatePassword(pwd, pwd_hash);
+    }, deadline);
+}
+
+template<typename Func>
+auto PasswordHasher::run_(Func func, Deadline deadline) -> ThreadHelpers::Task<decltype(func())>
+{
+    using result_t = decltype(func());
+
+    auto abandoned = std::make_shared<std::atomic<bool>>(false);
+    auto result = pool_.submit([abandoned, func = std::move(func)]() -> result_t {
+        // запрос уже ответил по крайнему сроку, считать незачем
+        if (abandoned->load(std::memory_order_relaxed)) return {};
+        return func();
+    });
+
+    std::optional<result_t> value;
+    try {
+        value = co_await ThreadHelpers::with_deadline(std::move(result), deadline.at());
+    }
+    catch (ThreadHelpers::task_refused&) {
+        throw hasher_overloaded("password hashing queue is full");
+    }
+    if (!value) {
+        abandoned->store(true, std::memory_order_relaxed);
+        throw deadline_exceeded("request deadline exceeded while hashing password");
+    }
+    co_return std::move(*value);
+}
+
+} // namespace SocialNetwork
@@ -23,7 +23,30 @@ std::shared_ptr<cxxopts::ParseResult> configure_cli_options(int argc, char** arg
         ("http_listening",      "Address and port (ip:port) HTTP server starts listening on", cxxopts::value<std::string>())
         ("http_queue",          "Max available requests queue capacity for HTTP server", cxxopts::value<int>())
         ("http_threads",        "Max available threads count to handle HTTP requests", cxxopts::value<int>())
+        ("http_threads_max",    "Threads count the HTTP pool may grow to under load, 0 - fixed pool of http_threads", cxxopts::value<int>())
+        ("http_threads_idle",   "Milliseconds an extra HTTP pool thread may stay idle before it exits", cxxopts::value<int>())
+        ("http_mode",           "HTTP server mode (httplib, epoll, io_uring)", cxxopts::value<std::string>())
+        ("http_reactors",       "Reactor threads count to handle HTTP connections (epoll, io_uring modes)", cxxopts::value<int>())
+        ("http_pipeline",       "Max pipelined requests of one connection processed at once (epoll, io_uring modes)", cxxopts::value<int>())
+        ("http_keep_alive_max", "Max requests served by one keep-alive connection", cxxopts::value<int>())
+        ("http_keep_alive_timeout", "Seconds a keep-alive connection may stay idle between requests", cxxopts::value<int>())
+        ("http_conn_per_ip",    "Max connections from one client IP address, 0 - unlimited (epoll, io_uring modes)", cxxopts::value<int>())
+        ("http_compress_min",   "Min response body size in bytes to compress, 0 - compression is disabled", cxxopts::value<int>())
+        ("http_search_cache_ttl", "Milliseconds a user search result is served from cache, 0 - cache is disabled", cxxopts::value<int>())
+        ("http_queue_target",   "Milliseconds a request may wait in the pool queue before shedding starts, 0 - never shed", cxxopts::value<int>())
+        ("http_queue_interval", "Milliseconds the queue wait may stay above target before requests are shed", cxxopts::value<int>())
+        ("http_cpu_threads",    "Threads count to handle CPU-heavy requests (login, register), 0 - shared with other requests (epoll, io_uring modes)", cxxopts::value<int>())
+        ("http_cpu_queue",      "Max requests queue capacity for CPU-heavy requests (epoll, io_uring modes)", cxxopts::value<int>())
+        ("http_cpu_queue_target", "Milliseconds a CPU-heavy request may wait in its queue before shedding starts, 0 - never shed", cxxopts::value<int>())
+        ("http_cpu_queue_interval", "Milliseconds the CPU-heavy queue wait may stay above target before requests are shed", cxxopts::value<int>())
+        ("http_bcrypt_threads", "Threads count to hash passwords with bcrypt, 0 - CPU cores available to the process (cgroup quota)", cxxopts::value<int>())
+        ("http_db_threads",     "Threads count to run DB queries while request handlers are suspended, 0 - queries run in handler threads", cxxopts::value<int>())
+        ("http_credential_cache_ttl", "Milliseconds a verified password is accepted on login without bcrypt, 0 - cache is disabled", cxxopts::value<int>())
+        ("http_threads_affinity",  "CPU pinning of HTTP pool threads: none, compact, spread or CPU list (0-3,8)", cxxopts::value<std::string>())
+        ("http_reactors_affinity", "CPU pinning of reactor threads: none, compact, spread or CPU list (epoll, io_uring modes)", cxxopts::value<std::string>())
+        ("http_bcrypt_affinity",   "CPU pinning of password hashing threads: none, compact, spread or CPU list", cxxopts::value<std::string>())
         ("prometheus_port",     "Port Prometheus server starts listening on", cxxopts::value<int>())
+        ("workers",             "Worker processes count sharing HTTP listening address (with supervisor)", cxxopts::value<int>())
         ("i,index_add",         "Add indexes into DB (names_search) ", cxxopts::value<std::vector<std::string>>())
         ("I,index_drop",        "Drop indexes into DB (names_search) ", cxxopts::value<std::vector<std::string>>())
         ;
@@ -81,8 +104,32 @@ for (int i = 0; const auto& replica : current_configuration_.pgsql_replica) {
 }
     ss << "\n  http.listening="         << std::quoted(current_configuration_.http_listening);
     ss << "\n  http.threads_count="     << current_configuration_.http_threads_count;
+    ss << "\n  http.threads_max_count=" << current_configuration_.http_threads_max_count;
+    ss << "\n  http.threads_idle_timeout=" << current_configuration_.http_threads_idle_timeout;
     ss << "\n  http.queue_capacity="    << current_configuration_.http_queue_capacity;
+    ss << "\n  http.server_mode="       << current_configuration_.http_server_mode;
+    ss << "\n  http.reactors_count="    << current_configuration_.http_reactors_count;
+    ss << "\n  http.pipeline_max_depth=" << current_configuration_.http_pipeline_max_depth;
+    ss << "\n  http.keep_alive_max_count="   << current_configuration_.http_keep_alive_max_count;
+    ss << "\n  http.keep_alive_timeout="     << current_configuration_.http_keep_alive_timeout;
+    ss << "\n  http.max_connections_per_ip=" << current_configuration_.http_max_connections_per_ip;
+    ss << "\n  http.compression_min_size="   << current_configuration_.http_compression_min_size;
+    ss << "\n  http.search_cache_ttl="       << current_configuration_.http_search_cache_ttl;
+    ss << "\n  http.queue_target_delay="     << current_configuration_.http_queue_target_delay;
+    ss << "\n  http.queue_interval="         << current_configuration_.http_queue_interval;
+    ss << "\n  http.cpu_threads_count="      << current_configuration_.http_cpu_threads_count;
+    ss << "\n  http.cpu_queue_capacity="     << current_configuration_.http_cpu_queue_capacity;
+    ss << "\n  http.cpu_queue_target_delay=" << current_configuration_.http_cpu_queue_target_delay;
+    ss << "\n  http.cpu_queue_interval="     << current_configuration_.http_cpu_queue_interval;
+    ss << "\n  http.bcrypt_threads_count="   << current_configuration_.http_bcrypt_threads_count;
+    ss << "\n  http.db_threads_count="       << current_configuration_.http_db_threads_count;
+    ss << "\n  http.credential_cache_ttl="   << current_configuration_.http_credential_cache_ttl;
+    ss << "\n  http.threads_affinity="      << current_configuration_.http_threads_affinity;
+    ss << "\n  http.reactors_affinity="     << current_configuration_.http_reactors_affinity;
+    ss << "\n  http.bcrypt_affinity="       << current_configuration_.http_bcrypt_affinity;
     ss << "\n  prometheus.listening="   << current_configuration_.prometheus_listening;
+    ss << "\n  workers_count="          << current_configuration_.workers_count;
+    ss << "\n  worker_id="              << current_configuration_.worker_id;
     LOG_DEBUG(ss.str());
 }
 
@@ -186,6 +233,271 @@ void Configuration::apply_(std::shared_ptr<cxxopts::ParseResult> cli_opts)
             }
         }
     }
+    {
+        const std::string key("HTTP_THREADS_MAX_COUNT");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_threads_max_count = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+    {
+        const std::string key("HTTP_THREADS_IDLE_TIMEOUT_MS");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_threads_idle_timeout = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_SERVER_MODE");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto val = StringHelpers::trim(env.value());
+            current_configuration_.http_server_mode = StringHelpers::to_lowercase(val);
+            LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+        }
+    }
+    {
+        const std::string key("HTTP_REACTORS_COUNT");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_reactors_count = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+    {
+        const std::string key("HTTP_PIPELINE_MAX_DEPTH");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_pipeline_max_depth = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+    {
+        const std::string key("HTTP_KEEP_ALIVE_MAX_COUNT");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_keep_alive_max_count = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+    {
+        const std::string key("HTTP_KEEP_ALIVE_TIMEOUT");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_keep_alive_timeout = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+    {
+        const std::string key("HTTP_MAX_CONNECTIONS_PER_IP");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_max_connections_per_ip = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_COMPRESSION_MIN_SIZE");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_compression_min_size = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_SEARCH_CACHE_TTL_MS");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_search_cache_ttl = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_QUEUE_TARGET_DELAY_MS");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_queue_target_delay = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_QUEUE_INTERVAL_MS");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_queue_interval = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_CPU_THREADS_COUNT");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_cpu_threads_count = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_CPU_QUEUE_CAPACITY");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_cpu_queue_capacity = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_CPU_QUEUE_TARGET_DELAY_MS");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_cpu_queue_target_delay = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_CPU_QUEUE_INTERVAL_MS");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_cpu_queue_interval = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_BCRYPT_THREADS_COUNT");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_bcrypt_threads_count = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_DB_THREADS_COUNT");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_db_threads_count = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_CREDENTIAL_CACHE_TTL_MS");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.http_credential_cache_ttl = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+
+    {
+        const std::string key("HTTP_THREADS_AFFINITY");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto val = StringHelpers::trim(env.value());
+            current_configuration_.http_threads_affinity = StringHelpers::to_lowercase(val);
+            LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+        }
+    }
+    {
+        const std::string key("HTTP_REACTORS_AFFINITY");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto val = StringHelpers::trim(env.value());
+            current_configuration_.http_reactors_affinity = StringHelpers::to_lowercase(val);
+            LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+        }
+    }
+    {
+        const std::string key("HTTP_BCRYPT_AFFINITY");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto val = StringHelpers::trim(env.value());
+            current_configuration_.http_bcrypt_affinity = StringHelpers::to_lowercase(val);
+            LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+        }
+    }
 
     {
         const std::string key("PROMETHEUS_PORT");
@@ -199,6 +511,31 @@ void Configuration::apply_(std::shared_ptr<cxxopts::ParseResult> cli_opts)
             }
         }
     }
+    {
+        const std::string key("WORKERS_COUNT");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.workers_count = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
+    {
+        // выставляется супервизором для запущенных им процессов-обработчиков
+        const std::string key("WORKER_ID");
+        if (EnvironmentHelpers::has(key)) {
+            auto env = EnvironmentHelpers::get(key);
+            auto str = StringHelpers::trim(env.value());
+            int val = 0;
+            if (NumberParserHelpers::try_parse_int(str, val)) {
+                current_configuration_.worker_id = val;
+                LOG_DEBUG(std::format("configuration parameter was replaced by environment variable '{}'", key));
+            }
+        }
+    }
 
     LOG_INFOR(std::format("trying to read configuration from command line options"));
     const auto& cli = *cli_opts;
@@ -253,6 +590,219 @@ void Configuration::apply_(std::shared_ptr<cxxopts::ParseResult> cli_opts)
         }
     }
     catch (...) {}
+    try {
+        const std::string key("http_threads_max");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_threads_max_count = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+    try {
+        const std::string key("http_threads_idle");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_threads_idle_timeout = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_mode");
+        if (cli.count(key)) {
+            auto val = cli[key].as<std::string>();
+            current_configuration_.http_server_mode = StringHelpers::to_lowercase(val);
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+    try {
+        const std::string key("http_reactors");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_reactors_count = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+    try {
+        const std::string key("http_pipeline");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_pipeline_max_depth = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+    try {
+        const std::string key("http_keep_alive_max");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_keep_alive_max_count = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+    try {
+        const std::string key("http_keep_alive_timeout");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_keep_alive_timeout = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+    try {
+        const std::string key("http_conn_per_ip");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_max_connections_per_ip = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_compress_min");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_compression_min_size = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_search_cache_ttl");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_search_cache_ttl = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_queue_target");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_queue_target_delay = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_queue_interval");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_queue_interval = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_cpu_threads");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_cpu_threads_count = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_cpu_queue");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_cpu_queue_capacity = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_cpu_queue_target");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_cpu_queue_target_delay = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_cpu_queue_interval");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_cpu_queue_interval = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_bcrypt_threads");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_bcrypt_threads_count = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_db_threads");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_db_threads_count = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_credential_cache_ttl");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.http_credential_cache_ttl = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_threads_affinity");
+        if (cli.count(key)) {
+            auto val = cli[key].as<std::string>();
+            current_configuration_.http_threads_affinity = StringHelpers::to_lowercase(val);
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_reactors_affinity");
+        if (cli.count(key)) {
+            auto val = cli[key].as<std::string>();
+            current_configuration_.http_reactors_affinity = StringHelpers::to_lowercase(val);
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
+
+    try {
+        const std::string key("http_bcrypt_affinity");
+        if (cli.count(key)) {
+            auto val = cli[key].as<std::string>();
+            current_configuration_.http_bcrypt_affinity = StringHelpers::to_lowercase(val);
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
 
     try {
         const std::string key("prometheus_port");
@@ -263,6 +813,15 @@ void Configuration::apply_(std::shared_ptr<cxxopts::ParseResult> cli_opts)
         }
     }
     catch (...) {}
+    try {
+        const std::string key("workers");
+        if (cli.count(key)) {
+            auto val = cli[key].as<int>();
+            current_configuration_.workers_count = val;
+            LOG_DEBUG(std::format("configuration parameter was replaced by command line option '{}'", key));
+        }
+    }
+    catch (...) {}
 
     auto errors = current_configuration_.validate();
     for (auto& err : errors) {
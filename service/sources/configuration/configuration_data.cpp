@@ -4,6 +4,7 @@
 #include "helpers/ip_address.h"
 #include "helpers/dns_address.h"
 #include "helpers/socket_address.h"
+#include "helpers/cpu_topology.h"
 #include "configuration/configuration_data.h"
 
 namespace SocialNetwork {
@@ -17,14 +18,129 @@ const uint16_t config_def::pgsql_port = 5432;
 const std::string config_def::http_listening{"0.0.0.0:6000"};
 const uint16_t config_def::http_port = 6000;
 
-const int config_max::http_threads_count = 10;
+const int config_max::http_threads_count = 128;
 const int config_def::http_threads_count = 1;
 const int config_min::http_threads_count = 1;
 
+// эластичный пул: под нагрузкой растет от http_threads_count до http_threads_max_count
+// потоков, поток без задач дольше http_threads_idle_timeout завершается.
+// 0 (или не больше http_threads_count) - пул фиксированного размера
+const int config_max::http_threads_max_count = 128;
+const int config_def::http_threads_max_count = 0;
+const int config_min::http_threads_max_count = 0;
+
+const int config_max::http_threads_idle_timeout = 3600000;
+const int config_def::http_threads_idle_timeout = 30000;
+const int config_min::http_threads_idle_timeout = 100;
+
 const int config_max::http_queue_capacity = 4096;
 const int config_def::http_queue_capacity = 1024;
 const int config_min::http_queue_capacity = 1;
 
+// httplib - поток пула на каждое соединение (как было изначально),
+// epoll   - reactor-потоки на epoll, в пул уходят только готовые запросы
+// io_uring - то же самое на io_uring (ядро 6.0+), при недоступности - httplib
+const std::string config_def::http_server_mode{"httplib"};
+const std::set<std::string> config_def::http_server_modes{"httplib", "epoll", "io_uring"};
+
+const int config_max::http_reactors_count = 16;
+const int config_def::http_reactors_count = 1;
+const int config_min::http_reactors_count = 1;
+
+// сколько запросов одного соединения (HTTP/1.1 pipelining) могут
+// одновременно обрабатываться в пуле (для режимов epoll и io_uring)
+const int config_max::http_pipeline_max_depth = 128;
+const int config_def::http_pipeline_max_depth = 16;
+const int config_min::http_pipeline_max_depth = 1;
+
+// сколько запросов обслуживает одно соединение, и сколько секунд оно может
+// простаивать между запросами (до повторного подключения клиента)
+const int config_max::http_keep_alive_max_count = 100000;
+const int config_def::http_keep_alive_max_count = 100;
+const int config_min::http_keep_alive_max_count = 1;
+
+const int config_max::http_keep_alive_timeout = 300;
+const int config_def::http_keep_alive_timeout = 10;
+const int config_min::http_keep_alive_timeout = 1;
+
+// сколько соединений можно открыть с одного IP-адреса (для режимов epoll и io_uring), 0 - без ограничения
+const int config_max::http_max_connections_per_ip = 100000;
+const int config_def::http_max_connections_per_ip = 0;
+const int config_min::http_max_connections_per_ip = 0;
+
+// ответы от скольких байт сжимаются (Content-Encoding), 0 - не сжимаются
+const int config_max::http_compression_min_size = 1048576;
+const int config_def::http_compression_min_size = 1024;
+const int config_min::http_compression_min_size = 0;
+
+// сколько миллисекунд результат поиска пользователей отдается из кэша, 0 - кэш отключен.
+// по умолчанию время сопоставимо с отставанием реплик, из которых читает поиск
+const int config_max::http_search_cache_ttl = 60000;
+const int config_def::http_search_cache_ttl = 1000;
+const int config_min::http_search_cache_ttl = 0;
+
+// отбор запросов по времени ожидания в очереди пула (CoDel): если запросы ждут
+// дольше target_delay миллисекунд на протяжении interval миллисекунд, часть
+// из них получает 503 с Retry-After. target_delay = 0 - запросы не отбрасываются
+const int config_max::http_queue_target_delay = 10000;
+const int config_def::http_queue_target_delay = 50;
+const int config_min::http_queue_target_delay = 0;
+
+const int config_max::http_queue_interval = 60000;
+const int config_def::http_queue_interval = 500;
+const int config_min::http_queue_interval = 10;
+
+// дорожка пула потоков для дорогих по CPU запросов (bcrypt в /login и /user/register)
+// в режимах epoll и io_uring: свои потоки, очередь и отбор запросов (CoDel), чтобы
+// всплеск входов не задерживал чтение анкет. threads_count = 0 - отдельной дорожки нет
+const int config_max::http_cpu_threads_count = 10;
+const int config_def::http_cpu_threads_count = 2;
+const int config_min::http_cpu_threads_count = 0;
+
+const int config_max::http_cpu_queue_capacity = 4096;
+const int config_def::http_cpu_queue_capacity = 256;
+const int config_min::http_cpu_queue_capacity = 1;
+
+const int config_max::http_cpu_queue_target_delay = 10000;
+const int config_def::http_cpu_queue_target_delay = 500;
+const int config_min::http_cpu_queue_target_delay = 0;
+
+const int config_max::http_cpu_queue_interval = 60000;
+const int config_def::http_cpu_queue_interval = 2000;
+const int config_min::http_cpu_queue_interval = 10;
+
+// потоки пула хеширования паролей (bcrypt), 0 - по числу ядер, доступных процессу
+// с учетом квоты CPU контейнера (cgroup)
+const int config_max::http_bcrypt_threads_count = 64;
+const int config_def::http_bcrypt_threads_count = 0;
+const int config_min::http_bcrypt_threads_count = 0;
+
+// потоки пула запросов к БД: обработчик ждет ответ БД (co_await), не занимая
+// поток пула запросов. 0 - запрос к БД выполняется в потоке обработчика
+const int config_max::http_db_threads_count = 128;
+const int config_def::http_db_threads_count = 0;
+const int config_min::http_db_threads_count = 0;
+
+// сколько миллисекунд успешно проверенный пароль принимается при входе без bcrypt
+// (сверяется HMAC пароля и неизменность хеша в БД), 0 - кэш отключен
+const int config_max::http_credential_cache_ttl = 3600000;
+const int config_def::http_credential_cache_ttl = 300000;
+const int config_min::http_credential_cache_ttl = 0;
+
+// закрепление за ядрами потоков пула запросов (дорожек и пула httplib), reactor-потоков
+// и пула хеширования паролей: none - не закреплять, compact - подряд по ядрам одного
+// узла NUMA, spread - по очереди по узлам и физическим ядрам, или явный список ядер
+// "0-3,8". у процессов-обработчиков супервизора compact и spread делят ядра между ними
+const std::string config_def::http_threads_affinity{"none"};
+const std::string config_def::http_reactors_affinity{"none"};
+const std::string config_def::http_bcrypt_affinity{"none"};
+
+// количество процессов-обработчиков (pre-fork), при значении больше 1
+// запускается супервизор, который их перезапускает и собирает метрики
+const int config_max::workers_count = 64;
+const int config_def::workers_count = 1;
+const int config_min::workers_count = 1;
+
 const std::string config_def::prometheus_listening{"0.0.0.0:6001"};
 const std::string config_def::prometheus_host{"0.0.0.0"};
 const uint16_t    config_def::prometheus_port = 6001;
@@ -50,11 +166,36 @@ void config_data::config_s::clear()
 
     http_listening      = config_def::http_listening;
     http_threads_count  = config_def::http_threads_count;
+    http_threads_max_count    = config_def::http_threads_max_count;
+    http_threads_idle_timeout = config_def::http_threads_idle_timeout;
     http_queue_capacity = config_def::http_queue_capacity;
+    http_server_mode    = config_def::http_server_mode;
+    http_reactors_count = config_def::http_reactors_count;
+    http_pipeline_max_depth = config_def::http_pipeline_max_depth;
+    http_keep_alive_max_count   = config_def::http_keep_alive_max_count;
+    http_keep_alive_timeout     = config_def::http_keep_alive_timeout;
+    http_max_connections_per_ip = config_def::http_max_connections_per_ip;
+    http_compression_min_size   = config_def::http_compression_min_size;
+    http_search_cache_ttl       = config_def::http_search_cache_ttl;
+    http_queue_target_delay     = config_def::http_queue_target_delay;
+    http_queue_interval         = config_def::http_queue_interval;
+    http_cpu_threads_count      = config_def::http_cpu_threads_count;
+    http_cpu_queue_capacity     = config_def::http_cpu_queue_capacity;
+    http_cpu_queue_target_delay = config_def::http_cpu_queue_target_delay;
+    http_cpu_queue_interval     = config_def::http_cpu_queue_interval;
+    http_bcrypt_threads_count   = config_def::http_bcrypt_threads_count;
+    http_db_threads_count       = config_def::http_db_threads_count;
+    http_credential_cache_ttl   = config_def::http_credential_cache_ttl;
+    http_threads_affinity       = config_def::http_threads_affinity;
+    http_reactors_affinity      = config_def::http_reactors_affinity;
+    http_bcrypt_affinity        = config_def::http_bcrypt_affinity;
 
     prometheus_listening = config_def::prometheus_listening;
     prometheus_port      = config_def::prometheus_port;
 
+    workers_count = config_def::workers_count;
+    worker_id     = -1;
+
     logging_config = config_def::logging_config;
 }
 
@@ -203,6 +344,20 @@ std::list<std::string> config_data::config_s::validate()
         http_threads_count = config_def::http_threads_count;
     }
 
+    if (http_threads_max_count < config_min::http_threads_max_count
+    ||  http_threads_max_count > config_max::http_threads_max_count) {
+        errors.push_back(std::format("validation error 'http.threads_max_count={}': should be in range [{}..{}]",
+            http_threads_max_count, config_min::http_threads_max_count, config_max::http_threads_max_count));
+        http_threads_max_count = config_def::http_threads_max_count;
+    }
+
+    if (http_threads_idle_timeout < config_min::http_threads_idle_timeout
+    ||  http_threads_idle_timeout > config_max::http_threads_idle_timeout) {
+        errors.push_back(std::format("validation error 'http.threads_idle_timeout={}': should be in range [{}..{}]",
+            http_threads_idle_timeout, config_min::http_threads_idle_timeout, config_max::http_threads_idle_timeout));
+        http_threads_idle_timeout = config_def::http_threads_idle_timeout;
+    }
+
     if (http_queue_capacity < config_min::http_queue_capacity
     ||  http_queue_capacity > config_max::http_queue_capacity) {
         errors.push_back(std::format("validation error 'http.queue_capacity={}': should be in range [{}..{}]",
@@ -210,8 +365,162 @@ std::list<std::string> config_data::config_s::validate()
         http_queue_capacity = config_def::http_queue_capacity;
     }
 
+    if (!config_def::http_server_modes.contains(http_server_mode)) {
+        errors.push_back(std::format("validation error 'http.server_mode={}': unknown mode",
+            http_server_mode));
+        http_server_mode = config_def::http_server_mode;
+    }
+
+    if (http_reactors_count < config_min::http_reactors_count
+    ||  http_reactors_count > config_max::http_reactors_count) {
+        errors.push_back(std::format("validation error 'http.reactors_count={}': should be in range [{}..{}]",
+            http_reactors_count, config_min::http_reactors_count, config_max::http_reactors_count));
+        http_reactors_count = config_def::http_reactors_count;
+    }
+
+    if (http_pipeline_max_depth < config_min::http_pipeline_max_depth
+    ||  http_pipeline_max_depth > config_max::http_pipeline_max_depth) {
+        errors.push_back(std::format("validation error 'http.pipeline_max_depth={}': should be in range [{}..{}]",
+            http_pipeline_max_depth, config_min::http_pipeline_max_depth, config_max::http_pipeline_max_depth));
+        http_pipeline_max_depth = config_def::http_pipeline_max_depth;
+    }
+
+    if (http_keep_alive_max_count < config_min::http_keep_alive_max_count
+    ||  http_keep_alive_max_count > config_max::http_keep_alive_max_count) {
+        errors.push_back(std::format("validation error 'http.keep_alive_max_count={}': should be in range [{}..{}]",
+            http_keep_alive_max_count, config_min::http_keep_alive_max_count, config_max::http_keep_alive_max_count));
+        http_keep_alive_max_count = config_def::http_keep_alive_max_count;
+    }
+
+    if (http_keep_alive_timeout < config_min::http_keep_alive_timeout
+    ||  http_keep_alive_timeout > config_max::http_keep_alive_timeout) {
+        errors.push_back(std::format("validation error 'http.keep_alive_timeout={}': should be in range [{}..{}]",
+            http_keep_alive_timeout, config_min::http_keep_alive_timeout, config_max::http_keep_alive_timeout));
+        http_keep_alive_timeout = config_def::http_keep_alive_timeout;
+    }
+
+    if (http_max_connections_per_ip < config_min::http_max_connections_per_ip
+    ||  http_max_connections_per_ip > config_max::http_max_connections_per_ip) {
+        errors.push_back(std::format("validation error 'http.max_connections_per_ip={}': should be in range [{}..{}]",
+            http_max_connections_per_ip, config_min::http_max_connections_per_ip, config_max::http_max_connections_per_ip));
+        http_max_connections_per_ip = config_def::http_max_connections_per_ip;
+    }
+
+    if (http_compression_min_size < config_min::http_compression_min_size
+    ||  http_compression_min_size > config_max::http_compression_min_size) {
+        errors.push_back(std::format("validation error 'http.compression_min_size={}': should be in range [{}..{}]",
+            http_compression_min_size, config_min::http_compression_min_size, config_max::http_compression_min_size));
+        http_compression_min_size = config_def::http_compression_min_size;
+    }
+
+    if (http_search_cache_ttl < config_min::http_search_cache_ttl
+    ||  http_search_cache_ttl > config_max::http_search_cache_ttl) {
+        errors.push_back(std::format("validation error 'http.search_cache_ttl={}': should be in range [{}..{}]",
+            http_search_cache_ttl, config_min::http_search_cache_ttl, config_max::http_search_cache_ttl));
+        http_search_cache_ttl = config_def::http_search_cache_ttl;
+    }
+
+    if (http_queue_target_delay < config_min::http_queue_target_delay
+    ||  http_queue_target_delay > config_max::http_queue_target_delay) {
+        errors.push_back(std::format("validation error 'http.queue_target_delay={}': should be in range [{}..{}]",
+            http_queue_target_delay, config_min::http_queue_target_delay, config_max::http_queue_target_delay));
+        http_queue_target_delay = config_def::http_queue_target_delay;
+    }
+
+    if (http_queue_interval < config_min::http_queue_interval
+    ||  http_queue_interval > config_max::http_queue_interval) {
+        errors.push_back(std::format("validation error 'http.queue_interval={}': should be in range [{}..{}]",
+            http_queue_interval, config_min::http_queue_interval, config_max::http_queue_interval));
+        http_queue_interval = config_def::http_queue_interval;
+    }
+
+    if (http_cpu_threads_count < config_min::http_cpu_threads_count
+    ||  http_cpu_threads_count > config_max::http_cpu_threads_count) {
+        errors.push_back(std::format("validation error 'http.cpu_threads_count={}': should be in range [{}..{}]",
+            http_cpu_threads_count, config_min::http_cpu_threads_count, config_max::http_cpu_threads_count));
+        http_cpu_threads_count = config_def::http_cpu_threads_count;
+    }
+
+    if (http_cpu_queue_capacity < config_min::http_cpu_queue_capacity
+    ||  http_cpu_queue_capacity > config_max::http_cpu_queue_capacity) {
+        errors.push_back(std::format("validation error 'http.cpu_queue_capacity={}': should be in range [{}..{}]",
+            http_cpu_queue_capacity, config_min::http_cpu_queue_capacity, config_max::http_cpu_queue_capacity));
+        http_cpu_queue_capacity = config_def::http_cpu_queue_capacity;
+    }
+
+    if (http_cpu_queue_target_delay < config_min::http_cpu_queue_target_delay
+    ||  http_cpu_queue_target_delay > config_max::http_cpu_queue_target_delay) {
+        errors.push_back(std::format("validation error 'http.cpu_queue_target_delay={}': should be in range [{}..{}]",
+            http_cpu_queue_target_delay, config_min::http_cpu_queue_target_delay, config_max::http_cpu_queue_target_delay));
+        http_cpu_queue_target_delay = config_def::http_cpu_queue_target_delay;
+    }
+
+    if (http_cpu_queue_interval < config_min::http_cpu_queue_interval
+    ||  http_cpu_queue_interval > config_max::http_cpu_queue_interval) {
+        errors.push_back(std::format("validation error 'http.cpu_queue_interval={}': should be in range [{}..{}]",
+            http_cpu_queue_interval, config_min::http_cpu_queue_interval, config_max::http_cpu_queue_interval));
+        http_cpu_queue_interval = config_def::http_cpu_queue_interval;
+    }
+
+    if (http_bcrypt_threads_count < config_min::http_bcrypt_threads_count
+    ||  http_bcrypt_threads_count > config_max::http_bcrypt_threads_count) {
+        errors.push_back(std::format("validation error 'http.bcrypt_threads_count={}': should be in range [{}..{}]",
+            http_bcrypt_threads_count, config_min::http_bcrypt_threads_count, config_max::http_bcrypt_threads_count));
+        http_bcrypt_threads_count = config_def::http_bcrypt_threads_count;
+    }
+
+    if (http_db_threads_count < config_min::http_db_threads_count
+    ||  http_db_threads_count > config_max::http_db_threads_count) {
+        errors.push_back(std::format("validation error 'http.db_threads_count={}': should be in range [{}..{}]",
+            http_db_threads_count, config_min::http_db_threads_count, config_max::http_db_threads_count));
+        http_db_threads_count = config_def::http_db_threads_count;
+    }
+
+    if (http_credential_cache_ttl < config_min::http_credential_cache_ttl
+    ||  http_credential_cache_ttl > config_max::http_credential_cache_ttl) {
+        errors.push_back(std::format("validation error 'http.credential_cache_ttl={}': should be in range [{}..{}]",
+            http_credential_cache_ttl, config_min::http_credential_cache_ttl, config_max::http_credential_cache_ttl));
+        http_credential_cache_ttl = config_def::http_credential_cache_ttl;
+    }
+
+    if (!ThreadHelpers::Affinity::parse(http_threads_affinity)) {
+        errors.push_back(std::format("validation error 'http.threads_affinity={}': should be none, compact, spread or CPU list",
+            http_threads_affinity));
+        http_threads_affinity = config_def::http_threads_affinity;
+    }
+
+    if (!ThreadHelpers::Affinity::parse(http_reactors_affinity)) {
+        errors.push_back(std::format("validation error 'http.reactors_affinity={}': should be none, compact, spread or CPU list",
+            http_reactors_affinity));
+        http_reactors_affinity = config_def::http_reactors_affinity;
+    }
+
+    if (!ThreadHelpers::Affinity::parse(http_bcrypt_affinity)) {
+        errors.push_back(std::format("validation error 'http.bcrypt_affinity={}': should be none, compact, spread or CPU list",
+            http_bcrypt_affinity));
+        http_bcrypt_affinity = config_def::http_bcrypt_affinity;
+    }
+
+    if (workers_count < config_min::workers_count
+    ||  workers_count > config_max::workers_count) {
+        errors.push_back(std::format("validation error 'workers_count={}': should be in range [{}..{}]",
+            workers_count, config_min::workers_count, config_max::workers_count));
+        workers_count = config_def::workers_count;
+    }
+
+    if (worker_id < -1
+    ||  worker_id >= config_max::workers_count) {
+        errors.push_back(std::format("validation error 'worker_id={}': should be in range [{}..{}]",
+            worker_id, -1, config_max::workers_count - 1));
+        worker_id = -1;
+    }
+
     try {
         prometheus_listening = std::format("{}:{}", config_def::prometheus_host, prometheus_port);
+        if (worker_id >= 0) {
+            // процесс-обработчик отдает метрики только супервизору, на следующих за ним портах
+            prometheus_listening = std::format("127.0.0.1:{}", prometheus_port + 1 + worker_id);
+        }
         NetHelpers::SocketAddress sock_addr(prometheus_listening);
         if (sock_addr.port() == 0) {
             prometheus_listening = std::format("{}:{}", config_def::prometheus_host, config_def::prometheus_port);
@@ -0,0 +1,175 @@
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include "helpers/coarse_clock.h"
+
+namespace SocialNetwork {
+
+namespace TimeHelpers {
+
+struct stamps_s {
+    char http_date[CoarseClock::http_date_length];
+    char local_time[CoarseClock::local_time_length];
+    char log_time[CoarseClock::log_time_length];
+};
+
+// буфер кольца защищен счетчиком версий (seqlock): нечетное значение -
+// буфер сейчас перезаписывается, и читатель должен повторить чтение
+struct slot_s {
+    std::atomic<uint64_t> version{0};
+    stamps_s              stamps{};
+};
+
+static constexpr size_t slots_count = 4;
+
+static slot_s               slots_[slots_count];
+static std::atomic<size_t>  current_{0};
+static std::atomic<int64_t> published_tick_{-1};    // тик (мс) в slots_[current_], -1 - еще не опубликован
+static std::atomic_flag     refreshing_ = ATOMIC_FLAG_INIT;
+
+// используются только потоком, захватившим refreshing_
+static stamps_s next_{};
+static time_t   next_second_{-1};
+
+static void put2_(char* p, int v)
+{
+    p[0] = static_cast<char>('0' + v / 10 % 10);
+    p[1] = static_cast<char>('0' + v % 10);
+}
+
+static void put3_(char* p, int v)
+{
+    p[0] = static_cast<char>('0' + v / 100 % 10);
+    put2_(p + 1, v % 100);
+}
+
+static void put4_(char* p, int v)
+{
+    put2_(p, v / 100 % 100);
+    put2_(p + 2, v % 100);
+}
+
+static void format_second_(time_t sec)
+{
+    static constexpr char days[][4]   = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static constexpr char months[][4] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                         "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    std::tm gmt{};
+    gmtime_r(&sec, &gmt);
+
+    // Sat, 01 Jan 2005 11:00:00 GMT
+    auto* d = next_.http_date;
+    std::memcpy(d, "Www, DD Mon YYYY HH:MM:SS GMT", CoarseClock::http_date_length);
+    std::memcpy(d, days[gmt.tm_wday], 3);
+    put2_(d + 5, gmt.tm_mday);
+    std::memcpy(d + 8, months[gmt.tm_mon], 3);
+    put4_(d + 12, gmt.tm_year + 1900);
+    put2_(d + 17, gmt.tm_hour);
+    put2_(d + 20, gmt.tm_min);
+    put2_(d + 23, gmt.tm_sec);
+
+    // 2025-04-08 12:06:54.123, миллисекунды дописываются на каждом тике
+    auto* l = next_.log_time;
+    std::memcpy(l, "YYYY-MM-DD HH:MM:SS.000", CoarseClock::log_time_length);
+    put4_(l, gmt.tm_year + 1900);
+    put2_(l + 5, gmt.tm_mon + 1);
+    put2_(l + 8, gmt.tm_mday);
+    put2_(l + 11, gmt.tm_hour);
+    put2_(l + 14, gmt.tm_min);
+    put2_(l + 17, gmt.tm_sec);
+
+    // 08/Apr/2025:12:06:54 +0000
+    std::tm local{};
+    localtime_r(&sec, &local);
+    auto offset = local.tm_gmtoff / 60;
+    auto* t = next_.local_time;
+    std::memcpy(t, "DD/Mon/YYYY:HH:MM:SS +0000", CoarseClock::local_time_length);
+    put2_(t, local.tm_mday);
+    std::memcpy(t + 3, months[local.tm_mon], 3);
+    put4_(t + 7, local.tm_year + 1900);
+    put2_(t + 12, local.tm_hour);
+    put2_(t + 15, local.tm_min);
+    put2_(t + 18, local.tm_sec);
+    if (offset < 0) {
+        t[21]  = '-';
+        offset = -offset;
+    }
+    put2_(t + 22, static_cast<int>(offset / 60));
+    put2_(t + 24, static_cast<int>(offset % 60));
+}
+
+static void refresh_()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    const int64_t tick = static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1'000'000;
+
+    if (tick == published_tick_.load(std::memory_order_acquire)) return;
+    // метки уже обновляет другой поток, пока можно прочитать предыдущие
+    if (refreshing_.test_and_set(std::memory_order_acquire)) return;
+
+    if (tick != published_tick_.load(std::memory_order_relaxed)) {
+        if (ts.tv_sec != next_second_) {
+            format_second_(ts.tv_sec);
+            next_second_ = ts.tv_sec;
+        }
+        put3_(next_.log_time + 20, static_cast<int>(ts.tv_nsec / 1'000'000));
+
+        const auto index = (current_.load(std::memory_order_relaxed) + 1) % slots_count;
+        auto& slot = slots_[index];
+        slot.version.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&slot.stamps, &next_, sizeof(next_));
+        slot.version.fetch_add(1, std::memory_order_release);
+
+        current_.store(index, std::memory_order_release);
+        published_tick_.store(tick, std::memory_order_release);
+    }
+
+    refreshing_.clear(std::memory_order_release);
+}
+
+template <typename Stamp, typename Copy>
+static Stamp read_(Copy copy)
+{
+    refresh_();
+    // самое первое обращение в процессе ждет, пока метки будут опубликованы
+    while (published_tick_.load(std::memory_order_acquire) < 0) refresh_();
+
+    Stamp result;
+    for (;;) {
+        const auto& slot    = slots_[current_.load(std::memory_order_acquire)];
+        const auto  version = slot.version.load(std::memory_order_acquire);
+        if (version & 1) continue;
+
+        copy(slot.stamps, result);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.version.load(std::memory_order_relaxed) == version) return result;
+    }
+}
+
+CoarseClock::HttpDate CoarseClock::http_date()
+{
+    return read_<HttpDate>([](const stamps_s& s, HttpDate& out) {
+        std::memcpy(out.data(), s.http_date, out.size());
+    });
+}
+
+CoarseClock::LocalTime CoarseClock::local_time()
+{
+    return read_<LocalTime>([](const stamps_s& s, LocalTime& out) {
+        std::memcpy(out.data(), s.local_time, out.size());
+    });
+}
+
+CoarseClock::LogTime CoarseClock::log_time()
+{
+    return read_<LogTime>([](const stamps_s& s, LogTime& out) {
+        std::memcpy(out.data(), s.log_time, out.size());
+    });
+}
+
+} // namespace TimeHelpers
+
+} // namespace SocialNetwork
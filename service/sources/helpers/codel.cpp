@@ -0,0 +1,65 @@
+#include <cmath>
+#include "helpers/codel.h"
+
+namespace SocialNetwork {
+
+namespace ThreadHelpers {
+
+bool CoDel::should_drop(clock_t::time_point queued, clock_t::time_point now)
+{
+    if (target_ == clock_t::duration::zero()) return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const bool above = above_target_(now - queued, now);
+
+    if (dropping_) {
+        if (!above) {
+            dropping_ = false;
+            return false;
+        }
+        if (now < drop_next_) return false;
+        ++count_;
+        drop_next_ = control_law_(drop_next_);
+        return true;
+    }
+
+    if (!above) return false;
+
+    // вход в режим отбрасывания. если предыдущий период перегрузки был
+    // недавно, продолжаем с его частоты, а не начинаем с единицы
+    dropping_ = true;
+    const auto delta = count_ - last_count_;
+    count_ = (delta > 1 && now - drop_next_ < 16 * interval_) ? delta : 1;
+    last_count_ = count_;
+    drop_next_  = control_law_(now);
+    return true;
+}
+
+int CoDel::retry_after_sec() const noexcept
+{
+    // за 'interval' очередь должна успеть разгрузиться
+    const auto sec = std::chrono::ceil<std::chrono::seconds>(interval_).count();
+    return sec > 0 ? static_cast<int>(sec) : 1;
+}
+
+bool CoDel::above_target_(clock_t::duration sojourn, clock_t::time_point now)
+{
+    if (sojourn < target_) {
+        first_above_ = {};
+        return false;
+    }
+    if (first_above_ == clock_t::time_point{}) {
+        first_above_ = now + interval_;
+        return false;
+    }
+    return now >= first_above_;
+}
+
+CoDel::clock_t::time_point CoDel::control_law_(clock_t::time_point t) const
+{
+    return t + std::chrono::duration_cast<clock_t::duration>(interval_ / std::sqrt(static_cast<double>(count_)));
+}
+
+} // namespace ThreadHelpers
+
+} // namespace SocialNetwork
@@ -0,0 +1,282 @@
+#include <sched.h>
+#include <unistd.h>
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <climits>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <new>
+#include <thread>
+#include <tuple>
+#include "helpers/string.h"
+#include "helpers/cpu_topology.h"
+
+namespace SocialNetwork {
+
+namespace ThreadHelpers {
+
+// верхняя граница номеров в списке ядер или узлов, защита от "0-4294967295"
+static constexpr unsigned cpu_list_max_ = 4096;
+
+static std::optional<unsigned> parse_unsigned_(std::string_view str)
+{
+    unsigned value = 0;
+    const auto* end = str.data() + str.size();
+    auto [ptr, ec] = std::from_chars(str.data(), end, value);
+    if (ec != std::errc{} || ptr != end || value >= cpu_list_max_) return std::nullopt;
+    return value;
+}
+
+std::optional<std::vector<unsigned>> parse_cpu_list(std::string_view str)
+{
+    while (!str.empty() && std::isspace(static_cast<unsigned char>(str.back()))) str.remove_suffix(1);
+    while (!str.empty() && std::isspace(static_cast<unsigned char>(str.front()))) str.remove_prefix(1);
+
+    std::vector<unsigned> result;
+    while (!str.empty()) {
+        const auto comma = str.find(',');
+        const auto item  = str.substr(0, comma);
+        str = (comma == std::string_view::npos) ? std::string_view{} : str.substr(comma + 1);
+
+        const auto dash  = item.find('-');
+        const auto first = parse_unsigned_(item.substr(0, dash));
+        const auto last  = (dash == std::string_view::npos) ? first : parse_unsigned_(item.substr(dash + 1));
+        if (!first || !last || *first > *last) return std::nullopt;
+        for (unsigned id = *first; id <= *last; ++id) result.push_back(id);
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+std::optional<Affinity> Affinity::parse(std::string_view str)
+{
+    const auto value = StringHelpers::to_lowercase(StringHelpers::trim(std::string(str)));
+    if (value.empty() || value == "none") return Affinity{Pinning::None, {}};
+    if (value == "compact") return Affinity{Pinning::Compact, {}};
+    if (value == "spread")  return Affinity{Pinning::Spread, {}};
+
+    auto cpus = parse_cpu_list(value);
+    if (!cpus || cpus->empty()) return std::nullopt;
+    return Affinity{Pinning::List, std::move(*cpus)};
+}
+
+// --------------------------------------------------------
+
+static std::optional<unsigned> read_unsigned_(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    std::string line;
+    if (!std::getline(file, line)) return std::nullopt;
+    return parse_unsigned_(StringHelpers::trim(line));
+}
+
+static std::vector<Cpu> discover_cpus_()
+{
+    std::vector<Cpu> cpus;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (unsigned id = 0; id < CPU_SETSIZE; ++id) {
+            if (CPU_ISSET(id, &set)) cpus.push_back(Cpu{id, id, 0, 0});
+        }
+    } else {
+        for (unsigned id = 0; id < std::max(std::thread::hardware_concurrency(), 1u); ++id) {
+            cpus.push_back(Cpu{id, id, 0, 0});
+        }
+    }
+
+    const std::filesystem::path cpu_root("/sys/devices/system/cpu");
+    for (auto& cpu : cpus) {
+        const auto topology = cpu_root / ("cpu" + std::to_string(cpu.id)) / "topology";
+        if (auto core = read_unsigned_(topology / "core_id")) cpu.core = *core;
+        if (auto package = read_unsigned_(topology / "physical_package_id")) cpu.package = *package;
+    }
+
+    // node<N>/cpulist - ядра узла; узлы только с памятью дают пустой список
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        const auto name = entry.path().filename().string();
+        if (!name.starts_with("node")) continue;
+        const auto node = parse_unsigned_(std::string_view(name).substr(4));
+        if (!node) continue;
+
+        std::ifstream file(entry.path() / "cpulist");
+        std::string line;
+        std::getline(file, line);
+        const auto node_cpus = parse_cpu_list(line);
+        if (!node_cpus) continue;
+        for (auto& cpu : cpus) {
+            if (std::binary_search(node_cpus->begin(), node_cpus->end(), cpu.id)) cpu.node = *node;
+        }
+    }
+    return cpus;
+}
+
+CpuTopology::CpuTopology(std::vector<Cpu> cpus)
+:   cpus_(std::move(cpus))
+{
+    std::sort(cpus_.begin(), cpus_.end(), [](const Cpu& l, const Cpu& r) { return l.id < r.id; });
+
+    for (const auto& cpu : cpus_) nodes_.push_back(cpu.node);
+    std::sort(nodes_.begin(), nodes_.end());
+    nodes_.erase(std::unique(nodes_.begin(), nodes_.end()), nodes_.end());
+
+    // Compact: узел, сокет, физическое ядро, аппаратный поток
+    auto ordered = cpus_;
+    std::sort(ordered.begin(), ordered.end(), [](const Cpu& l, const Cpu& r) {
+        return std::tie(l.node, l.package, l.core, l.id) < std::tie(r.node, r.package, r.core, r.id);
+    });
+    for (const auto& cpu : ordered) compact_.push_back(cpu.id);
+
+    // Spread: внутри узла сначала первые аппаратные потоки всех физических ядер,
+    // потом вторые, затем узлы чередуются
+    std::vector<std::vector<unsigned>> by_node;
+    for (const auto node : nodes_) {
+        std::map<std::pair<unsigned, unsigned>, std::vector<unsigned>> cores;
+        size_t node_cpus = 0;
+        for (const auto& cpu : ordered) {
+            if (cpu.node != node) continue;
+            cores[{cpu.package, cpu.core}].push_back(cpu.id);
+            ++node_cpus;
+        }
+        std::vector<unsigned> sequence;
+        for (size_t level = 0; sequence.size() < node_cpus; ++level) {
+            for (const auto& [core, threads] : cores) {
+                if (level < threads.size()) sequence.push_back(threads[level]);
+            }
+        }
+        by_node.push_back(std::move(sequence));
+    }
+    for (size_t i = 0; spread_.size() < cpus_.size(); ++i) {
+        for (const auto& sequence : by_node) {
+            if (i < sequence.size()) spread_.push_back(sequence[i]);
+        }
+    }
+}
+
+const CpuTopology& CpuTopology::system()
+{
+    static const CpuTopology topology(discover_cpus_());
+    return topology;
+}
+
+std::optional<unsigned> CpuTopology::node_of(unsigned cpu) const noexcept
+{
+    auto it = std::lower_bound(cpus_.begin(), cpus_.end(), cpu, [](const Cpu& l, unsigned id) { return l.id < id; });
+    if (it == cpus_.end() || it->id != cpu) return std::nullopt;
+    return it->node;
+}
+
+CpuTopology CpuTopology::slice(size_t index, size_t count) const
+{
+    if (count <= 1 || cpus_.empty()) return *this;
+
+    // процессов больше, чем ядер: по ядру на процесс, по кругу
+    const auto total = compact_.size();
+    const auto first = (count > total) ? (index % total) : (index * total / count);
+    const auto last  = (count > total) ? (first + 1) : ((index + 1) * total / count);
+
+    std::vector<Cpu> part;
+    for (size_t i = first; i < last; ++i) {
+        const auto id = compact_[i];
+        part.push_back(*std::find_if(cpus_.begin(), cpus_.end(), [id](const Cpu& cpu) { return cpu.id == id; }));
+    }
+    return CpuTopology(std::move(part));
+}
+
+std::vector<unsigned> CpuTopology::placement(const Affinity& affinity) const
+{
+    switch (affinity.pinning) {
+        case Pinning::Compact: return compact_;
+        case Pinning::Spread:  return spread_;
+        case Pinning::List: {
+            std::vector<unsigned> cpus;
+            for (const auto cpu : affinity.cpus) {
+                if (node_of(cpu)) cpus.push_back(cpu);
+            }
+            return cpus;
+        }
+        case Pinning::None:
+        default:
+            return {};
+    }
+}
+
+std::vector<unsigned> CpuTopology::nodes_of(const std::vector<unsigned>& cpus) const
+{
+    std::vector<unsigned> nodes;
+    for (const auto cpu : cpus) {
+        if (auto node = node_of(cpu)) nodes.push_back(*node);
+    }
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    return nodes;
+}
+
+// --------------------------------------------------------
+
+bool pin_thread(pthread_t th, unsigned cpu)
+{
+    if (cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(th, sizeof(set), &set) == 0;
+}
+
+int current_cpu() noexcept
+{
+    return sched_getcpu();
+}
+
+static size_t page_size_()
+{
+    static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+void* allocate_on_node(size_t bytes, unsigned node)
+{
+    const auto size = (std::max<size_t>(bytes, 1) + page_size_() - 1) / page_size_() * page_size_();
+    void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) throw std::bad_alloc();
+    // до первого обращения: страницы еще не выделены и сразу попадут на узел
+    bind_to_node(ptr, size, node);
+    return ptr;
+}
+
+void deallocate_on_node(void* ptr, size_t bytes) noexcept
+{
+    if (!ptr) return;
+    const auto size = (std::max<size_t>(bytes, 1) + page_size_() - 1) / page_size_() * page_size_();
+    ::munmap(ptr, size);
+}
+
+bool bind_to_node(void* ptr, size_t bytes, unsigned node) noexcept
+{
+    if (node >= cpu_list_max_) return false;
+
+    // mbind работает с целыми страницами: края, которые делят страницы с чужими данными, не трогаем
+    const auto page  = page_size_();
+    const auto begin = (reinterpret_cast<uintptr_t>(ptr) + page - 1) / page * page;
+    const auto end   = (reinterpret_cast<uintptr_t>(ptr) + bytes) / page * page;
+    if (begin >= end) return false;
+
+    constexpr size_t bits = sizeof(unsigned long) * CHAR_BIT;
+    unsigned long mask[cpu_list_max_ / bits] = {0};
+    mask[node / bits] |= 1UL << (node % bits);
+    // maxnode - количество бит маски плюс один (ядро отбрасывает последний)
+    const auto maxnode = (node / bits + 1) * bits + 1;
+    return ::syscall(SYS_mbind, begin, end - begin, MPOL_PREFERRED, mask, maxnode, MPOL_MF_MOVE) == 0;
+}
+
+} // namespace ThreadHelpers
+
+} // namespace SocialNetwork
@@ -0,0 +1,365 @@
+#include <format>
+#include "helpers/json_reader.h"
+
+namespace SocialNetwork {
+
+namespace JsonHelpers {
+
+// глубина вложенности пропускаемых значений (массивов и объектов)
+static constexpr size_t skip_max_depth = 64;
+
+static constexpr bool is_digit_(char ch) noexcept
+{
+    return ch >= '0' && ch <= '9';
+}
+
+static int hex_value_(char ch) noexcept
+{
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+static void append_utf8_(std::string& out, uint32_t cp)
+{
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xc0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xe0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    } else {
+        out.push_back(static_cast<char>(0xf0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3f)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3f)));
+    }
+}
+
+std::string ReadResult::message() const
+{
+    switch (error) {
+    case ReadError::NONE:       return "ok";
+    case ReadError::SYNTAX:     return std::format("invalid JSON at offset {}", offset);
+    case ReadError::NOT_OBJECT: return "request body should be a JSON object";
+    case ReadError::NOT_STRING: return std::format("param '{}' should be a string", field);
+    case ReadError::BAD_UTF8:   return std::format("param '{}' is not a valid UTF-8 string", field);
+    case ReadError::DUPLICATE:  return std::format("param '{}' is duplicated", field);
+    case ReadError::MISSING:    return std::format("request params does not contain '{}'", field);
+    case ReadError::TOO_SHORT:  return std::format("param '{}' is too short", field);
+    case ReadError::TOO_LONG:   return std::format("param '{}' is too long", field);
+    case ReadError::TOO_DEEP:   return std::format("JSON nesting is too deep at offset {}", offset);
+    }
+    return "unknown error";
+}
+
+bool Reader::fail(ReadError error, std::string_view field) noexcept
+{
+    if (error_.error == ReadError::NONE) {
+        error_ = ReadResult{error, field, pos_};
+    }
+    return false;
+}
+
+void Reader::skip_ws_() noexcept
+{
+    while (pos_ < json_.size()) {
+        const char ch = json_[pos_];
+        if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r') break;
+        ++pos_;
+    }
+}
+
+bool Reader::expect_(char ch) noexcept
+{
+    skip_ws_();
+    if (pos_ >= json_.size() || json_[pos_] != ch) return fail(ReadError::SYNTAX);
+    ++pos_;
+    return true;
+}
+
+bool Reader::begin_object() noexcept
+{
+    skip_ws_();
+    if (pos_ >= json_.size() || json_[pos_] != '{') return fail(ReadError::NOT_OBJECT);
+    ++pos_;
+    first_key_ = true;
+    return true;
+}
+
+bool Reader::next_key(std::string_view& key) noexcept
+{
+    if (error_.error != ReadError::NONE) return false;
+
+    skip_ws_();
+    if (pos_ >= json_.size()) return fail(ReadError::SYNTAX);
+    if (json_[pos_] == '}') {
+        ++pos_;
+        return false;
+    }
+    if (!first_key_ && !expect_(',')) return false;
+    first_key_ = false;
+
+    return key_(key);
+}
+
+bool Reader::key_(std::string_view& key) noexcept
+{
+    skip_ws_();
+    if (pos_ >= json_.size() || json_[pos_] != '"') return fail(ReadError::SYNTAX);
+    size_t length = 0;
+    return string_({}, key, length)
+        && expect_(':');
+}
+
+bool Reader::read_string(std::string_view field, std::string_view& value, size_t& length) noexcept
+{
+    skip_ws_();
+    if (pos_ >= json_.size()) return fail(ReadError::SYNTAX);
+    if (json_[pos_] != '"') return fail(ReadError::NOT_STRING, field);
+    return string_(field, value, length);
+}
+
+bool Reader::finish() noexcept
+{
+    if (error_.error != ReadError::NONE) return false;
+    skip_ws_();
+    if (pos_ != json_.size()) return fail(ReadError::SYNTAX);
+    return true;
+}
+
+bool Reader::string_(std::string_view field, std::string_view& value, size_t& length) noexcept
+{
+    ++pos_; // '"'
+    const size_t start   = pos_;
+    size_t       run     = pos_;  // начало еще не скопированного в scratch участка
+    size_t       decoded = std::string::npos;
+
+    length = 0;
+    while (pos_ < json_.size()) {
+        const auto ch = static_cast<unsigned char>(json_[pos_]);
+        if (ch == '"') {
+            if (decoded == std::string::npos) {
+                value = json_.substr(start, pos_ - start);
+            } else {
+                scratch_.append(json_.data() + run, pos_ - run);
+                value = std::string_view(scratch_).substr(decoded);
+            }
+            ++pos_;
+            return true;
+        }
+        if (ch < 0x20) return fail(ReadError::SYNTAX);
+        if (ch == '\\') {
+            if (decoded == std::string::npos) {
+                // раскодированные строки всегда короче исходного JSON, поэтому
+                // после резервирования буфер не перевыделяется, и ранее
+                // выданные std::string_view на него остаются валидными
+                if (!scratch_reserved_) {
+                    scratch_.reserve(scratch_.size() + json_.size());
+                    scratch_reserved_ = true;
+                }
+                decoded = scratch_.size();
+            }
+            scratch_.append(json_.data() + run, pos_ - run);
+            if (!escape_(field)) return false;
+            run = pos_;
+            ++length;
+            continue;
+        }
+        if (ch >= 0x80) {
+            if (!utf8_(field)) return false;
+            ++length;
+            continue;
+        }
+        ++pos_;
+        ++length;
+    }
+    return fail(ReadError::SYNTAX);
+}
+
+bool Reader::escape_(std::string_view field) noexcept
+{
+    ++pos_; // '\'
+    if (pos_ >= json_.size()) return fail(ReadError::SYNTAX);
+
+    const char ch = json_[pos_++];
+    switch (ch) {
+    case '"':
+    case '\\':
+    case '/': scratch_.push_back(ch);   return true;
+    case 'b': scratch_.push_back('\b'); return true;
+    case 'f': scratch_.push_back('\f'); return true;
+    case 'n': scratch_.push_back('\n'); return true;
+    case 'r': scratch_.push_back('\r'); return true;
+    case 't': scratch_.push_back('\t'); return true;
+    case 'u': break;
+    default:  return fail(ReadError::SYNTAX);
+    }
+
+    auto read_hex4 = [this](uint32_t& cp) {
+        if (pos_ + 4 > json_.size()) return false;
+        cp = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            const int v = hex_value_(json_[pos_ + i]);
+            if (v < 0) return false;
+            cp = (cp << 4) | static_cast<uint32_t>(v);
+        }
+        pos_ += 4;
+        return true;
+    };
+
+    uint32_t cp = 0;
+    if (!read_hex4(cp)) return fail(ReadError::SYNTAX);
+    if (cp >= 0xdc00 && cp <= 0xdfff) return fail(ReadError::BAD_UTF8, field);
+    if (cp >= 0xd800 && cp <= 0xdbff) {
+        // суррогатная пара
+        uint32_t low = 0;
+        if (json_.substr(pos_, 2) != "\\u") return fail(ReadError::BAD_UTF8, field);
+        pos_ += 2;
+        if (!read_hex4(low)) return fail(ReadError::SYNTAX);
+        if (low < 0xdc00 || low > 0xdfff) return fail(ReadError::BAD_UTF8, field);
+        cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+    }
+    append_utf8_(scratch_, cp);
+    return true;
+}
+
+bool Reader::utf8_(std::string_view field) noexcept
+{
+    // RFC 3629: без overlong-последовательностей, суррогатов и значений больше U+10FFFF
+    const auto byte = [this](size_t i) {
+        return (pos_ + i < json_.size()) ? static_cast<unsigned char>(json_[pos_ + i]) : 0u;
+    };
+    const auto cont = [](unsigned b, unsigned lo = 0x80, unsigned hi = 0xbf) {
+        return b >= lo && b <= hi;
+    };
+
+    const unsigned b0 = byte(0);
+    size_t size = 0;
+    if (b0 >= 0xc2 && b0 <= 0xdf) {
+        size = cont(byte(1)) ? 2 : 0;
+    } else if (b0 >= 0xe0 && b0 <= 0xef) {
+        const unsigned lo = (b0 == 0xe0) ? 0xa0 : 0x80;
+        const unsigned hi = (b0 == 0xed) ? 0x9f : 0xbf;
+        size = (cont(byte(1), lo, hi) && cont(byte(2))) ? 3 : 0;
+    } else if (b0 >= 0xf0 && b0 <= 0xf4) {
+        const unsigned lo = (b0 == 0xf0) ? 0x90 : 0x80;
+        const unsigned hi = (b0 == 0xf4) ? 0x8f : 0xbf;
+        size = (cont(byte(1), lo, hi) && cont(byte(2)) && cont(byte(3))) ? 4 : 0;
+    }
+    if (!size) return fail(ReadError::BAD_UTF8, field);
+    pos_ += size;
+    return true;
+}
+
+bool Reader::literal_(std::string_view word) noexcept
+{
+    if (json_.substr(pos_, word.size()) != word) return fail(ReadError::SYNTAX);
+    pos_ += word.size();
+    return true;
+}
+
+bool Reader::number_() noexcept
+{
+    // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    auto digits = [this] {
+        size_t from = pos_;
+        while (pos_ < json_.size() && is_digit_(json_[pos_])) ++pos_;
+        return pos_ > from;
+    };
+    auto peek = [this](char ch) { return pos_ < json_.size() && json_[pos_] == ch; };
+
+    if (peek('-')) ++pos_;
+    if (peek('0')) {
+        ++pos_;
+    } else if (!digits()) {
+        return fail(ReadError::SYNTAX);
+    }
+    if (peek('.')) {
+        ++pos_;
+        if (!digits()) return fail(ReadError::SYNTAX);
+    }
+    if (peek('e') || peek('E')) {
+        ++pos_;
+        if (peek('+') || peek('-')) ++pos_;
+        if (!digits()) return fail(ReadError::SYNTAX);
+    }
+    return true;
+}
+
+bool Reader::skip_value() noexcept
+{
+    // вложенность без рекурсии: бит 1 в 'objects' - уровень является объектом
+    uint64_t objects = 0;
+    size_t   depth   = 0;
+
+    for (;;) {
+        // очередное значение
+        skip_ws_();
+        if (pos_ >= json_.size()) return fail(ReadError::SYNTAX);
+
+        const char ch = json_[pos_];
+        bool done = true;   // значение разобрано целиком
+        if (ch == '{' || ch == '[') {
+            if (depth == skip_max_depth) return fail(ReadError::TOO_DEEP);
+            const bool object = (ch == '{');
+            objects = (objects << 1) | (object ? 1 : 0);
+            ++depth;
+            ++pos_;
+
+            skip_ws_();
+            if (pos_ < json_.size() && json_[pos_] == (object ? '}' : ']')) {
+                ++pos_;
+                objects >>= 1;
+                --depth;
+            } else {
+                std::string_view key;
+                if (object && !key_(key)) return false;
+                done = false;
+            }
+        } else if (ch == '"') {
+            std::string_view value;
+            size_t length = 0;
+            if (!string_({}, value, length)) return false;
+        } else if (ch == 't') {
+            if (!literal_("true")) return false;
+        } else if (ch == 'f') {
+            if (!literal_("false")) return false;
+        } else if (ch == 'n') {
+            if (!literal_("null")) return false;
+        } else if (ch == '-' || is_digit_(ch)) {
+            if (!number_()) return false;
+        } else {
+            return fail(ReadError::SYNTAX);
+        }
+        if (!done) continue;
+
+        // закрываем завершенные массивы и объекты, либо переходим к следующему элементу
+        for (;;) {
+            if (depth == 0) return true;
+
+            skip_ws_();
+            if (pos_ >= json_.size()) return fail(ReadError::SYNTAX);
+            const bool object = objects & 1;
+            if (json_[pos_] == (object ? '}' : ']')) {
+                ++pos_;
+                objects >>= 1;
+                --depth;
+                continue;
+            }
+            if (json_[pos_] != ',') return fail(ReadError::SYNTAX);
+            ++pos_;
+            std::string_view key;
+            if (object && !key_(key)) return false;
+            break;
+        }
+    }
+}
+
+} // namespace JsonHelpers
+
+} // namespace SocialNetwork
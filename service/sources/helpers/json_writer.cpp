@@ -0,0 +1,52 @@
+#include "helpers/json_writer.h"
+
+namespace SocialNetwork {
+
+namespace JsonHelpers {
+
+// 0 - символ копируется как есть, 'u' - \u00XX, иначе - символ после '\'
+static constexpr auto escape_table_ = [] {
+    std::array<char, 256> t{};
+    for (int ch = 0; ch < 0x20; ++ch) t[ch] = 'u';
+    t['\b'] = 'b';
+    t['\f'] = 'f';
+    t['\n'] = 'n';
+    t['\r'] = 'r';
+    t['\t'] = 't';
+    t['"']  = '"';
+    t['\\'] = '\\';
+    return t;
+}();
+
+void escape_string(std::string& out, std::string_view s)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    out.reserve(out.size() + s.size() + 2);
+    out.push_back('"');
+
+    // копируем участки без спецсимволов целиком
+    size_t begin = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        const char esc = escape_table_[static_cast<unsigned char>(s[i])];
+        if (!esc) continue;
+
+        out.append(s.data() + begin, i - begin);
+        begin = i + 1;
+        if (esc == 'u') {
+            const auto ch = static_cast<unsigned char>(s[i]);
+            const char seq[] = {'\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0x0f]};
+            out.append(seq, sizeof(seq));
+        } else {
+            const char seq[] = {'\\', esc};
+            out.append(seq, sizeof(seq));
+        }
+    }
+    out.append(s.data() + begin, s.size() - begin);
+
+    out.push_back('"');
+}
+
+} // namespace JsonHelpers
+
+} // namespace SocialNetwork
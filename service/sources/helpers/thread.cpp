@@ -1,5 +1,12 @@
 #include <pthread.h>
+#include <sched.h>
 #include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <fstream>
+#include <thread>
 #include "helpers/thread.h"
 
 namespace SocialNetwork {
@@ -88,6 +95,79 @@ std::string get_name(pthread_t th)
     return std::string(name);
 }
 
+// квота cgroup в ядрах (с округлением вверх), 0 - квоты нет
+static size_t cgroup_cpu_quota_()
+{
+    long long quota = 0;
+    long long period = 0;
+
+    // cgroup v2: "<quota> <period>" или "max <period>"
+    if (std::ifstream cpu_max("/sys/fs/cgroup/cpu.max"); cpu_max) {
+        std::string quota_str;
+        if (!(cpu_max >> quota_str >> period) || quota_str == "max") return 0;
+        try { quota = std::stoll(quota_str); } catch (...) { return 0; }
+    } else {
+        // cgroup v1: -1 - квоты нет
+        std::ifstream quota_file("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+        std::ifstream period_file("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+        if (!(quota_file >> quota) || !(period_file >> period)) return 0;
+    }
+
+    if (quota <= 0 || period <= 0) return 0;
+    return static_cast<size_t>((quota + period - 1) / period);
+}
+
+size_t available_cpus()
+{
+    size_t cpus = std::thread::hardware_concurrency();
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        cpus = static_cast<size_t>(CPU_COUNT(&set));
+    }
+    if (const auto quota = cgroup_cpu_quota_(); quota > 0 && quota < cpus) {
+        cpus = quota;
+    }
+    return cpus > 0 ? cpus : 1;
+}
+
+pid_t current_tid() noexcept
+{
+    return static_cast<pid_t>(::syscall(SYS_gettid));
+}
+
+bool is_runnable(pid_t tid)
+{
+    // "<pid> (<comm>) <state> ...", имя потока может содержать пробелы и скобки
+    std::ifstream stat("/proc/self/task/" + std::to_string(tid) + "/stat");
+    std::string line;
+    if (!std::getline(stat, line)) return false;
+    const auto comm_end = line.rfind(')');
+    return comm_end != std::string::npos && comm_end + 2 < line.size() && line[comm_end + 2] == 'R';
+}
+
+void futex_wait(std::atomic<uint32_t>& word, uint32_t expected) noexcept
+{
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+void futex_wait_for(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) noexcept
+{
+    if (timeout <= std::chrono::nanoseconds::zero()) return;
+    const auto sec = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    struct timespec ts{};
+    ts.tv_sec  = static_cast<time_t>(sec.count());
+    ts.tv_nsec = static_cast<long>((timeout - sec).count());
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);
+}
+
+void futex_wake(std::atomic<uint32_t>& word, int count) noexcept
+{
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
 } // namespace ThreadHelpers
 
 } // namespace SocialNetwork
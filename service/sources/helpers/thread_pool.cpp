@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <format>
+#include <mutex>
 #include "helpers/thread.h"
 #include "helpers/thread_pool.h"
 
@@ -6,55 +8,402 @@ namespace SocialNetwork {
 
 namespace ThreadHelpers {
 
+// пулы процесса для ThreadPool::for_each()
+static std::mutex& pools_mutex_()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+static std::vector<const ThreadPool*>& pools_()
+{
+    static std::vector<const ThreadPool*> pools;
+    return pools;
+}
+
+static void add_timing_(std::array<std::atomic<uint64_t>, ThreadPool::timing_bounds_ns.size() + 1>& buckets,
+                        std::atomic<uint64_t>& sum_ns, uint64_t ns) noexcept
+{
+    const auto& bounds = ThreadPool::timing_bounds_ns;
+    auto& bucket = buckets[std::lower_bound(bounds.begin(), bounds.end(), ns) - bounds.begin()];
+    // пишет только поток-владелец части статистики
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum_ns.store(sum_ns.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+}
+
 ThreadPool::~ThreadPool()
 {
+    {
+        std::lock_guard<std::mutex> lock(pools_mutex_());
+        std::erase(pools_(), this);
+    }
+
     threads_stop_ = true;
-    tasks_condition_.notify_all();
+    // сначала управляющий поток, чтобы он не запускал и не присоединял потоки
+    control_epoch_.fetch_add(1, std::memory_order_release);
+    futex_wake(control_epoch_, INT_MAX);
+    if (control_thread_.joinable()) control_thread_.join();
+
+    wake_epoch_.fetch_add(1, std::memory_order_release);
+    futex_wake(wake_epoch_, INT_MAX);
     for (auto& th : threads_) {
-        th.join();
+        if (th.joinable()) th.join();
+    }
+    // задачи, оставшиеся в деках, не выполняются, как и оставшиеся в общей очереди
+    for (auto& deque : deques_) {
+        while (auto task = deque->pop()) delete *task;
     }
 }
 
 ThreadPool::ThreadPool(const std::string_view name,
                        std::shared_ptr<Logging::Logger> logger,
                        uint64_t threads_count,
-                       uint64_t tasks_capacity)
+                       uint64_t tasks_capacity,
+                       Scheduling scheduling,
+                       Elasticity elasticity,
+                       std::vector<unsigned> cpus,
+                       size_t tasks_batch_max)
 :   logger_(std::move(logger)),
-    threads_max_count_(threads_count),
-    tasks_max_capacity_(tasks_capacity)
+    name_(name),
+    threads_min_count_(threads_count),
+    threads_max_count_(std::max(threads_count, elasticity.threads_max_count)),
+    tasks_max_capacity_(tasks_capacity),
+    scheduling_(scheduling),
+    elasticity_(std::move(elasticity)),
+    slots_(std::make_unique<std::atomic<Slot>[]>(threads_max_count_)),
+    tids_(std::make_unique<std::atomic<pid_t>[]>(threads_max_count_)),
+    cpus_limit_(elasticity_.cpus_limit > 0 ? elasticity_.cpus_limit : available_cpus()),
+    cpus_(std::move(cpus)),
+    tasks_batch_max_(std::max<size_t>(tasks_batch_max, 1)),
+    shards_(std::make_unique<shard_s[]>(threads_max_count_)),
+    tasks_(tasks_capacity)
 {
-    std::string name_(name);
-    threads_.reserve(threads_max_count_);
-    for (uint64_t serial = 0; serial < threads_max_count_; ++serial) {
-        std::string thread_name(name_ + std::string("#") + std::to_string(serial));
+    if (CpuTopology::system().nodes().size() > 1) {
+        if (const auto nodes = CpuTopology::system().nodes_of(cpus_); nodes.size() == 1) {
+            bind_to_node(tasks_.storage(), tasks_.storage_bytes(), nodes.front());
+        }
+    }
+
+    if (scheduling_ == Scheduling::WorkStealing) {
+        deques_.reserve(threads_max_count_);
+        for (uint64_t serial = 0; serial < threads_max_count_; ++serial) {
+            deques_.push_back(std::make_unique<LocalDeque>(tasks_max_capacity_));
+        }
+    }
+
+    threads_.resize(threads_max_count_);
+    for (uint64_t serial = 0; serial < threads_min_count_; ++serial) {
+        start_thread_(serial);
+    }
 
-        threads_.emplace_back(&ThreadPool::run, this, thread_name);
-        ThreadHelpers::set_name(threads_.back().native_handle(), thread_name);
+    if (elastic_()) {
+        control_thread_ = std::thread(&ThreadPool::control, this);
+        ThreadHelpers::set_name(control_thread_.native_handle(), name_ + std::string("#ctl"));
     }
+
+    std::lock_guard<std::mutex> lock(pools_mutex_());
+    pools_().push_back(this);
 }
 
 void ThreadPool::wait_all()
 {
-    std::unique_lock<std::mutex> lock(task_results_all_mutex_);
-    task_results_all_condition_.wait(lock, [this]()->bool {
-        return ((statistic_.tasks_completed_count + statistic_.tasks_refused_count) == statistic_.tasks_last_id);
-    });
+    results_waiters_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (;;) {
+        const auto epoch = results_epoch_.load(std::memory_order_acquire);
+        if ((statistic_.tasks_completed_count + statistic_.tasks_refused_count) == statistic_.tasks_last_id) break;
+        futex_wait(results_epoch_, epoch);
+    }
+    results_waiters_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+size_t ThreadPool::add_tasks(std::span<PooledTask> tasks)
+{
+    const uint64_t first_id  = statistic_.tasks_last_id.fetch_add(tasks.size());
+    const uint64_t queued_ns = timing_stamp_();
+    size_t accepted = 0;
+
+    // из потока этого же пула (WorkStealing) - в его деку, пока в ней есть место
+    if (auto* deque = local_deque_()) {
+        for (; accepted < tasks.size(); ++accepted) {
+            auto queued = std::make_unique<QueuedTask>(std::move(tasks[accepted]), TaskMeta(first_id + accepted, queued_ns));
+            if (!deque->push(queued.get())) {
+                tasks[accepted] = std::move(queued->first);
+                break;
+            }
+            queued.release();
+        }
+    }
+    while (accepted < tasks.size()) {
+        const auto pushed = tasks_.try_emplace_bulk(tasks.size() - accepted, [&](size_t i) {
+            return QueuedTask(std::move(tasks[accepted + i]), TaskMeta(first_id + accepted + i, queued_ns));
+        });
+        if (pushed == 0) break;
+        accepted += pushed;
+    }
+    if (accepted > 0) wake_worker_(static_cast<uint32_t>(std::min<size_t>(accepted, UINT32_MAX)));
+
+    if (accepted < tasks.size()) {
+        // очередь заполнена: остальные задачи отклоняются
+        statistic_.tasks_refused_count += tasks.size() - accepted;
+        notify_results_();
+        for (size_t i = accepted; i < tasks.size(); ++i) tasks[i].refuse();
+    }
+    return accepted;
+}
+
+uint64_t ThreadPool::tasks_active_count() const
+{
+    uint64_t count = tasks_.size();
+    for (const auto& deque : deques_) count += deque->size();
+    return count;
+}
+
+uint64_t ThreadPool::threads_busy_count() const
+{
+    uint64_t count = 0;
+    for (uint64_t serial = 0; serial < threads_max_count_; ++serial) {
+        if (shards_[serial].busy.load(std::memory_order_relaxed)) ++count;
+    }
+    return count;
+}
+
+void ThreadPool::tasks_timings(Timings& wait, Timings& run) const
+{
+    wait = {};
+    run  = {};
+    for (uint64_t serial = 0; serial < threads_max_count_; ++serial) {
+        const auto& shard = shards_[serial];
+        for (size_t i = 0; i < shard.wait.size(); ++i) {
+            wait.buckets[i] += shard.wait[i].load(std::memory_order_relaxed);
+            run.buckets[i]  += shard.run[i].load(std::memory_order_relaxed);
+        }
+        wait.sum_ns += shard.wait_sum_ns.load(std::memory_order_relaxed);
+        run.sum_ns  += shard.run_sum_ns.load(std::memory_order_relaxed);
+    }
+}
+
+void ThreadPool::for_each(const std::function<void(const ThreadPool&)>& func)
+{
+    std::lock_guard<std::mutex> lock(pools_mutex_());
+    for (const auto* pool : pools_()) func(*pool);
 }
 
 // --------------------------------------------------------
 
-void ThreadPool::run(const std::string thread_name)
+void ThreadPool::start_thread_(size_t serial)
+{
+    std::string thread_name(name_ + std::string("#") + std::to_string(serial));
+
+    tids_[serial].store(0, std::memory_order_relaxed);
+    slots_[serial].store(Slot::Running, std::memory_order_relaxed);
+    ++threads_running_;
+    threads_[serial] = std::thread(&ThreadPool::run, this, serial, thread_name);
+    ThreadHelpers::set_name(threads_[serial].native_handle(), thread_name);
+    if (!cpus_.empty()) {
+        const auto cpu = cpus_[serial % cpus_.size()];
+        if (!pin_thread(threads_[serial].native_handle(), cpu)) {
+            LOG_WARNG(std::format("thread {} cannot be pinned to cpu {}", thread_name, cpu));
+        }
+    }
+}
+
+bool ThreadPool::retire_thread_(size_t serial)
+{
+    // минимум потоков остается всегда
+    auto running = threads_running_.load(std::memory_order_relaxed);
+    do {
+        if (running <= threads_min_count_) return false;
+    } while (!threads_running_.compare_exchange_weak(running, running - 1, std::memory_order_relaxed));
+
+    ++statistic_.threads_retired_count;
+    if (elasticity_.on_resize) elasticity_.on_resize(-1);
+    LOG_DEBUG(std::format("thread {}#{} retired after idle timeout, threads: {}", name_, serial, running - 1));
+    slots_[serial].store(Slot::Retired, std::memory_order_release);
+    return true;
+}
+
+void ThreadPool::control()
 {
     ThreadHelpers::block_signals();
+
+    // задачи, добавленные до предыдущей проверки: если какая-то из них, не
+    // отклоненная, еще не начала выполняться, она ждет в очереди дольше grow_delay
+    uint64_t added_before = 0;
+
     while (!threads_stop_) {
-        std::unique_lock<std::mutex> lock(tasks_mutex_);
-        tasks_condition_.wait(lock, [this]()->bool { return !tasks_.empty() || threads_stop_; });
+        const auto epoch = control_epoch_.load(std::memory_order_acquire);
+        futex_wait_for(control_epoch_, epoch, elasticity_.grow_delay);
+        if (threads_stop_) break;
+
+        // места завершившихся потоков освобождаются для новых
+        for (uint64_t serial = 0; serial < threads_max_count_; ++serial) {
+            if (slots_[serial].load(std::memory_order_acquire) == Slot::Retired) {
+                threads_[serial].join();
+                slots_[serial].store(Slot::Free, std::memory_order_relaxed);
+            }
+        }
+
+        const uint64_t done    = statistic_.tasks_started_count + statistic_.tasks_refused_count;
+        const uint64_t waiting = added_before > done ? added_before - done : 0;
+        added_before = statistic_.tasks_last_id;
+        if (waiting == 0) continue;
+
+        // новый поток поможет очереди, только если процессор не занят: потоки,
+        // заблокированные вводом-выводом или блокировками, ядро не занимают, а
+        // готовых выполняться потоков не должно быть больше доступных ядер
+        const auto running  = threads_running_.load(std::memory_order_relaxed);
+        const auto runnable = runnable_threads_();
+        if (runnable >= cpus_limit_) continue;
+
+        const auto grow  = std::min({waiting, threads_max_count_ - running, cpus_limit_ - runnable});
+        uint64_t   grown = 0;
+        for (uint64_t serial = 0; serial < threads_max_count_ && grown < grow; ++serial) {
+            if (slots_[serial].load(std::memory_order_relaxed) != Slot::Free) continue;
+            start_thread_(serial);
+            ++grown;
+        }
+        if (grown == 0) continue;
+
+        statistic_.threads_grown_count += grown;
+        if (elasticity_.on_resize) elasticity_.on_resize(static_cast<int>(grown));
+        LOG_DEBUG(std::format("thread pool {}: {} tasks wait longer than {} ms, {} of {} threads runnable, threads: {} -> {}",
+            name_, waiting, elasticity_.grow_delay.count(), runnable, running, running, running + grown));
+    }
+}
+
+uint64_t ThreadPool::runnable_threads_() const
+{
+    uint64_t runnable = 0;
+    for (uint64_t serial = 0; serial < threads_max_count_; ++serial) {
+        if (slots_[serial].load(std::memory_order_acquire) != Slot::Running) continue;
+        const auto tid = tids_[serial].load(std::memory_order_relaxed);
+        if (tid != 0 && is_runnable(tid)) ++runnable;
+    }
+    return runnable;
+}
+
+bool ThreadPool::push_local_(LocalDeque& deque, PooledTask& task, uint64_t id)
+{
+    auto queued = std::make_unique<QueuedTask>(std::move(task), TaskMeta(id, timing_stamp_()));
+    if (deque.push(queued.get())) {
+        queued.release();
+    } else if (!tasks_.try_push(std::move(*queued))) {
+        // возвращаем задачу вызывающему, чтобы сообщить об отказе
+        task = std::move(queued->first);
+        return false;
+    }
+    wake_worker_();
+    return true;
+}
+
+size_t ThreadPool::take_tasks_(size_t serial, std::vector<QueuedTask>& batch)
+{
+    // владение задачей из деки переходит к вызывающему
+    const auto own = [&batch](QueuedTask* task) {
+        std::unique_ptr<QueuedTask> owned(task);
+        batch.push_back(std::move(*owned));
+        return size_t{1};
+    };
+    // из общей очереди - не больше своей доли задач
+    const auto take_shared = [this, &batch]() {
+        size_t limit = 1;
+        if (tasks_batch_max_ > 1 && !elastic_()) {
+            const auto running = std::max<uint64_t>(threads_running_.load(std::memory_order_relaxed), 1);
+            limit = std::clamp<size_t>(tasks_.size() / running, 1, tasks_batch_max_);
+        }
+        return tasks_.try_pop_bulk(limit, [&batch](QueuedTask&& task) { batch.push_back(std::move(task)); });
+    };
 
-        if (!tasks_.empty() && !threads_stop_) {
-            auto task = std::move(tasks_.front());
-            tasks_.pop();
-            lock.unlock();
+    if (deques_.empty()) return take_shared();
 
+    // сначала своя дека (последняя добавленная задача), затем общая очередь,
+    // затем самые старые задачи из дек других потоков
+    if (auto task = deques_[serial]->pop()) return own(*task);
+    if (auto taken = take_shared()) return taken;
+    for (size_t i = 1; i < deques_.size(); ++i) {
+        if (auto task = deques_[(serial + i) % deques_.size()]->steal()) {
+            ++statistic_.tasks_stolen_count;
+            return own(*task);
+        }
+    }
+    return 0;
+}
+
+bool ThreadPool::has_tasks_() const noexcept
+{
+    if (tasks_.size() > 0) return true;
+    for (const auto& deque : deques_) {
+        if (deque->size() > 0) return true;
+    }
+    return false;
+}
+
+size_t ThreadPool::pop_tasks_(size_t serial, std::vector<QueuedTask>& batch)
+{
+    for (unsigned spin = 0;; ++spin) {
+        if (auto taken = take_tasks_(serial, batch)) return taken;
+        if (spin == idle_spins_) return 0;
+        std::this_thread::yield();
+    }
+}
+
+bool ThreadPool::wait_task_()
+{
+    // эпоха читается до регистрации спящего: если производитель добавит задачу
+    // после проверки очереди, он увидит спящего и сменит эпоху, и futex не уснет
+    const auto epoch = wake_epoch_.load(std::memory_order_acquire);
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool idle = false;
+    if (!has_tasks_() && !threads_stop_) {
+        if (!elastic_()) {
+            futex_wait(wake_epoch_, epoch);
+        } else {
+            const auto deadline = std::chrono::steady_clock::now() + elasticity_.idle_timeout;
+            while (wake_epoch_.load(std::memory_order_acquire) == epoch && !threads_stop_) {
+                const auto now = std::chrono::steady_clock::now();
+                if (now >= deadline) {
+                    idle = true;
+                    break;
+                }
+                futex_wait_for(wake_epoch_, epoch, deadline - now);
+            }
+        }
+    }
+    sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+    if (!idle) return true;
+
+    // производитель мог добавить задачу, пока поток еще считался спящим, и
+    // разбудить именно его: тогда поток остается
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return has_tasks_() || wake_epoch_.load(std::memory_order_acquire) != epoch;
+}
+
+void ThreadPool::run(size_t serial, const std::string thread_name)
+{
+    ThreadHelpers::block_signals();
+    current_worker_ = {this, serial};
+    tids_[serial].store(current_tid(), std::memory_order_relaxed);
+
+    auto& shard = shards_[serial];
+    std::vector<QueuedTask> batch;
+    batch.reserve(tasks_batch_max_);
+    while (!threads_stop_) {
+        const auto taken = pop_tasks_(serial, batch);
+        if (taken == 0) {
+            if (!wait_task_() && retire_thread_(serial)) return;
+            continue;
+        }
+        statistic_.tasks_started_count += taken;
+        shard.busy.store(true, std::memory_order_relaxed);
+
+        // окончание задачи - начало следующей задачи пачки
+        uint64_t started = timing_stamp_();
+        for (auto& task : batch) {
+            if (started != 0 && task.second.queued_ns_ != 0) {
+                add_timing_(shard.wait, shard.wait_sum_ns, started - std::min(started, task.second.queued_ns_));
+            }
             LOG_TRACE(std::format("thread {}, start processing task #{}",
                 thread_name, task.second.id_));
             try {
@@ -66,12 +415,17 @@ void ThreadPool::run(const std::string thread_name)
             }
             LOG_TRACE(std::format("thread {}, end processing task #{}",
                 thread_name, task.second.id_));
-
-            if (task.second.cb_) task.second.cb_(task.first.get_result());
-            ++statistic_.tasks_completed_count;
+            if (started != 0) {
+                const auto finished = timing_stamp_();
+                if (finished != 0) add_timing_(shard.run, shard.run_sum_ns, finished - started);
+                started = finished;
+            }
         }
+        batch.clear();
+        shard.busy.store(false, std::memory_order_relaxed);
 
-        task_results_all_condition_.notify_all();
+        statistic_.tasks_completed_count += taken;
+        notify_results_();
     }
 }
 
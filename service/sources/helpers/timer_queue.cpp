@@ -0,0 +1,79 @@
+#include "helpers/thread.h"
+#include "helpers/timer_queue.h"
+
+namespace SocialNetwork {
+
+namespace ThreadHelpers {
+
+TimerQueue::TimerQueue(const std::string& name)
+{
+    thread_ = std::thread(&TimerQueue::run_, this);
+    ThreadHelpers::set_name(thread_.native_handle(), name);
+}
+
+TimerQueue::~TimerQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    condition_.notify_one();
+    thread_.join();
+
+    for (auto& [key, task] : timers_) task.refuse();
+}
+
+TimerQueue& TimerQueue::shared()
+{
+    static TimerQueue queue("TimerQueue");
+    return queue;
+}
+
+TimerQueue::Timer TimerQueue::add(clock_t::time_point at, PooledTask task)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Timer timer{at, ++last_id_};
+    auto it = timers_.emplace(std::make_pair(at, timer.id), std::move(task)).first;
+    // поток ждет ближайший срок, будим его, только если новый срок раньше
+    if (it == timers_.begin()) condition_.notify_one();
+    return timer;
+}
+
+bool TimerQueue::cancel(const Timer& timer)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return timers_.erase(std::make_pair(timer.at, timer.id)) > 0;
+}
+
+void TimerQueue::run_()
+{
+    ThreadHelpers::block_signals();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        if (timers_.empty()) {
+            condition_.wait(lock);
+            continue;
+        }
+        const auto at = timers_.begin()->first.first;
+        if (clock_t::now() < at) {
+            condition_.wait_until(lock, at);
+            continue;
+        }
+
+        auto task = std::move(timers_.begin()->second);
+        timers_.erase(timers_.begin());
+        // задача может сама добавлять и отменять задачи очереди
+        lock.unlock();
+        try {
+            task();
+        }
+        catch (...) {
+            // исключение задачи уже передано ее обратному вызову
+        }
+        lock.lock();
+    }
+}
+
+} // namespace ThreadHelpers
+
+} // namespace SocialNetwork
@@ -0,0 +1,74 @@
+#include "helpers/uuid.h"
+
+namespace SocialNetwork {
+
+namespace UuidHelpers {
+
+// значение шестнадцатеричной цифры, 0xff - не цифра
+static constexpr auto hex_values_ = [] {
+    std::array<uint8_t, 256> t{};
+    t.fill(0xff);
+    for (int ch = '0'; ch <= '9'; ++ch) t[ch] = static_cast<uint8_t>(ch - '0');
+    for (int ch = 'a'; ch <= 'f'; ++ch) t[ch] = static_cast<uint8_t>(ch - 'a' + 10);
+    for (int ch = 'A'; ch <= 'F'; ++ch) t[ch] = static_cast<uint8_t>(ch - 'A' + 10);
+    return t;
+}();
+
+// две шестнадцатеричные цифры для каждого значения байта
+static constexpr auto hex_pairs_ = [] {
+    constexpr char digits[] = "0123456789abcdef";
+    std::array<char, 512> t{};
+    for (size_t i = 0; i < 256; ++i) {
+        t[2 * i]     = digits[i >> 4];
+        t[2 * i + 1] = digits[i & 0x0f];
+    }
+    return t;
+}();
+
+// позиция первой цифры каждого байта в канонической записи
+static constexpr std::array<uint8_t, Uuid::size_bytes> offsets_{
+    0, 2, 4, 6, 9, 11, 14, 16, 19, 21, 24, 26, 28, 30, 32, 34
+};
+
+std::optional<Uuid> Uuid::parse(std::string_view s) noexcept
+{
+    if (s.size() != size_string) return std::nullopt;
+
+    // без ветвлений внутри: ошибки накапливаются в 'bad', т.к. у любой
+    // не-цифры в таблице выставлены старшие биты
+    const auto* p = reinterpret_cast<const unsigned char*>(s.data());
+    unsigned bad = (p[8] ^ '-') | (p[13] ^ '-') | (p[18] ^ '-') | (p[23] ^ '-');
+
+    Bytes bytes;
+    for (size_t i = 0; i < size_bytes; ++i) {
+        const unsigned hi = hex_values_[p[offsets_[i]]];
+        const unsigned lo = hex_values_[p[offsets_[i] + 1]];
+        bad |= (hi | lo) & 0xf0;
+        bytes[i] = static_cast<std::byte>((hi << 4) | (lo & 0x0f));
+    }
+
+    if (bad) return std::nullopt;
+    return Uuid(bytes);
+}
+
+Uuid::String Uuid::to_chars() const noexcept
+{
+    String out;
+    out[8] = out[13] = out[18] = out[23] = '-';
+    for (size_t i = 0; i < size_bytes; ++i) {
+        const auto value = std::to_integer<size_t>(bytes_[i]);
+        out[offsets_[i]]     = hex_pairs_[2 * value];
+        out[offsets_[i] + 1] = hex_pairs_[2 * value + 1];
+    }
+    return out;
+}
+
+std::string Uuid::to_string() const
+{
+    const auto chars = to_chars();
+    return std::string(chars.data(), chars.size());
+}
+
+} // namespace UuidHelpers
+
+} // namespace SocialNetwork
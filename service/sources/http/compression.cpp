@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <ctime>
+#include "http/compression.h"
+
+#ifdef HTTP_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HTTP_WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HTTP_WITH_BROTLI
+#include <brotli/encode.h>
+#endif
+
+namespace SocialNetwork {
+
+namespace Http {
+
+// уровни сжатия подобраны под ответы API: десятки килобайт JSON,
+// сжатие которых не должно заметно добавлять к времени ответа
+constexpr int gzip_level   = 3;
+constexpr int zstd_level   = 3;
+constexpr int brotli_level = 4;
+
+#ifdef HTTP_WITH_ZLIB
+struct deflate_s {
+    z_stream stream{};
+    bool     ready{false};
+
+    deflate_s() {
+        // 15 + 16 - окно 32 КБ и заголовок gzip вместо zlib
+        ready = (deflateInit2(&stream, gzip_level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+    }
+    ~deflate_s() {
+        if (ready) deflateEnd(&stream);
+    }
+};
+
+static bool gzip_(std::string_view in, std::string& out)
+{
+    thread_local deflate_s ctx;
+    if (!ctx.ready || deflateReset(&ctx.stream) != Z_OK) return false;
+
+    auto& stream = ctx.stream;
+    out.resize(deflateBound(&stream, in.size()));
+    stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    stream.avail_in  = static_cast<uInt>(in.size());
+    stream.next_out  = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END) return false;
+    out.resize(stream.total_out);
+    return true;
+}
+#endif
+
+#ifdef HTTP_WITH_ZSTD
+struct zstd_s {
+    ZSTD_CCtx* cctx{ZSTD_createCCtx()};
+
+    ~zstd_s() { ZSTD_freeCCtx(cctx); }
+};
+
+static bool zstd_(std::string_view in, std::string& out)
+{
+    thread_local zstd_s ctx;
+    if (!ctx.cctx) return false;
+
+    out.resize(ZSTD_compressBound(in.size()));
+    auto size = ZSTD_compressCCtx(ctx.cctx, out.data(), out.size(), in.data(), in.size(), zstd_level);
+    if (ZSTD_isError(size)) return false;
+    out.resize(size);
+    return true;
+}
+#endif
+
+#ifdef HTTP_WITH_BROTLI
+static bool brotli_(std::string_view in, std::string& out)
+{
+    // у brotli нет сброса состояния кодировщика, поэтому используется
+    // однопроходное сжатие, которое само управляет своей памятью
+    out.resize(BrotliEncoderMaxCompressedSize(in.size()));
+    size_t size = out.size();
+    if (!BrotliEncoderCompress(brotli_level, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                               in.size(), reinterpret_cast<const uint8_t*>(in.data()),
+                               &size, reinterpret_cast<uint8_t*>(out.data()))) return false;
+    out.resize(size);
+    return true;
+}
+#endif
+
+static double thread_cpu_seconds_()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+static std::string_view trim_(std::string_view s)
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// q-значение (RFC 9110, 12.4.2) в тысячных, -1 - значение некорректно
+static int parse_qvalue_(std::string_view s)
+{
+    if (s.empty() || (s[0] != '0' && s[0] != '1')) return -1;
+    int value = (s[0] - '0') * 1000;
+    if (s.size() == 1) return value;
+    if (s[1] != '.' || s.size() > 5) return -1;
+    int scale = 100;
+    for (auto ch : s.substr(2)) {
+        if (ch < '0' || ch > '9') return -1;
+        value += (ch - '0') * scale;
+        scale /= 10;
+    }
+    return value <= 1000 ? value : -1;
+}
+
+std::string_view to_string(Encoding encoding) noexcept
+{
+    switch (encoding) {
+    case Encoding::GZIP:   return "gzip";
+    case Encoding::ZSTD:   return "zstd";
+    case Encoding::BROTLI: return "br";
+    default:               return "identity";
+    }
+}
+
+bool is_supported(Encoding encoding) noexcept
+{
+    switch (encoding) {
+#ifdef HTTP_WITH_ZLIB
+    case Encoding::GZIP:   return true;
+#endif
+#ifdef HTTP_WITH_ZSTD
+    case Encoding::ZSTD:   return true;
+#endif
+#ifdef HTTP_WITH_BROTLI
+    case Encoding::BROTLI: return true;
+#endif
+    default:               return false;
+    }
+}
+
+Encoding negotiate(std::string_view accept_encoding) noexcept
+{
+    // q для каждой кодировки, -1 - кодировка не упомянута
+    std::array<int, encodings_count> q;
+    q.fill(-1);
+    int any = -1;   // "*"
+
+    while (!accept_encoding.empty()) {
+        auto comma = accept_encoding.find(',');
+        auto item  = accept_encoding.substr(0, comma);
+        accept_encoding.remove_prefix(comma == std::string_view::npos ? accept_encoding.size() : comma + 1);
+
+        auto semicolon = item.find(';');
+        auto coding    = trim_(item.substr(0, semicolon));
+        int  value     = 1000;
+        if (semicolon != std::string_view::npos) {
+            auto param = trim_(item.substr(semicolon + 1));
+            if (param.size() < 2 || (param[0] != 'q' && param[0] != 'Q') || param[1] != '=') continue;
+            value = parse_qvalue_(param.substr(2));
+            if (value < 0) continue;
+        }
+
+        auto is = [&coding](std::string_view name) {
+            return coding.size() == name.size()
+                && std::equal(coding.begin(), coding.end(), name.begin(),
+                              [](char a, char b) { return (a | 0x20) == b; });
+        };
+        if      (is("gzip") || is("x-gzip")) q[static_cast<size_t>(Encoding::GZIP)]   = value;
+        else if (is("zstd"))                 q[static_cast<size_t>(Encoding::ZSTD)]   = value;
+        else if (is("br"))                   q[static_cast<size_t>(Encoding::BROTLI)] = value;
+        else if (coding == "*")              any = value;
+    }
+
+    auto result = Encoding::IDENTITY;
+    int  best   = 0;
+    for (auto encoding : {Encoding::ZSTD, Encoding::BROTLI, Encoding::GZIP}) {
+        if (!is_supported(encoding)) continue;
+        int value = q[static_cast<size_t>(encoding)];
+        if (value < 0) value = any;
+        if (value > best) {
+            best   = value;
+            result = encoding;
+        }
+    }
+    return result;
+}
+
+bool compress(Encoding encoding, std::string_view in, std::string& out, CompressionStats& stats)
+{
+    const auto started = thread_cpu_seconds_();
+    bool ok = false;
+    switch (encoding) {
+#ifdef HTTP_WITH_ZLIB
+    case Encoding::GZIP:   ok = gzip_(in, out);   break;
+#endif
+#ifdef HTTP_WITH_ZSTD
+    case Encoding::ZSTD:   ok = zstd_(in, out);   break;
+#endif
+#ifdef HTTP_WITH_BROTLI
+    case Encoding::BROTLI: ok = brotli_(in, out); break;
+#endif
+    default:               break;
+    }
+    if (!ok) return false;
+
+    stats.plain_size   = in.size();
+    stats.encoded_size = out.size();
+    stats.cpu_seconds  = thread_cpu_seconds_() - started;
+    return true;
+}
+
+const std::string* EncodedBody::encoded(Encoding encoding, std::optional<CompressionStats>& stats) const
+{
+    if (encoding == Encoding::IDENTITY) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& variant = variants_[static_cast<size_t>(encoding)];
+    if (!variant.done) {
+        // сжимаем под мьютексом: одновременные запросы в той же кодировке
+        // дождутся результата, а не будут сжимать то же самое параллельно
+        CompressionStats one;
+        variant.done   = true;
+        variant.useful = compress(encoding, plain_, variant.data, one)
+                      && variant.data.size() < plain_.size();
+        if (variant.useful) {
+            variant.data.shrink_to_fit();
+            stats = one;
+        } else {
+            variant.data = std::string{};
+        }
+    }
+    return variant.useful ? &variant.data : nullptr;
+}
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -0,0 +1,72 @@
+#include <sys/socket.h>
+#include <unistd.h>
+#include "http/connection_manager.h"
+#include "http/http_writer.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+bool ConnectionManager::open(const std::string& ip)
+{
+    if (options_.max_connections_per_ip) {
+        std::lock_guard<std::mutex> lock(per_ip_mutex_);
+        auto& count = per_ip_[ip];
+        if (count >= options_.max_connections_per_ip) {
+            options_.notify_rejected();
+            return false;
+        }
+        ++count;
+    }
+    options_.notify_open_connections(1);
+    return true;
+}
+
+void ConnectionManager::close(const std::string& ip)
+{
+    if (options_.max_connections_per_ip) {
+        std::lock_guard<std::mutex> lock(per_ip_mutex_);
+        auto it = per_ip_.find(ip);
+        if (it != per_ip_.end() && --it->second == 0) per_ip_.erase(it);
+    }
+    options_.notify_open_connections(-1);
+}
+
+void ConnectionManager::reject(int fd) const
+{
+    // сокет только что принят, и короткий ответ помещается в буфер отправки
+    std::string out;
+    write_error_response(httplib::StatusCode::ServiceUnavailable_503, out);
+    [[maybe_unused]] auto rc = send(fd, out.data(), out.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    ::close(fd);
+}
+
+std::optional<ReapReason> ConnectionManager::check(const Connection& conn,
+                                                   std::chrono::steady_clock::time_point now) const
+{
+    if (conn.in_flight() > 0) return std::nullopt;
+
+    const auto silence = now - conn.last_activity;
+    // начатый, но не дочитанный запрос ждет по таймауту чтения
+    if (!conn.is_idle()) {
+        if (silence > std::chrono::seconds(options_.read_timeout_sec)) return ReapReason::READ_TIMEOUT;
+        return std::nullopt;
+    }
+    // соединение без начатого запроса - по keep-alive таймауту,
+    // а пока пул перегружен - по гораздо более короткому
+    if (silence > std::chrono::seconds(options_.keep_alive_timeout_sec)) return ReapReason::IDLE_TIMEOUT;
+    if (saturated()
+    &&  silence > std::chrono::milliseconds(options_.saturated_idle_timeout_ms)) return ReapReason::SATURATED;
+    return std::nullopt;
+}
+
+void ConnectionManager::report_idle(size_t count, size_t& reported) const
+{
+    if (count == reported) return;
+    options_.notify_idle_connections(static_cast<int>(count) - static_cast<int>(reported));
+    reported = count;
+}
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -0,0 +1,478 @@
+#include <chrono>
+#include <format>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include "helpers/cpu_topology.h"
+#include "helpers/ip_address.h"
+#include "helpers/thread.h"
+#include "http/epoll_server.h"
+#include "http/http_connection.h"
+#include "http/http_writer.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+namespace {
+
+// зарезервированные значения epoll_event.data.u64
+constexpr uint64_t listener_event_id = 0;
+constexpr uint64_t wakeup_event_id   = 1;
+
+constexpr int    max_events      = 256;
+constexpr size_t read_chunk_size = 16 * 1024;
+constexpr size_t write_iov_max   = 64;
+
+// как часто проверяются таймауты соединений
+constexpr auto sweep_interval = std::chrono::milliseconds(250);
+
+} // namespace
+
+class EpollServer::Reactor
+{
+public:
+    ~Reactor() {
+        for (auto& [id, conn] : connections_) close(conn->fd);
+        if (wakeup_fd_ >= 0) close(wakeup_fd_);
+        if (epoll_fd_ >= 0) close(epoll_fd_);
+    }
+    Reactor(EpollServer& server, const std::string& name)
+    :   logger_(server.logger_),
+        server_(server),
+        name_(name) {
+        epoll_fd_  = epoll_create1(EPOLL_CLOEXEC);
+        wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epoll_fd_ < 0 || wakeup_fd_ < 0) {
+            throw std::runtime_error(std::format("{}: cannot create epoll/eventfd", name_));
+        }
+
+        epoll_event ev{};
+        ev.events   = EPOLLIN;
+        ev.data.u64 = wakeup_event_id;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev);
+
+        // слушающий сокет разделяется между всеми reactor-потоками,
+        // EPOLLEXCLUSIVE не дает будить их всех на каждое входящее соединение
+        ev.events   = EPOLLIN | EPOLLEXCLUSIVE;
+        ev.data.u64 = listener_event_id;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, server_.listen_fd_, &ev);
+    }
+
+    void run();
+    void wakeup();
+
+    // вызывается из потоков пула, когда ответ на запрос готов
+    void complete(uint64_t conn_id, uint64_t seq, std::string&& data);
+
+    std::thread thread{};
+
+private:
+    struct completion_s {
+        uint64_t    conn_id{0};
+        uint64_t    seq{0};
+        std::string data{};
+    };
+
+    std::shared_ptr<Logging::Logger> logger_{nullptr};
+    EpollServer&                     server_;
+    const std::string                name_{};
+
+    int      epoll_fd_{-1};
+    int      wakeup_fd_{-1};
+    uint64_t last_conn_id_{wakeup_event_id};
+    size_t   idle_reported_{0};
+
+    std::unordered_map<uint64_t, std::unique_ptr<Connection>> connections_{};
+
+    std::mutex                completions_mutex_{};
+    std::vector<completion_s> completions_{};
+
+    std::vector<iovec> iov_{};
+
+    void accept_();
+    void drain_completions_();
+    void on_readable_(Connection& conn);
+    bool on_writable_(Connection& conn);
+    void process_input_(Connection& conn);
+    void dispatch_(Connection& conn, httplib::Request&& req, bool keep_alive, uint64_t seq);
+    void close_(Connection& conn);
+    void sweep_idle_();
+};
+
+void EpollServer::Reactor::run()
+{
+    ThreadHelpers::block_signals();
+
+    epoll_event events[max_events];
+    auto last_sweep = std::chrono::steady_clock::now();
+
+    while (server_.running_) {
+        int n = epoll_wait(epoll_fd_, events, max_events, sweep_interval.count());
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR(std::format("{}: epoll_wait() failed, errno={}", name_, errno));
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            const auto id    = events[i].data.u64;
+            const auto flags = events[i].events;
+
+            if (id == listener_event_id) {
+                accept_();
+                continue;
+            }
+            if (id == wakeup_event_id) {
+                uint64_t value = 0;
+                [[maybe_unused]] auto rc = read(wakeup_fd_, &value, sizeof(value));
+                drain_completions_();
+                continue;
+            }
+
+            auto it = connections_.find(id);
+            if (it == connections_.end()) continue;
+            auto& conn = *it->second;
+
+            if (flags & (EPOLLERR | EPOLLHUP)) {
+                close_(conn);
+                continue;
+            }
+            if (flags & EPOLLOUT) {
+                on_writable_(conn);
+                if (!connections_.contains(id)) continue;
+            }
+            if (flags & (EPOLLIN | EPOLLRDHUP)) {
+                on_readable_(conn);
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_sweep >= sweep_interval) {
+            last_sweep = now;
+            sweep_idle_();
+        }
+    }
+}
+
+void EpollServer::Reactor::wakeup()
+{
+    uint64_t value = 1;
+    [[maybe_unused]] auto rc = write(wakeup_fd_, &value, sizeof(value));
+}
+
+void EpollServer::Reactor::complete(uint64_t conn_id, uint64_t seq, std::string&& data)
+{
+    {
+        std::lock_guard<std::mutex> lock(completions_mutex_);
+        completions_.push_back({conn_id, seq, std::move(data)});
+    }
+    wakeup();
+}
+
+void EpollServer::Reactor::accept_()
+{
+    for (;;) {
+        sockaddr_storage addr{};
+        socklen_t addr_len = sizeof(addr);
+        int fd = accept4(server_.listen_fd_, reinterpret_cast<sockaddr*>(&addr), &addr_len,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_WARNG(std::format("{}: accept4() failed, errno={}", name_, errno));
+            }
+            return;
+        }
+
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+        auto id   = ++last_conn_id_;
+        auto conn = std::make_unique<Connection>(id, fd, server_.options_);
+        try {
+            NetHelpers::SocketAddress peer(reinterpret_cast<const sockaddr*>(&addr), addr_len);
+            conn->remote_addr = peer.host().to_string();
+            conn->remote_port = peer.port();
+        }
+        catch (...) {}
+
+        if (!server_.conn_manager_.open(conn->remote_addr)) {
+            server_.conn_manager_.reject(fd);
+            continue;
+        }
+
+        epoll_event ev{};
+        ev.events   = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.u64 = id;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            server_.conn_manager_.close(conn->remote_addr);
+            close(fd);
+            continue;
+        }
+        connections_.emplace(id, std::move(conn));
+    }
+}
+
+void EpollServer::Reactor::drain_completions_()
+{
+    std::vector<completion_s> ready;
+    {
+        std::lock_guard<std::mutex> lock(completions_mutex_);
+        ready.swap(completions_);
+    }
+
+    server_.options_.notify_inflight(-static_cast<int>(ready.size()));
+
+    for (auto& one : ready) {
+        auto it = connections_.find(one.conn_id);
+        if (it == connections_.end()) continue; // соединение уже закрыто
+        auto& conn = *it->second;
+
+        if (!conn.complete(one.seq, std::move(one.data))) continue;
+        conn.last_activity = std::chrono::steady_clock::now();
+
+        // пока конвейер был заполнен, данные могли прийти без нового события
+        // (edge-triggered), поэтому дочитываем сокет, разбираем буфер
+        // и отправляем готовые ответы
+        on_readable_(conn);
+    }
+}
+
+void EpollServer::Reactor::on_readable_(Connection& conn)
+{
+    // пока конвейер заполнен, копим не больше одного запроса впрок
+    const size_t in_max = server_.options_.headers_max_length + server_.options_.payload_max_length;
+
+    while (!conn.peer_closed && !conn.input_closed) {
+        if (conn.pipeline_full(server_.options_) && conn.in.size() - conn.in_off > in_max) break;
+
+        auto old_size = conn.in.size();
+        conn.in.resize(old_size + read_chunk_size);
+        auto n = recv(conn.fd, conn.in.data() + old_size, read_chunk_size, 0);
+        conn.in.resize(old_size + (n > 0 ? n : 0));
+
+        if (n > 0) {
+            conn.last_activity = std::chrono::steady_clock::now();
+            continue;
+        }
+        if (n == 0) {
+            conn.peer_closed = true;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        close_(conn);
+        return;
+    }
+
+    process_input_(conn);
+}
+
+bool EpollServer::Reactor::on_writable_(Connection& conn)
+{
+    // готовые ответы с начала конвейера отправляются одним вызовом (аналог writev,
+    // но sendmsg позволяет передать MSG_NOSIGNAL)
+    for (;;) {
+        conn.ready_output(iov_, write_iov_max);
+        if (iov_.empty()) break;
+
+        msghdr msg{};
+        msg.msg_iov    = iov_.data();
+        msg.msg_iovlen = iov_.size();
+        auto n = sendmsg(conn.fd, &msg, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn.consume_output(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true; // дождемся EPOLLOUT
+        close_(conn);
+        return false;
+    }
+
+    if (conn.is_finished()) {
+        close_(conn);
+        return false;
+    }
+    return true;
+}
+
+void EpollServer::Reactor::process_input_(Connection& conn)
+{
+    // сначала отправляем готовые ответы, это освобождает места в конвейере
+    if (!on_writable_(conn)) return;
+
+    for (;;) {
+        httplib::Request req;
+        bool     keep_alive = false;
+        uint64_t seq        = 0;
+        auto input = conn.next_request(server_.options_, req, keep_alive, seq);
+        if (input != Connection::Input::REQUEST) break;
+        dispatch_(conn, std::move(req), keep_alive, seq);
+    }
+    if (conn.pipeline_full(server_.options_)) {
+        if (conn.in_off < conn.in.size()) server_.options_.notify_pipeline_stall();
+    } else if (conn.peer_closed) {
+        // клиент закрыл соединение, а целых запросов в буфере больше нет
+        conn.input_closed = true;
+    }
+
+    on_writable_(conn);
+}
+
+void EpollServer::Reactor::dispatch_(Connection& conn, httplib::Request&& req, bool keep_alive, uint64_t seq)
+{
+    struct job_s {
+        Reactor*         reactor{nullptr};
+        uint64_t         conn_id{0};
+        uint64_t         seq{0};
+        bool             keep_alive{false};
+        httplib::Request req{};
+        std::chrono::steady_clock::time_point queued{std::chrono::steady_clock::now()};
+        httplib::Response res{};
+    };
+    auto job = std::make_shared<job_s>(this, conn.id, seq, keep_alive, std::move(req));
+
+    const auto lane = server_.lanes_.select(job->req);
+    bool dispatched = server_.lanes_.submit(lane, job->queued, [job, lane, &server = server_](bool admitted) {
+        if (!admitted) {
+            std::string out;
+            write_overload_response(job->req, server.lanes_.retry_after_sec(lane), job->keep_alive, out);
+            job->reactor->complete(job->conn_id, job->seq, std::move(out));
+            server.lanes_.finish();
+            return;
+        }
+        // ответ может быть готов уже после выхода из задачи дорожки, в другом потоке
+        run_request(server.handler_, job->req, job->res, job->queued, [job, &server]() {
+            std::string out;
+            write_response(job->req, job->res, job->keep_alive, out);
+            job->reactor->complete(job->conn_id, job->seq, std::move(out));
+            server.lanes_.finish();
+        });
+    });
+
+    if (!dispatched) {
+        // очередь дорожки переполнена, отвечаем сразу и закрываем соединение
+        std::string out;
+        write_error_response(httplib::StatusCode::ServiceUnavailable_503, out);
+        conn.complete(seq, std::move(out));
+        conn.input_closed = true;
+        return;
+    }
+    server_.options_.notify_inflight(1);
+    server_.options_.notify_pipeline_depth(conn.pending.size());
+}
+
+void EpollServer::Reactor::close_(Connection& conn)
+{
+    // обработка запроса в пуле может быть еще не закончена,
+    // ее результат будет отброшен в drain_completions_()
+    auto id = conn.id;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+    close(conn.fd);
+    server_.conn_manager_.close(conn.remote_addr);
+    connections_.erase(id);
+}
+
+void EpollServer::Reactor::sweep_idle_()
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    std::vector<std::pair<uint64_t, ReapReason>> expired;
+    size_t idle = 0;
+    for (const auto& [id, conn] : connections_) {
+        if (auto reason = server_.conn_manager_.check(*conn, now)) {
+            expired.emplace_back(id, *reason);
+        } else if (conn->is_idle()) {
+            ++idle;
+        }
+    }
+    for (auto [id, reason] : expired) {
+        server_.options_.notify_reaped(reason);
+        close_(*connections_.at(id));
+    }
+    server_.conn_manager_.report_idle(idle, idle_reported_);
+}
+
+// --------------------------------------------------------
+
+EpollServer::~EpollServer()
+{
+    stop();
+    if (listen_fd_ >= 0) close(listen_fd_);
+}
+
+EpollServer::EpollServer(std::shared_ptr<Logging::Logger> logger,
+                         const ReactorOptions& options,
+                         RequestHandler handler)
+:   logger_(std::move(logger)),
+    options_(options),
+    handler_(std::move(handler)),
+    lanes_(logger_, options_),
+    conn_manager_(options_, lanes_)
+{
+}
+
+bool EpollServer::bind_to_port(const NetHelpers::SocketAddress& addr)
+{
+    if (listen_fd_ >= 0) return false;
+    listen_fd_ = open_listening_socket(addr, SOMAXCONN);
+    return (listen_fd_ >= 0);
+}
+
+bool EpollServer::start()
+{
+    if (listen_fd_ < 0 || running_) return false;
+
+    lanes_.start();
+    running_ = true;
+    for (size_t num = 0; num < options_.reactors_count; ++num) {
+        std::string reactor_name(options_.name + std::string("Reactor#") + std::to_string(num));
+
+        try {
+            reactors_.push_back(std::make_unique<Reactor>(*this, reactor_name));
+        }
+        catch (const std::exception& ex) {
+            // останавливаем уже запущенные reactor-потоки и пулы
+            LOG_ERROR(ex.what());
+            stop();
+            return false;
+        }
+        auto& reactor = *reactors_.back();
+        reactor.thread = std::thread(&Reactor::run, &reactor);
+        ThreadHelpers::set_name(reactor.thread.native_handle(), reactor_name);
+        if (!options_.reactor_cpus.empty()) {
+            const auto cpu = options_.reactor_cpus[num % options_.reactor_cpus.size()];
+            if (!ThreadHelpers::pin_thread(reactor.thread.native_handle(), cpu)) {
+                LOG_WARNG(std::format("{}: cannot be pinned to cpu {}", reactor_name, cpu));
+            }
+        }
+    }
+    return true;
+}
+
+void EpollServer::stop()
+{
+    if (!running_.exchange(false)) return;
+
+    for (auto& reactor : reactors_) reactor->wakeup();
+    for (auto& reactor : reactors_) {
+        if (reactor->thread.joinable()) reactor->thread.join();
+    }
+    // пул останавливаем раньше reactor-объектов: выполняющиеся задачи
+    // еще могут отдавать в них готовые ответы
+    lanes_.stop();
+    reactors_.clear();
+}
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -0,0 +1,119 @@
+#include "http/http_connection.h"
+#include "http/http_writer.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+// после скольких разобранных байт имеет смысл сдвигать входной буфер
+static constexpr size_t compact_threshold = 16 * 1024;
+
+Connection::Input Connection::next_request(const ReactorOptions& options,
+                                           httplib::Request& req,
+                                           bool& keep_alive,
+                                           uint64_t& seq)
+{
+    if (input_closed || pipeline_full(options)) return Input::NEED_MORE;
+
+    auto data = std::string_view(in).substr(in_off);
+    in_off += parser.parse(data);
+
+    auto result = Input::NEED_MORE;
+    if (parser.is_failed()) {
+        Pending failed{{}, true};
+        write_error_response(parser.failed_status(), failed.data);
+        pending.push_back(std::move(failed));
+        input_closed = true;
+        result = Input::FAILED;
+    } else if (parser.is_rejected()) {
+        Pending rejected{{}, true};
+        write_response(parser.request(), parser.rejection(), false, rejected.data);
+        pending.push_back(std::move(rejected));
+        input_closed = true;
+        result = Input::FAILED;
+    } else if (parser.is_complete()) {
+        keep_alive = parser.keep_alive()
+                  && (++requests_served < options.keep_alive_max_count);
+        req = parser.take_request();
+        req.remote_addr = remote_addr;
+        req.remote_port = remote_port;
+        if (!keep_alive) input_closed = true;
+
+        seq = pending_seq + pending.size();
+        pending.emplace_back();
+        result = Input::REQUEST;
+    }
+
+    // сдвигаем уже разобранные данные
+    if (in_off == in.size()) {
+        in.clear();
+        in_off = 0;
+    } else if (in_off >= compact_threshold) {
+        in.erase(0, in_off);
+        in_off = 0;
+    }
+    return result;
+}
+
+bool Connection::complete(uint64_t seq, std::string&& data)
+{
+    if (seq < pending_seq || seq - pending_seq >= pending.size()) return false;
+    auto& one = pending[seq - pending_seq];
+    one.data  = std::move(data);
+    one.ready = true;
+    return true;
+}
+
+void Connection::ready_output(std::vector<iovec>& iov, size_t iov_max) const
+{
+    iov.clear();
+    size_t off = out_off;
+    for (const auto& one : pending) {
+        if (!one.ready || iov.size() >= iov_max) break;
+        if (one.data.size() > off) {
+            iov.push_back({const_cast<char*>(one.data.data()) + off, one.data.size() - off});
+        }
+        off = 0;
+    }
+}
+
+void Connection::consume_output(size_t bytes)
+{
+    out_off += bytes;
+    while (!pending.empty()
+       &&  pending.front().ready
+       &&  out_off >= pending.front().data.size()) {
+        out_off -= pending.front().data.size();
+        pending.pop_front();
+        ++pending_seq;
+    }
+}
+
+size_t Connection::in_flight() const noexcept
+{
+    size_t count = 0;
+    for (const auto& one : pending) {
+        if (!one.ready) ++count;
+    }
+    return count;
+}
+
+void run_request(const RequestHandler& handler,
+                 httplib::Request& req,
+                 httplib::Response& res,
+                 std::chrono::steady_clock::time_point received,
+                 const RequestDone& done)
+{
+    try {
+        handler(req, res, received, done);
+    }
+    catch (...) {
+        res = httplib::Response{};
+        res.status = httplib::StatusCode::InternalServerError_500;
+        done();
+    }
+}
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include "http/http_parser.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+static std::string_view trim_ows_(std::string_view s)
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back()  == ' ' || s.back()  == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+static bool iequals_(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        auto ca = static_cast<unsigned char>(a[i]);
+        auto cb = static_cast<unsigned char>(b[i]);
+        if (std::tolower(ca) != std::tolower(cb)) return false;
+    }
+    return true;
+}
+
+size_t HttpRequestParser::parse(std::string_view data)
+{
+    size_t consumed = 0;
+
+    if (state_ == State::HEADERS) {
+        // некоторые клиенты шлют пустые строки между запросами (RFC 7230, 3.5)
+        while (scanned_ == 0 && data.starts_with("\r\n")) {
+            data.remove_prefix(2);
+            consumed += 2;
+        }
+
+        // продолжаем поиск конца заголовков с того места, где остановились
+        // в прошлый раз, чтобы не сканировать буфер заново на каждой порции
+        auto from = (scanned_ >= 3) ? (scanned_ - 3) : 0;
+        auto pos  = data.find("\r\n\r\n", from);
+        if (pos == std::string_view::npos) {
+            if (data.size() > headers_max_length_) {
+                fail_(httplib::StatusCode::RequestHeaderFieldsTooLarge_431);
+            } else {
+                scanned_ = data.size();
+            }
+            return consumed;
+        }
+        if (pos + 4 > headers_max_length_) {
+            fail_(httplib::StatusCode::RequestHeaderFieldsTooLarge_431);
+            return consumed;
+        }
+
+        scanned_ = 0;
+        if (!parse_headers_(data.substr(0, pos))) return consumed + pos + 4;
+        data.remove_prefix(pos + 4);
+        consumed += pos + 4;
+
+        if (!parse_body_length_()) return consumed;
+
+        if (on_headers_ && !on_headers_(req_, rejection_)) {
+            state_      = State::REJECTED;
+            keep_alive_ = false;
+            return consumed;
+        }
+
+        if (body_expected_ == 0) {
+            state_ = State::COMPLETE;
+            return consumed;
+        }
+
+        req_.body.reserve(body_expected_);
+        state_ = State::BODY;
+    }
+
+    if (state_ == State::BODY) {
+        auto need = body_expected_ - req_.body.size();
+        auto take = std::min(need, data.size());
+        req_.body.append(data.data(), take);
+        consumed += take;
+        if (req_.body.size() == body_expected_) {
+            state_ = State::COMPLETE;
+        }
+    }
+
+    return consumed;
+}
+
+httplib::Request HttpRequestParser::take_request()
+{
+    httplib::Request req(std::move(req_));
+    reset();
+    return req;
+}
+
+void HttpRequestParser::reset()
+{
+    state_         = State::HEADERS;
+    failed_status_ = 0;
+    keep_alive_    = true;
+    scanned_       = 0;
+    body_expected_ = 0;
+    req_           = httplib::Request{};
+    rejection_     = httplib::Response{};
+}
+
+bool HttpRequestParser::parse_headers_(std::string_view head)
+{
+    auto eol = head.find("\r\n");
+    if (!parse_request_line_(head.substr(0, eol))) return false;
+
+    while (eol != std::string_view::npos) {
+        head.remove_prefix(eol + 2);
+        eol = head.find("\r\n");
+        auto line  = head.substr(0, eol);
+        auto colon = line.find(':');
+        if (colon == 0 || colon == std::string_view::npos) {
+            fail_(httplib::StatusCode::BadRequest_400);
+            return false;
+        }
+        auto name  = line.substr(0, colon);
+        auto value = trim_ows_(line.substr(colon + 1));
+        if (name.back() == ' ' || name.back() == '\t') {
+            // пробел перед ':' запрещен (RFC 7230, 3.2.4)
+            fail_(httplib::StatusCode::BadRequest_400);
+            return false;
+        }
+        req_.headers.emplace(std::string(name), std::string(value));
+    }
+
+    auto connection = req_.get_header_value("Connection");
+    if (req_.version == "HTTP/1.0") {
+        keep_alive_ = iequals_(connection, "keep-alive");
+    } else {
+        keep_alive_ = !iequals_(connection, "close");
+    }
+    return true;
+}
+
+bool HttpRequestParser::parse_body_length_()
+{
+    // повторный или противоречивый Content-Length, а также Content-Length
+    // вместе с Transfer-Encoding прокси перед сервисом может понять иначе, и
+    // граница тела у них разойдется (request smuggling, RFC 9112, 6.3):
+    // такой запрос отклоняется и соединение закрывается
+    const auto lengths = req_.get_header_value_count("Content-Length");
+    const bool chunked = req_.has_header("Transfer-Encoding");
+    if (lengths > 1 || (lengths == 1 && chunked)) {
+        fail_(httplib::StatusCode::BadRequest_400);
+        return false;
+    }
+    if (chunked) {
+        // chunked-тело запросов нашими клиентами не используется
+        fail_(httplib::StatusCode::NotImplemented_501);
+        return false;
+    }
+
+    body_expected_ = 0;
+    if (lengths == 1) {
+        auto value = req_.get_header_value("Content-Length");
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), body_expected_);
+        if (ec != std::errc{} || ptr != value.data() + value.size()) {
+            fail_(httplib::StatusCode::BadRequest_400);
+            return false;
+        }
+    }
+    if (body_expected_ > payload_max_length_) {
+        fail_(httplib::StatusCode::PayloadTooLarge_413);
+        return false;
+    }
+    return true;
+}
+
+bool HttpRequestParser::parse_request_line_(std::string_view line)
+{
+    // METHOD SP request-target SP HTTP-version
+    auto sp1 = line.find(' ');
+    auto sp2 = (sp1 == std::string_view::npos) ? sp1 : line.find(' ', sp1 + 1);
+    if (sp1 == 0 || sp2 == std::string_view::npos || sp2 == sp1 + 1) {
+        fail_(httplib::StatusCode::BadRequest_400);
+        return false;
+    }
+
+    req_.method  = std::string(line.substr(0, sp1));
+    req_.target  = std::string(line.substr(sp1 + 1, sp2 - sp1 - 1));
+    req_.version = std::string(line.substr(sp2 + 1));
+    if (req_.version != "HTTP/1.1" && req_.version != "HTTP/1.0") {
+        fail_(httplib::StatusCode::HttpVersionNotSupported_505);
+        return false;
+    }
+
+    auto target = std::string_view(req_.target);
+    auto query  = target.find('?');
+    req_.path = httplib::detail::decode_url(std::string(target.substr(0, query)), false);
+    if (query != std::string_view::npos) {
+        httplib::detail::parse_query_text(std::string(target.substr(query + 1)), req_.params);
+    }
+    return true;
+}
+
+void HttpRequestParser::fail_(int status)
+{
+    state_         = State::FAILED;
+    failed_status_ = status;
+    keep_alive_    = false;
+}
+
+} // namespace Http
+
+} // namespace SocialNetwork
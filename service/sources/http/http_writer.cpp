@@ -0,0 +1,68 @@
+#include <charconv>
+#include "http/http_writer.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+static void append_number_(std::string& out, size_t value)
+{
+    char buf[24];
+    auto [ptr, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, ptr);
+}
+
+static void append_status_line_(std::string& out, int status)
+{
+    out.append("HTTP/1.1 ");
+    append_number_(out, static_cast<size_t>(status));
+    out.push_back(' ');
+    out.append(httplib::status_message(status));
+    out.append("\r\n");
+}
+
+void write_response(const httplib::Request& req,
+                    const httplib::Response& res,
+                    bool keep_alive,
+                    std::string& out)
+{
+    const bool head = (req.method == "HEAD");
+
+    size_t estimated = 128 + res.body.size();
+    for (const auto& [name, value] : res.headers) {
+        estimated += name.size() + value.size() + 4;
+    }
+    out.reserve(out.size() + estimated);
+
+    append_status_line_(out, res.status);
+    for (const auto& [name, value] : res.headers) {
+        if (name == "Content-Length" || name == "Connection") continue;
+        out.append(name);
+        out.append(": ");
+        out.append(value);
+        out.append("\r\n");
+    }
+    out.append("Content-Length: ");
+    append_number_(out, res.body.size());
+    out.append(keep_alive ? "\r\nConnection: keep-alive\r\n\r\n"
+                          : "\r\nConnection: close\r\n\r\n");
+    if (!head) out.append(res.body);
+}
+
+void write_error_response(int status, std::string& out)
+{
+    append_status_line_(out, status);
+    out.append("Content-Length: 0\r\nConnection: close\r\n\r\n");
+}
+
+void write_overload_response(const httplib::Request& req, int retry_after_sec, bool keep_alive, std::string& out)
+{
+    httplib::Response res;
+    res.status = httplib::StatusCode::ServiceUnavailable_503;
+    res.set_header("Retry-After", std::to_string(retry_after_sec));
+    write_response(req, res, keep_alive, out);
+}
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -0,0 +1,714 @@
+#include <chrono>
+#include <format>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include "helpers/environment.h"
+#include "helpers/cpu_topology.h"
+#include "helpers/ip_address.h"
+#include "helpers/number_parser.h"
+#include "helpers/thread.h"
+#include "http/io_uring_server.h"
+#include "http/http_connection.h"
+#include "http/http_writer.h"
+
+#ifdef HTTP_WITH_IO_URING
+#include <liburing.h>
+#endif
+
+namespace SocialNetwork {
+
+namespace Http {
+
+#ifdef HTTP_WITH_IO_URING
+
+namespace {
+
+// user_data каждой операции: (id соединения << 8) | тип операции
+enum class Op : uint64_t {
+    ACCEPT       = 1,
+    RECV         = 2,
+    SEND         = 3,
+    LINK_TIMEOUT = 4,
+    WAKEUP       = 5,
+    TICK         = 6
+};
+
+constexpr uint64_t make_user_data(uint64_t id, Op op) { return (id << 8) | static_cast<uint64_t>(op); }
+constexpr uint64_t user_data_id(uint64_t data) { return data >> 8; }
+constexpr Op       user_data_op(uint64_t data) { return static_cast<Op>(data & 0xff); }
+
+constexpr unsigned ring_entries    = 4096;
+constexpr unsigned buffers_count   = 1024;   // должно быть степенью 2
+constexpr unsigned buffer_size     = 4096;
+constexpr int      buffer_group_id = 0;
+constexpr size_t   write_iov_max   = 64;
+
+// как часто проверяются таймауты соединений
+constexpr long     sweep_interval_ms = 250;
+
+} // namespace
+
+class IoUringServer::Reactor
+{
+public:
+    ~Reactor();
+    Reactor(IoUringServer& server, const std::string& name, int listen_fd);
+
+    void run();
+    void wakeup();
+
+    // ждет, пока run() включит кольцо: false - поток reactor завершился
+    bool wait_started() { return started_.get_future().get(); }
+
+    // вызывается из потоков пула, когда ответ на запрос готов
+    void complete(uint64_t conn_id, uint64_t seq, std::string&& data);
+
+    std::thread thread{};
+
+private:
+    struct Socket {
+        Socket(uint64_t id, int fd, const ReactorOptions& options)
+        :   conn(id, fd, options) {}
+
+        Connection         conn;
+        std::vector<iovec> iov{};       // ответы, переданные ядру в текущем sendmsg
+        msghdr             msg{};
+        bool        recv_armed{false};
+        bool        send_inflight{false};
+        bool        closing{false};
+    };
+
+    struct completion_s {
+        uint64_t    conn_id{0};
+        uint64_t    seq{0};
+        std::string data{};
+    };
+
+    std::shared_ptr<Logging::Logger> logger_{nullptr};
+    IoUringServer&                   server_;
+    const std::string                name_{};
+
+    int      listen_fd_{-1};
+    int      wakeup_fd_{-1};
+    uint64_t wakeup_value_{0};
+    uint64_t last_conn_id_{0};
+    size_t   idle_reported_{0};
+
+    std::promise<bool> started_{};
+
+    io_uring                 ring_{};
+    io_uring_buf_ring*       buf_ring_{nullptr};
+    std::vector<char>        buffers_{};
+    __kernel_timespec        tick_ts_{};
+    __kernel_timespec        write_ts_{};
+
+    std::unordered_map<uint64_t, std::unique_ptr<Socket>> sockets_{};
+
+    std::mutex                completions_mutex_{};
+    std::vector<completion_s> completions_{};
+
+    io_uring_sqe* get_sqe_();
+    void arm_accept_();
+    void arm_recv_(Socket& sock);
+    void arm_wakeup_();
+    void arm_tick_();
+
+    void on_accept_(const io_uring_cqe& cqe);
+    void on_recv_(Socket& sock, const io_uring_cqe& cqe);
+    void on_send_(Socket& sock, const io_uring_cqe& cqe);
+    void drain_completions_();
+    void sweep_idle_();
+
+    void process_input_(Socket& sock);
+    void dispatch_(Socket& sock, httplib::Request&& req, bool keep_alive, uint64_t seq);
+    void flush_(Socket& sock);
+    void close_(Socket& sock);
+    void finalize_if_closed_(Socket& sock);
+};
+
+IoUringServer::Reactor::~Reactor()
+{
+    for (auto& [id, sock] : sockets_) close(sock->conn.fd);
+    if (buf_ring_) io_uring_free_buf_ring(&ring_, buf_ring_, buffers_count, buffer_group_id);
+    io_uring_queue_exit(&ring_);
+    if (wakeup_fd_ >= 0) close(wakeup_fd_);
+    if (listen_fd_ >= 0) close(listen_fd_);
+}
+
+IoUringServer::Reactor::Reactor(IoUringServer& server, const std::string& name, int listen_fd)
+:   logger_(server.logger_),
+    server_(server),
+    name_(name),
+    listen_fd_(listen_fd)
+{
+    // с IORING_SETUP_SINGLE_ISSUER запросы в кольцо может отправлять только
+    // один поток - тот, что его создал или включил. кольцо создается
+    // выключенным и включается в run(), в потоке reactor
+    io_uring_params params{};
+    params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SINGLE_ISSUER
+                 | IORING_SETUP_R_DISABLED;
+    int rc = io_uring_queue_init_params(ring_entries, &ring_, &params);
+    if (rc < 0) {
+        close(listen_fd_);
+        throw std::runtime_error(std::format("{}: io_uring_queue_init_params() failed, rc={}", name_, rc));
+    }
+
+    buffers_.resize(static_cast<size_t>(buffers_count) * buffer_size);
+    buf_ring_ = io_uring_setup_buf_ring(&ring_, buffers_count, buffer_group_id, 0, &rc);
+    if (!buf_ring_) {
+        io_uring_queue_exit(&ring_);
+        close(listen_fd_);
+        throw std::runtime_error(std::format("{}: io_uring_setup_buf_ring() failed, rc={}", name_, rc));
+    }
+    for (unsigned bid = 0; bid < buffers_count; ++bid) {
+        io_uring_buf_ring_add(buf_ring_, buffers_.data() + bid * buffer_size, buffer_size, bid,
+                              io_uring_buf_ring_mask(buffers_count), bid);
+    }
+    io_uring_buf_ring_advance(buf_ring_, buffers_count);
+
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd_ < 0) {
+        io_uring_free_buf_ring(&ring_, buf_ring_, buffers_count, buffer_group_id);
+        io_uring_queue_exit(&ring_);
+        close(listen_fd_);
+        throw std::runtime_error(std::format("{}: cannot create eventfd", name_));
+    }
+
+    tick_ts_.tv_nsec = sweep_interval_ms * 1'000'000;
+    write_ts_.tv_sec = server_.options_.read_timeout_sec;
+}
+
+void IoUringServer::Reactor::run()
+{
+    ThreadHelpers::block_signals();
+
+    const int enable_rc = io_uring_enable_rings(&ring_);
+    started_.set_value(enable_rc == 0);
+    if (enable_rc < 0) {
+        LOG_ERROR(std::format("{}: io_uring_enable_rings() failed, rc={}", name_, enable_rc));
+        return;
+    }
+
+    arm_accept_();
+    arm_wakeup_();
+    arm_tick_();
+
+    io_uring_cqe* cqes[256];
+    while (server_.running_) {
+        int rc = io_uring_submit_and_wait(&ring_, 1);
+        if (rc < 0 && rc != -EINTR && rc != -EAGAIN && rc != -EBUSY) {
+            LOG_ERROR(std::format("{}: io_uring_submit_and_wait() failed, rc={}", name_, rc));
+            // reactor больше не принимает соединения: сервер не работает
+            server_.failed_ = true;
+            break;
+        }
+
+        unsigned n = io_uring_peek_batch_cqe(&ring_, cqes, 256);
+        for (unsigned i = 0; i < n; ++i) {
+            const auto& cqe = *cqes[i];
+            const auto  data = io_uring_cqe_get_data64(&cqe);
+
+            switch (user_data_op(data)) {
+            case Op::ACCEPT:
+                on_accept_(cqe);
+                break;
+            case Op::WAKEUP:
+                drain_completions_();
+                arm_wakeup_();
+                break;
+            case Op::TICK:
+                sweep_idle_();
+                arm_tick_();
+                break;
+            case Op::LINK_TIMEOUT:
+                break;
+            case Op::RECV:
+            case Op::SEND: {
+                auto it = sockets_.find(user_data_id(data));
+                if (it == sockets_.end()) break;
+                auto& sock = *it->second;
+                if (user_data_op(data) == Op::RECV) on_recv_(sock, cqe);
+                else                                on_send_(sock, cqe);
+                finalize_if_closed_(sock);
+                break;
+            }
+            }
+        }
+        io_uring_cq_advance(&ring_, n);
+    }
+
+    // буферы включенного кольца снимает с регистрации тоже только этот поток
+    io_uring_free_buf_ring(&ring_, buf_ring_, buffers_count, buffer_group_id);
+    buf_ring_ = nullptr;
+}
+
+void IoUringServer::Reactor::wakeup()
+{
+    uint64_t value = 1;
+    [[maybe_unused]] auto rc = write(wakeup_fd_, &value, sizeof(value));
+}
+
+void IoUringServer::Reactor::complete(uint64_t conn_id, uint64_t seq, std::string&& data)
+{
+    {
+        std::lock_guard<std::mutex> lock(completions_mutex_);
+        completions_.push_back({conn_id, seq, std::move(data)});
+    }
+    wakeup();
+}
+
+io_uring_sqe* IoUringServer::Reactor::get_sqe_()
+{
+    auto* sqe = io_uring_get_sqe(&ring_);
+    while (!sqe) {
+        // очередь отправки заполнена, отдаем накопленное ядру
+        io_uring_submit(&ring_);
+        sqe = io_uring_get_sqe(&ring_);
+    }
+    return sqe;
+}
+
+void IoUringServer::Reactor::arm_accept_()
+{
+    auto* sqe = get_sqe_();
+    io_uring_prep_multishot_accept(sqe, listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    io_uring_sqe_set_data64(sqe, make_user_data(0, Op::ACCEPT));
+}
+
+void IoUringServer::Reactor::arm_recv_(Socket& sock)
+{
+    auto* sqe = get_sqe_();
+    io_uring_prep_recv_multishot(sqe, sock.conn.fd, nullptr, 0, 0);
+    sqe->flags    |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = buffer_group_id;
+    io_uring_sqe_set_data64(sqe, make_user_data(sock.conn.id, Op::RECV));
+    sock.recv_armed = true;
+}
+
+void IoUringServer::Reactor::arm_wakeup_()
+{
+    auto* sqe = get_sqe_();
+    io_uring_prep_read(sqe, wakeup_fd_, &wakeup_value_, sizeof(wakeup_value_), 0);
+    io_uring_sqe_set_data64(sqe, make_user_data(0, Op::WAKEUP));
+}
+
+void IoUringServer::Reactor::arm_tick_()
+{
+    auto* sqe = get_sqe_();
+    io_uring_prep_timeout(sqe, &tick_ts_, 0, 0);
+    io_uring_sqe_set_data64(sqe, make_user_data(0, Op::TICK));
+}
+
+void IoUringServer::Reactor::on_accept_(const io_uring_cqe& cqe)
+{
+    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+        // multishot accept снят ядром (например, из-за ошибки), взводим заново
+        if (server_.running_) arm_accept_();
+    }
+    if (cqe.res < 0) {
+        LOG_WARNG(std::format("{}: accept failed, rc={}", name_, cqe.res));
+        return;
+    }
+
+    int fd  = cqe.res;
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+    auto id   = ++last_conn_id_;
+    auto sock = std::make_unique<Socket>(id, fd, server_.options_);
+    try {
+        sockaddr_storage addr{};
+        socklen_t addr_len = sizeof(addr);
+        if (getpeername(fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0) {
+            NetHelpers::SocketAddress peer(reinterpret_cast<const sockaddr*>(&addr), addr_len);
+            sock->conn.remote_addr = peer.host().to_string();
+            sock->conn.remote_port = peer.port();
+        }
+    }
+    catch (...) {}
+
+    if (!server_.conn_manager_.open(sock->conn.remote_addr)) {
+        server_.conn_manager_.reject(fd);
+        return;
+    }
+
+    arm_recv_(*sock);
+    sockets_.emplace(id, std::move(sock));
+}
+
+void IoUringServer::Reactor::on_recv_(Socket& sock, const io_uring_cqe& cqe)
+{
+    if (!(cqe.flags & IORING_CQE_F_MORE)) sock.recv_armed = false;
+
+    auto& conn = sock.conn;
+    if (cqe.res > 0 && (cqe.flags & IORING_CQE_F_BUFFER)) {
+        auto bid = static_cast<unsigned short>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        auto* buf = buffers_.data() + static_cast<size_t>(bid) * buffer_size;
+        conn.in.append(buf, cqe.res);
+        // буфер сразу возвращаем ядру
+        io_uring_buf_ring_add(buf_ring_, buf, buffer_size, bid, io_uring_buf_ring_mask(buffers_count), 0);
+        io_uring_buf_ring_advance(buf_ring_, 1);
+        conn.last_activity = std::chrono::steady_clock::now();
+
+        // пока конвейер заполнен, копим не больше одного запроса впрок
+        // (multishot recv не приостановить, поэтому такой клиент отключается)
+        const size_t in_max = server_.options_.headers_max_length + server_.options_.payload_max_length;
+        if (conn.pipeline_full(server_.options_) && conn.in.size() - conn.in_off > in_max) {
+            close_(sock);
+            return;
+        }
+        process_input_(sock);
+    } else if (cqe.res == 0) {
+        conn.peer_closed = true;
+        process_input_(sock);
+        return;
+    } else if (cqe.res != -ENOBUFS) {
+        close_(sock);
+        return;
+    }
+
+    // -ENOBUFS (все буферы заняты) или multishot снят ядром
+    if (!sock.recv_armed && !sock.closing) arm_recv_(sock);
+}
+
+void IoUringServer::Reactor::on_send_(Socket& sock, const io_uring_cqe& cqe)
+{
+    sock.send_inflight = false;
+    if (cqe.res <= 0) {
+        // ошибка записи, либо отмена связанным таймаутом
+        close_(sock);
+        return;
+    }
+
+    // отправленные ответы освобождают места в конвейере
+    sock.conn.consume_output(cqe.res);
+    process_input_(sock);
+}
+
+void IoUringServer::Reactor::drain_completions_()
+{
+    std::vector<completion_s> ready;
+    {
+        std::lock_guard<std::mutex> lock(completions_mutex_);
+        ready.swap(completions_);
+    }
+    server_.options_.notify_inflight(-static_cast<int>(ready.size()));
+
+    for (auto& one : ready) {
+        auto it = sockets_.find(one.conn_id);
+        if (it == sockets_.end()) continue; // соединение уже закрыто
+        auto& sock = *it->second;
+        auto& conn = sock.conn;
+        if (sock.closing) continue;
+
+        if (!conn.complete(one.seq, std::move(one.data))) continue;
+        conn.last_activity = std::chrono::steady_clock::now();
+
+        process_input_(sock);
+        finalize_if_closed_(sock);
+    }
+}
+
+void IoUringServer::Reactor::sweep_idle_()
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    std::vector<std::pair<uint64_t, ReapReason>> expired;
+    size_t idle = 0;
+    for (const auto& [id, sock] : sockets_) {
+        if (sock->closing || sock->send_inflight) continue;
+        if (auto reason = server_.conn_manager_.check(sock->conn, now)) {
+            expired.emplace_back(id, *reason);
+        } else if (sock->conn.is_idle()) {
+            ++idle;
+        }
+    }
+    for (auto [id, reason] : expired) {
+        auto& sock = *sockets_.at(id);
+        server_.options_.notify_reaped(reason);
+        close_(sock);
+        finalize_if_closed_(sock);
+    }
+    server_.conn_manager_.report_idle(idle, idle_reported_);
+}
+
+void IoUringServer::Reactor::process_input_(Socket& sock)
+{
+    auto& conn = sock.conn;
+    if (sock.closing) return;
+
+    for (;;) {
+        httplib::Request req;
+        bool     keep_alive = false;
+        uint64_t seq        = 0;
+        auto input = conn.next_request(server_.options_, req, keep_alive, seq);
+        if (input != Connection::Input::REQUEST) break;
+        dispatch_(sock, std::move(req), keep_alive, seq);
+    }
+    if (conn.pipeline_full(server_.options_)) {
+        if (conn.in_off < conn.in.size()) server_.options_.notify_pipeline_stall();
+    } else if (conn.peer_closed) {
+        // клиент закрыл соединение, а целых запросов в буфере больше нет
+        conn.input_closed = true;
+    }
+
+    flush_(sock);
+}
+
+void IoUringServer::Reactor::dispatch_(Socket& sock, httplib::Request&& req, bool keep_alive, uint64_t seq)
+{
+    struct job_s {
+        Reactor*         reactor{nullptr};
+        uint64_t         conn_id{0};
+        uint64_t         seq{0};
+        bool             keep_alive{false};
+        httplib::Request req{};
+        std::chrono::steady_clock::time_point queued{std::chrono::steady_clock::now()};
+        httplib::Response res{};
+    };
+    auto job = std::make_shared<job_s>(this, sock.conn.id, seq, keep_alive, std::move(req));
+
+    const auto lane = server_.lanes_.select(job->req);
+    bool dispatched = server_.lanes_.submit(lane, job->queued, [job, lane, &server = server_](bool admitted) {
+        if (!admitted) {
+            std::string out;
+            write_overload_response(job->req, server.lanes_.retry_after_sec(lane), job->keep_alive, out);
+            job->reactor->complete(job->conn_id, job->seq, std::move(out));
+            server.lanes_.finish();
+            return;
+        }
+        // ответ может быть готов уже после выхода из задачи дорожки, в другом потоке
+        run_request(server.handler_, job->req, job->res, job->queued, [job, &server]() {
+            std::string out;
+            write_response(job->req, job->res, job->keep_alive, out);
+            job->reactor->complete(job->conn_id, job->seq, std::move(out));
+            server.lanes_.finish();
+        });
+    });
+
+    if (!dispatched) {
+        // очередь дорожки переполнена, отвечаем сразу и закрываем соединение
+        std::string out;
+        write_error_response(httplib::StatusCode::ServiceUnavailable_503, out);
+        sock.conn.complete(seq, std::move(out));
+        sock.conn.input_closed = true;
+        return;
+    }
+    server_.options_.notify_inflight(1);
+    server_.options_.notify_pipeline_depth(sock.conn.pending.size());
+}
+
+void IoUringServer::Reactor::flush_(Socket& sock)
+{
+    auto& conn = sock.conn;
+    if (sock.closing || sock.send_inflight) return;
+
+    // готовые ответы с начала конвейера уходят одним sendmsg. строки ответов
+    // не меняются, пока ядро их отправляет: новые ответы только добавляются в конец
+    conn.ready_output(sock.iov, write_iov_max);
+    if (sock.iov.empty()) {
+        if (conn.is_finished()) close_(sock);
+        return;
+    }
+    sock.msg = msghdr{};
+    sock.msg.msg_iov    = sock.iov.data();
+    sock.msg.msg_iovlen = sock.iov.size();
+
+    auto* sqe = get_sqe_();
+    io_uring_prep_sendmsg(sqe, conn.fd, &sock.msg, MSG_NOSIGNAL);
+    io_uring_sqe_set_data64(sqe, make_user_data(conn.id, Op::SEND));
+    sqe->flags |= IOSQE_IO_LINK;
+
+    auto* timeout_sqe = get_sqe_();
+    io_uring_prep_link_timeout(timeout_sqe, &write_ts_, 0);
+    io_uring_sqe_set_data64(timeout_sqe, make_user_data(conn.id, Op::LINK_TIMEOUT));
+
+    sock.send_inflight = true;
+}
+
+void IoUringServer::Reactor::close_(Socket& sock)
+{
+    if (sock.closing) return;
+    sock.closing = true;
+    // shutdown() завершает взведенные recv/send, сокет закроем,
+    // когда ядро вернет по ним результаты (finalize_if_closed_)
+    shutdown(sock.conn.fd, SHUT_RDWR);
+}
+
+void IoUringServer::Reactor::finalize_if_closed_(Socket& sock)
+{
+    if (!sock.closing || sock.recv_armed || sock.send_inflight) return;
+
+    // обработка запроса в пуле может быть еще не закончена,
+    // ее результат будет отброшен в drain_completions_()
+    auto id = sock.conn.id;
+    close(sock.conn.fd);
+    server_.conn_manager_.close(sock.conn.remote_addr);
+    sockets_.erase(id);
+}
+
+// --------------------------------------------------------
+
+IoUringServer::~IoUringServer()
+{
+    stop();
+    reactors_.clear();
+    if (listen_fd_ >= 0) close(listen_fd_);
+}
+
+IoUringServer::IoUringServer(std::shared_ptr<Logging::Logger> logger,
+                             const ReactorOptions& options,
+                             RequestHandler handler)
+:   logger_(std::move(logger)),
+    options_(options),
+    handler_(std::move(handler)),
+    lanes_(logger_, options_),
+    conn_manager_(options_, lanes_)
+{
+}
+
+bool IoUringServer::is_supported()
+{
+    // multishot recv появился в ядре 6.0
+    auto version = EnvironmentHelpers::os_version();
+    int major = 0;
+    if (!NumberParserHelpers::try_parse_int(version.substr(0, version.find('.')), major)
+    ||  major < 6) {
+        return false;
+    }
+
+    // io_uring может быть отключен (sysctl kernel.io_uring_disabled, seccomp в контейнере)
+    io_uring ring{};
+    if (io_uring_queue_init(8, &ring, 0) < 0) return false;
+    int rc = 0;
+    auto* br = io_uring_setup_buf_ring(&ring, 8, buffer_group_id, 0, &rc);
+    if (br) io_uring_free_buf_ring(&ring, br, 8, buffer_group_id);
+    io_uring_queue_exit(&ring);
+    return (br != nullptr);
+}
+
+bool IoUringServer::bind_to_port(const NetHelpers::SocketAddress& addr)
+{
+    if (listen_fd_ >= 0) return false;
+    listen_fd_ = open_listening_socket(addr, SOMAXCONN);
+    if (listen_fd_ < 0) return false;
+    addr_ = std::make_unique<NetHelpers::SocketAddress>(addr.sockaddr(), addr.length());
+    return true;
+}
+
+bool IoUringServer::start()
+{
+    if (listen_fd_ < 0 || running_) return false;
+
+    lanes_.start();
+    running_ = true;
+    for (size_t num = 0; num < options_.reactors_count; ++num) {
+        std::string reactor_name(options_.name + std::string("Ring#") + std::to_string(num));
+
+        // первый reactor получает сокет из bind_to_port(), остальные
+        // открывают свой на том же адресе, ядро распределит соединения между ними
+        int fd = listen_fd_;
+        if (num == 0) listen_fd_ = -1;
+        else          fd = open_listening_socket(*addr_, SOMAXCONN);
+        if (fd < 0) {
+            LOG_ERROR(std::format("{}: cannot open listening socket", reactor_name));
+            continue;
+        }
+
+        try {
+            reactors_.push_back(std::make_unique<Reactor>(*this, reactor_name, fd));
+        }
+        catch (const std::exception& ex) {
+            // кольцо не создано: останавливаем уже запущенные reactor-потоки и пулы
+            LOG_ERROR(ex.what());
+            stop();
+            return false;
+        }
+        auto& reactor = *reactors_.back();
+        reactor.thread = std::thread(&Reactor::run, &reactor);
+        ThreadHelpers::set_name(reactor.thread.native_handle(), reactor_name);
+        if (!options_.reactor_cpus.empty()) {
+            const auto cpu = options_.reactor_cpus[num % options_.reactor_cpus.size()];
+            if (!ThreadHelpers::pin_thread(reactor.thread.native_handle(), cpu)) {
+                LOG_WARNG(std::format("{}: cannot be pinned to cpu {}", reactor_name, cpu));
+            }
+        }
+    }
+
+    // каждый reactor должен включить свое кольцо, иначе сервер не запущен
+    bool started = !reactors_.empty();
+    for (auto& reactor : reactors_) started = reactor->wait_started() && started;
+    if (!started) {
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void IoUringServer::stop()
+{
+    if (!running_.exchange(false)) return;
+
+    for (auto& reactor : reactors_) reactor->wakeup();
+    for (auto& reactor : reactors_) {
+        if (reactor->thread.joinable()) reactor->thread.join();
+    }
+    // пул останавливаем раньше reactor-объектов: выполняющиеся задачи
+    // еще могут отдавать в них готовые ответы
+    lanes_.stop();
+    reactors_.clear();
+}
+
+#else // HTTP_WITH_IO_URING
+
+class IoUringServer::Reactor
+{
+};
+
+IoUringServer::~IoUringServer()
+{
+}
+
+IoUringServer::IoUringServer(std::shared_ptr<Logging::Logger> logger,
+                             const ReactorOptions& options,
+                             RequestHandler handler)
+:   logger_(std::move(logger)),
+    options_(options),
+    handler_(std::move(handler)),
+    lanes_(logger_, options_),
+    conn_manager_(options_, lanes_)
+{
+}
+
+bool IoUringServer::is_supported()
+{
+    // сервис собран без liburing
+    return false;
+}
+
+bool IoUringServer::bind_to_port(const NetHelpers::SocketAddress& /*addr*/)
+{
+    return false;
+}
+
+bool IoUringServer::start()
+{
+    return false;
+}
+
+void IoUringServer::stop()
+{
+}
+
+#endif // HTTP_WITH_IO_URING
+
+} // namespace Http
+
+} // namespace SocialNetwork
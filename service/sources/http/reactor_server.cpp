@@ -0,0 +1,31 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "http/reactor_server.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+int open_listening_socket(const NetHelpers::SocketAddress& addr, int backlog)
+{
+    int fd = socket(addr.af(), SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+#ifdef SO_REUSEPORT
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &yes, sizeof(yes));
+#endif
+
+    if (bind(fd, addr.sockaddr(), addr.length()) < 0
+    ||  listen(fd, backlog) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace Http
+
+} // namespace SocialNetwork
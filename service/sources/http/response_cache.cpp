@@ -0,0 +1,38 @@
+#include "http/response_cache.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+ResponseCache::Entry ResponseCache::find(const std::string& key)
+{
+    auto& shard = shard_(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.items.find(key);
+    if (it == shard.items.end() || it->second.expires <= clock_t::now()) return nullptr;
+    return it->second.entry;
+}
+
+void ResponseCache::insert(std::string key, Entry entry)
+{
+    const auto now     = clock_t::now();
+    const auto expires = now + ttl_;
+    auto& shard = shard_(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // удаляем устаревшие записи и, если сегмент заполнен, самые старые
+    while (!shard.order.empty()
+       && (shard.order.front().second <= now || shard.items.size() >= shard_capacity_)) {
+        auto& [old_key, old_expires] = shard.order.front();
+        auto it = shard.items.find(old_key);
+        if (it != shard.items.end() && it->second.expires == old_expires) shard.items.erase(it);
+        shard.order.pop_front();
+    }
+
+    shard.order.emplace_back(key, expires);
+    shard.items.insert_or_assign(std::move(key), item_s{std::move(entry), expires});
+}
+
+} // namespace Http
+
+} // namespace SocialNetwork
@@ -0,0 +1,96 @@
+#include <thread>
+#include "http/worker_lanes.h"
+
+namespace SocialNetwork {
+
+namespace Http {
+
+WorkerLanes::WorkerLanes(std::shared_ptr<Logging::Logger> logger, const ReactorOptions& options)
+:   logger_(std::move(logger)),
+    options_(options)
+{
+    for (const auto& lane : options_.lanes) {
+        lanes_.push_back(std::make_unique<lane_s>(lane));
+    }
+    // без настроенных дорожек все запросы обслуживает один пул
+    if (lanes_.empty()) lanes_.push_back(std::make_unique<lane_s>(LaneOptions{}));
+}
+
+void WorkerLanes::start()
+{
+    for (size_t index = 0; index < lanes_.size(); ++index) {
+        auto& lane = lanes_[index];
+        ThreadHelpers::Elasticity elasticity;
+        elasticity.threads_max_count = lane->options.threads_max_count;
+        elasticity.cpus_limit        = lane->options.cpus_limit;
+        elasticity.idle_timeout      = std::chrono::milliseconds(lane->options.threads_idle_timeout_ms);
+        elasticity.on_resize         = [this, index](int delta) { options_.notify_lane_threads(index, delta); };
+        lane->pool = std::make_unique<ThreadHelpers::ThreadPool>(options_.name + std::string("Pool-") + lane->options.name,
+                                                                 logger_,
+                                                                 lane->options.threads_count,
+                                                                 lane->options.queue_capacity,
+                                                                 ThreadHelpers::Scheduling::SharedQueue,
+                                                                 std::move(elasticity),
+                                                                 lane->options.cpus);
+    }
+}
+
+void WorkerLanes::stop()
+{
+    // обработчики, ждущие БД или пул паролей, продолжатся задачами в пулах
+    // дорожек: пулы останавливаются, только когда все запросы закончены
+    while (unfinished_.load(std::memory_order_acquire) > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (auto& lane : lanes_) lane->pool.reset();
+}
+
+size_t WorkerLanes::select(const httplib::Request& req) const
+{
+    if (!options_.lane_of) return 0;
+    const auto lane = options_.lane_of(req);
+    return (lane < lanes_.size()) ? lane : 0;
+}
+
+bool WorkerLanes::submit(size_t lane, std::chrono::steady_clock::time_point queued, Task task)
+{
+    auto& one = *lanes_[lane];
+    one.in_pool.fetch_add(1, std::memory_order_relaxed);
+    unfinished_.fetch_add(1, std::memory_order_relaxed);
+    options_.notify_lane_queue(lane, 1);
+
+    auto id = one.pool->add_task(nullptr, [this, lane, queued, task = std::move(task)]() {
+        auto& one = *lanes_[lane];
+        const auto start = std::chrono::steady_clock::now();
+        options_.notify_lane_queue(lane, -1);
+        options_.notify_queue_sojourn(lane, std::chrono::duration<double>(start - queued).count());
+
+        const bool admitted = !one.codel.should_drop(queued, start);
+        if (!admitted) options_.notify_shed(lane);
+        task(admitted);
+
+        one.in_pool.fetch_sub(1, std::memory_order_relaxed);
+        options_.notify_lane_task(lane, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    });
+
+    if (!id) {
+        one.in_pool.fetch_sub(1, std::memory_order_relaxed);
+        unfinished_.fetch_sub(1, std::memory_order_relaxed);
+        options_.notify_lane_queue(lane, -1);
+        return false;
+    }
+    return true;
+}
+
+bool WorkerLanes::saturated() const noexcept
+{
+    for (const auto& lane : lanes_) {
+        const auto threads = lane->pool ? lane->pool->threads_count() : lane->options.threads_count;
+        if (lane->in_pool.load(std::memory_order_relaxed) > threads) return true;
+    }
+    return false;
+}
+
+} // namespace Http
+
+} // namespace SocialNetwork
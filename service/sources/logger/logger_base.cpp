@@ -11,27 +11,10 @@ void Logging::Logger::log(const std::string_view /*message*/, const std::string_
 {
 }
 
-std::string Logging::Logger::get_timestamp()
+TimeHelpers::CoarseClock::LogTime Logging::Logger::get_timestamp()
 {
-    std::chrono::system_clock::time_point tp = std::chrono::system_clock::now();
-    std::time_t tt = std::chrono::system_clock::to_time_t(tp);
-    std::tm gmt{};
-    get_gmtime(&tt, &gmt);
-
-    std::chrono::duration<double> fractional_seconds = (tp - std::chrono::system_clock::from_time_t(tt)) + std::chrono::seconds(gmt.tm_sec);
-
-    std::string buffer("yyyy-mm-dd hh:mm:ss.xxxxxx0");
-    [[maybe_unused]] int ret = snprintf(&buffer.front(), buffer.length(), "%04d-%02d-%02d %02d:%02d:%09.6f",
-                                        (gmt.tm_year + 1900) %10000u,
-                                        (gmt.tm_mon + 1)     %100u,
-                                        (gmt.tm_mday)        %100u,
-                                        (gmt.tm_hour)        %100u,
-                                        (gmt.tm_min)         %100u,
-                                        fractional_seconds.count());
-
-    // remove trailing null terminator added by snprintf.
-    buffer.pop_back();
-    return buffer;
+    // форматируется не чаще раза за тик часов, а не на каждую строку журнала
+    return TimeHelpers::CoarseClock::log_time();
 }
 
 std::tm* Logging::Logger::get_gmtime(const std::time_t* time, std::tm* tm)
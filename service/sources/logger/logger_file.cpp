@@ -52,7 +52,7 @@ void Logging::LoggerFile::log(const std::string_view message, const std::string_
 {
     std::string output;
     output.reserve(message.length() + 64);
-    output.append(Logger::get_timestamp());
+    output.append(Logger::get_timestamp().view());
     output.append(custom_directive);
     output.append(message);
     output.push_back('\n');
@@ -13,7 +13,7 @@ void Logging::LoggerStdOut::log(const std::string_view message, const std::strin
 {
     std::string output;
     output.reserve(message.length() + 64);
-    output.append(Logger::get_timestamp());
+    output.append(Logger::get_timestamp().view());
     output.append(custom_directive);
     output.append(message);
     output.push_back('\n');
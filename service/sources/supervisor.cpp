@@ -0,0 +1,349 @@
+#include <format>
+#include <sstream>
+#include <unordered_map>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include "helpers/socket_address.h"
+#include "helpers/ip_address.h"
+#include "helpers/thread.h"
+#include "supervisor.h"
+
+extern char** environ;
+
+namespace SocialNetwork {
+
+// процесс, проработавший меньше, считается упавшим при запуске,
+// и задержка перед его перезапуском удваивается
+static constexpr auto worker_min_uptime        = std::chrono::seconds(10);
+static constexpr auto worker_max_restart_delay = std::chrono::seconds(30);
+static constexpr auto worker_stop_timeout      = std::chrono::seconds(10);
+
+static std::string exit_status_str_(int status)
+{
+    if (WIFEXITED(status))   return std::format("exited with code {}", WEXITSTATUS(status));
+    if (WIFSIGNALED(status)) return std::format("killed by signal {}", WTERMSIG(status));
+    return std::format("finished with status {}", status);
+}
+
+// добавляет метку worker="id" к строке с значением метрики
+static void add_worker_label_(std::string_view line, const std::string& label, std::string& out)
+{
+    auto pos = line.find_first_of("{ ");
+    if (pos == std::string_view::npos) return;
+
+    out.append(line.substr(0, pos));
+    out.append("{").append(label);
+    if (line[pos] == '{') {
+        if (pos + 1 < line.size() && line[pos + 1] != '}') out.append(",");
+        out.append(line.substr(pos + 1));
+    } else {
+        out.append("}").append(line.substr(pos));
+    }
+    out.append("\n");
+}
+
+// объединяет метрики обработчиков (текстовый формат Prometheus) так, чтобы
+// каждое семейство было описано один раз (# HELP, # TYPE), а его значения
+// от всех обработчиков шли подряд
+static std::string merge_metrics_(const std::vector<std::pair<int, std::string>>& texts)
+{
+    struct family_s {
+        std::string header{};
+        std::string samples{};
+        int         owner{-1};
+    };
+    std::vector<std::string>                  order;
+    std::unordered_map<std::string, family_s> families;
+
+    for (const auto& [id, text] : texts) {
+        const std::string label = std::format("worker=\"{}\"", id);
+        std::string current;
+
+        std::string_view rest(text);
+        while (!rest.empty()) {
+            auto eol  = rest.find('\n');
+            auto line = rest.substr(0, eol);
+            rest.remove_prefix(eol == std::string_view::npos ? rest.size() : eol + 1);
+            if (line.empty()) continue;
+
+            if (line.starts_with("# HELP ") || line.starts_with("# TYPE ")) {
+                auto name = line.substr(7, line.find(' ', 7) - 7);
+                current.assign(name);
+                auto [it, inserted] = families.try_emplace(current);
+                if (inserted) {
+                    order.push_back(current);
+                    it->second.owner = id;
+                }
+                if (it->second.owner == id) it->second.header.append(line).append("\n");
+                continue;
+            }
+            if (line.starts_with("#")) continue;
+
+            if (current.empty()) {
+                // значение без описания семейства
+                current.assign(line.substr(0, line.find_first_of("{ ")));
+                if (families.try_emplace(current).second) order.push_back(current);
+            }
+            add_worker_label_(line, label, families[current].samples);
+        }
+    }
+
+    std::string result;
+    for (const auto& name : order) {
+        const auto& family = families[name];
+        result.append(family.header).append(family.samples);
+    }
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+
+Supervisor::~Supervisor()
+{
+    if (metrics_server_) metrics_server_->stop();
+    if (metrics_server_thread_.joinable()) {
+        metrics_server_thread_.join();
+    }
+}
+
+Supervisor::Supervisor(std::shared_ptr<cxxopts::ParseResult> cli_opts, int argc, char** argv)
+:   logger_(Logging::configure_logger({ {"type", "stdout"}, {"color", "true"}, {"level", "5"} })),
+    conf_(std::make_shared<Configuration>(logger_, cli_opts))
+{
+    for (int i = 0; i < argc; ++i) {
+        args_.emplace_back(argv[i]);
+    }
+}
+
+bool Supervisor::is_required() const noexcept
+{
+    return (conf_->config().workers_count > 1)
+        && (conf_->config().worker_id < 0);
+}
+
+void Supervisor::run()
+{
+    LOG_INFOR(std::format("supervisor is running, workers: {}", conf_->config().workers_count));
+
+    // сигналы обрабатываются синхронно в основном потоке (sigtimedwait),
+    // маска наследуется потоком сервера метрик
+    sigset_t sset;
+    sigemptyset(&sset);
+    sigaddset(&sset, SIGCHLD);
+    sigaddset(&sset, SIGINT);
+    sigaddset(&sset, SIGQUIT);
+    sigaddset(&sset, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &sset, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        for (int id = 0; id < conf_->config().workers_count; ++id) {
+            worker_s worker;
+            worker.id           = id;
+            worker.metrics_port = static_cast<uint16_t>(conf_->config().prometheus_port + 1 + id);
+            workers_.push_back(worker);
+        }
+        for (auto& worker : workers_) {
+            spawn_(worker);
+        }
+    }
+
+    try {
+        metrics_start_();
+    }
+    catch (std::exception& ex) {
+        LOG_ERROR(std::format("supervisor metrics server exception: {}", ex.what()));
+    }
+
+    for (;;) {
+        timespec timeout{1, 0};
+        int sig = sigtimedwait(&sset, nullptr, &timeout);
+        if (sig == SIGINT || sig == SIGQUIT || sig == SIGTERM) {
+            LOG_INFOR(std::format("supervisor received signal {}, stopping workers", sig));
+            break;
+        }
+        reap_();
+        restart_();
+    }
+
+    stop_workers_();
+    if (metrics_server_) metrics_server_->stop();
+}
+
+void Supervisor::spawn_(worker_s& worker)
+{
+    // все, что нужно для exec, готовим до fork(): между fork() и exec()
+    // в процессе с потоками можно вызывать только async-signal-safe функции
+    std::vector<char*> argv;
+    for (auto& arg : args_) argv.push_back(arg.data());
+    argv.push_back(nullptr);
+
+    std::string worker_env = std::format("WORKER_ID={}", worker.id);
+    std::vector<char*> envp;
+    for (char** env = environ; env && *env; ++env) {
+        if (std::string_view(*env).starts_with("WORKER_ID=")) continue;
+        envp.push_back(*env);
+    }
+    envp.push_back(worker_env.data());
+    envp.push_back(nullptr);
+
+    const pid_t parent = getpid();
+    pid_t pid = fork();
+    if (pid < 0) {
+        LOG_ERROR(std::format("supervisor cannot fork worker #{}, errno={}", worker.id, errno));
+        worker.restart_at = std::chrono::steady_clock::now() + worker.restart_delay;
+        return;
+    }
+    if (pid == 0) {
+        sigset_t empty;
+        sigemptyset(&empty);
+        sigprocmask(SIG_SETMASK, &empty, nullptr);
+        // обработчик не должен пережить супервизор
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        if (getppid() != parent) _exit(EXIT_FAILURE);
+#ifdef SYS_close_range
+        // сокеты супервизора (сервер метрик) обработчику не нужны
+        syscall(SYS_close_range, 3, ~0U, 0);
+#endif
+
+        execve("/proc/self/exe", argv.data(), envp.data());
+        _exit(127);
+    }
+
+    worker.pid     = pid;
+    worker.started = std::chrono::steady_clock::now();
+    LOG_INFOR(std::format("supervisor started worker #{}, pid={}, metrics port={}",
+        worker.id, worker.pid, worker.metrics_port));
+}
+
+void Supervisor::reap_()
+{
+    for (;;) {
+        int status = 0;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid <= 0) return;
+
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        for (auto& worker : workers_) {
+            if (worker.pid != pid) continue;
+
+            auto now = std::chrono::steady_clock::now();
+            worker.restart_delay = (now - worker.started < worker_min_uptime)
+                                 ? std::min(worker.restart_delay * 2, worker_max_restart_delay)
+                                 : std::chrono::seconds(1);
+            worker.restart_at = now + worker.restart_delay;
+            worker.pid        = -1;
+            LOG_WARNG(std::format("supervisor: worker #{} (pid={}) {}, restarting in {}s",
+                worker.id, pid, exit_status_str_(status), worker.restart_delay.count()));
+            break;
+        }
+    }
+}
+
+void Supervisor::restart_()
+{
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    for (auto& worker : workers_) {
+        if (worker.pid > 0 || now < worker.restart_at) continue;
+        ++worker.restarts;
+        spawn_(worker);
+    }
+}
+
+void Supervisor::stop_workers_()
+{
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    for (const auto& worker : workers_) {
+        if (worker.pid > 0) kill(worker.pid, SIGTERM);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + worker_stop_timeout;
+    for (auto& worker : workers_) {
+        while (worker.pid > 0) {
+            int status = 0;
+            pid_t pid = waitpid(worker.pid, &status, WNOHANG);
+            if (pid == worker.pid || (pid < 0 && errno == ECHILD)) {
+                LOG_INFOR(std::format("supervisor: worker #{} (pid={}) {}",
+                    worker.id, worker.pid, exit_status_str_(status)));
+                worker.pid = -1;
+                break;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                LOG_WARNG(std::format("supervisor: worker #{} (pid={}) is not stopped in time, killing",
+                    worker.id, worker.pid));
+                kill(worker.pid, SIGKILL);
+                waitpid(worker.pid, &status, 0);
+                worker.pid = -1;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+}
+
+void Supervisor::metrics_start_()
+{
+    static const std::string metrics_server_thread_name("Supervisor");
+
+    NetHelpers::SocketAddress sock_addr(conf_->config().prometheus_listening);
+
+    metrics_server_ = std::make_unique<httplib::Server>();
+    metrics_server_->Get("/metrics", [this](const auto& /*req*/, auto& res) {
+        res.set_content(metrics_collect_(), "text/plain; version=0.0.4");
+    });
+    if (!metrics_server_->bind_to_port(sock_addr.host().to_string(), sock_addr.port())) {
+        throw std::runtime_error(std::format("cannot bind to {}", sock_addr.to_string()));
+    }
+    LOG_INFOR(std::format("{} metrics socket was configured into listening state: {}",
+        metrics_server_thread_name, sock_addr.to_string()));
+
+    metrics_server_thread_ = std::thread([this]()->void {
+        ThreadHelpers::block_signals();
+        metrics_server_->listen_after_bind();
+    });
+    ThreadHelpers::set_name(metrics_server_thread_.native_handle(), metrics_server_thread_name);
+}
+
+std::string Supervisor::metrics_collect_()
+{
+    std::vector<worker_s> workers;
+    {
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        workers = workers_;
+    }
+
+    std::vector<std::pair<int, std::string>> texts;
+    std::stringstream up;
+    std::stringstream restarts;
+    for (const auto& worker : workers) {
+        bool ok = false;
+        if (worker.pid > 0) {
+            httplib::Client cli("127.0.0.1", worker.metrics_port);
+            cli.set_connection_timeout(1, 0);
+            cli.set_read_timeout(2, 0);
+            auto res = cli.Get("/metrics");
+            if (res && res->status == httplib::StatusCode::OK_200) {
+                texts.emplace_back(worker.id, std::move(res->body));
+                ok = true;
+            }
+        }
+        up       << std::format("service_worker_up{{worker=\"{}\"}} {}\n", worker.id, ok ? 1 : 0);
+        restarts << std::format("service_worker_restarts_total{{worker=\"{}\"}} {}\n", worker.id, worker.restarts);
+    }
+
+    std::string result = merge_metrics_(texts);
+    result.append("# HELP service_worker_up Worker process is running and its metrics were collected\n");
+    result.append("# TYPE service_worker_up gauge\n");
+    result.append(up.str());
+    result.append("# HELP service_worker_restarts_total Worker process restarts by supervisor\n");
+    result.append("# TYPE service_worker_restarts_total counter\n");
+    result.append(restarts.str());
+    return result;
+}
+
+} // namespace SocialNetwork